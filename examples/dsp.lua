@@ -1,23 +1,14 @@
 -- dsp.lua
 ----------------------------------------------------------------------------------
--- get path of containing folder and set it as package.path
-
-function script_path()
-   local str = debug.getinfo(2, "S").source:sub(2)
-   return str:match("(.*/)")
-end
-
-pkg_path = ";" .. script_path() .. "?.lua"
-
-package.path = package.path .. pkg_path
-
-----------------------------------------------------------------------------------
--- imports
+-- imports (embedded in the external and preloaded, no package.path needed)
 
 require 'dsp_worp'
 require 'fun'
+local libdsp = require 'libdsp'
 
-SAMPLE_RATE = 44100.0
+-- SAMPLE_RATE is set by luajit~ before the script runs and follows the dsp
+-- rate (times OVERSAMPLE) between vectors; the fallback is for other hosts
+SAMPLE_RATE = SAMPLE_RATE or 44100.0
 
 
 ----------------------------------------------------------------------------------
@@ -47,6 +38,10 @@ end
 
 ----------------------------------------------------------------------------------
 -- working custom functions
+--
+-- functions annotated with --@native are compiled to native code by
+-- dsp_native.lua (see the end of this file) and luajit~ runs them without
+-- entering lua per sample. They must stay within its restricted subset.
 
 
 -- low-pass single-pole filter
@@ -55,6 +50,7 @@ end
 --  b = 1 - d
 --  d: Decay between samples (in (0, 1)).
 -- see: https://tomroelandts.com/articles/low-pass-single-pole-iir-filter
+--@native
 lpf1 = function(x, x0, n, decay)
     local b = 1 - decay
     x0 = x0 + b * (x - x0)
@@ -63,20 +59,23 @@ lpf1 = function(x, x0, n, decay)
 end
 
 -- see: https://dsp.stackexchange.com/questions/60277/is-the-typical-implementation-of-low-pass-filter-in-c-code-actually-not-a-typica
+--@native
 lpf2 = function(x, x0, n, decay)
     x0 = (1 - decay) * x0 + decay * (x + x0)/2
     return x0;
 end
 
 -- see: https://www.musicdsp.org/en/latest/Filters/257-1-pole-lpf-for-smooth-parameter-changes.html
+--@native
 lpf3 = function(x, x0, n, alpha)
     local b = 1 - alpha;
     x0 = (x * b) + (x0 * alpha)
     return x0
 end
 
--- a (0-1)
+-- a (0-1), aliases without `oversample 4` (or 8)
 -- see: https://www.musicdsp.org/en/latest/Effects/42-soft-saturation.html
+--@native
 saturate = function(x, feedback, n, a)
    if x < 0 then
       return x
@@ -87,6 +86,22 @@ saturate = function(x, feedback, n, a)
    end
 end
    
+-- wavetable oscillator reading a sine table shared by every instance
+-- p1: frequency (Hz)
+local WT_SIZE = 4096
+local _wt = libdsp.store.get("dsp.sine4096", function()
+   local t = {}
+   for i = 1, WT_SIZE do
+      t[i] = math.sin(2 * math.pi * (i - 1) / WT_SIZE)
+   end
+   return t
+end)
+local _wt_phase = 0
+wavetable = function(x, fb, n, p1)
+   _wt_phase = (_wt_phase + p1 * WT_SIZE / SAMPLE_RATE) % WT_SIZE
+   return _wt[math.floor(_wt_phase)]
+end
+
 ----------------------------------------------------------------------------------
 -- problematic worp functions
 
@@ -131,12 +146,188 @@ osc = function(x, fb, n, p1)
    return _osc()
 end
 
+----------------------------------------------------------------------------------
+-- sample-accurate events: `event note 440 0.8` calls EVENTS.note(440, 0.8) at
+-- the sample matching the time the message was sent, `event note 440 0` ends it
+
+EVENTS = EVENTS or {}
+
+local _voice_osc = Dsp:Osc { f = 440 }
+local _voice_env = Dsp:Adsr { A = 0.005, D = 0.1, S = 0.6, R = 0.3 }
+EVENTS.note = function(f, vel)
+   _voice_osc:set{ f = f }
+   _voice_env:set{ vel = vel or 0 }
+end
+
+voice = function(x, fb, n, p1)
+   return _voice_osc() * _voice_env()
+end
+
+
+----------------------------------------------------------------------------------
+-- buffer~: reads the samples of a buffer~ in the patcher without copying
+-- them (see dsp_buffer.lua). `looper` plays `buffer~ loop` at speed p1.
+
+local buffer = require 'dsp_buffer'
+local _loop = buffer.bind("loop")
+local _loop_pos = 0
+looper = function(x, fb, n, p1)
+   if _loop.frames == 0 then
+      return 0
+   end
+   _loop_pos = (_loop_pos + p1 * _loop.samplerate / SAMPLE_RATE) % _loop.frames
+   return buffer.read(_loop, _loop_pos)
+end
+
+
+----------------------------------------------------------------------------------
+-- convolution: a synthetic 2 s room response, built once per process
+-- (libdsp.cache) and convolved natively once per vector, 100% wet. The IR
+-- is synthesized and partitioned here, when the script loads, never on the
+-- audio thread. The tail runs on libdsp's background thread, one for all
+-- convolvers, so the cost per vector is that of a short IR.
+
+local ROOM_FRAMES = math.floor(2 * SAMPLE_RATE)
+local _room, _room_frames = libdsp.cache.get("dsp.room2s." .. ROOM_FRAMES)
+if _room == nil then
+   local t, seed = {}, 1
+   for i = 1, ROOM_FRAMES do
+      seed = (seed * 16807) % 2147483647
+      t[i] = 0.05 * (seed / 2147483647 * 2 - 1) * math.exp(-6.9 * i / ROOM_FRAMES)  -- -60 dB at the end
+   end
+   _room, _room_frames = libdsp.cache.publish("dsp.room2s." .. ROOM_FRAMES, t)
+end
+local _room_conv = libdsp.conv.new(_room, _room_frames, { threaded = true })
+
+BLOCKS = BLOCKS or {}
+LATENCY = LATENCY or {}     -- samples of delay per block function, see `latency`
+BLOCKS.room = function(inp, out, n, p1)
+   _room_conv:process(inp, out, n)
+end
+
+
+----------------------------------------------------------------------------------
+-- spectral gate: bins quieter than p1 (0..1) times the loudest one of
+-- their frame are muted. Windowing, ffts and overlap-add are native, the
+-- bins are edited here once per hop. Delayed by 2048 samples.
+
+local _gate = libdsp.stft.new { size = 2048, hop = 512, polar = true }
+local _gate_threshold = 0.1
+
+local function _gate_hop(mag, phase, bins)
+   local peak = 0
+   for k = 0, bins - 1 do
+      if mag[k] > peak then peak = mag[k] end
+   end
+   peak = peak * _gate_threshold
+   for k = 0, bins - 1 do
+      if mag[k] < peak then mag[k] = 0 end
+   end
+end
+
+BLOCKS.spectral_gate = function(inp, out, n, p1)
+   _gate_threshold = p1 or 0.1
+   _gate:process(inp, out, n, _gate_hop)
+end
+LATENCY.spectral_gate = _gate.latency
+
+
+----------------------------------------------------------------------------------
+-- phase vocoder pitch shift (libdsp.pvoc), p1: pitch ratio. Cleaner than
+-- `pitchshift` and with a constant cost, one 2048 point frame every 512
+-- samples, spread over the vectors of the next hop; delayed by 2560
+-- samples.
+
+local _pvshift = libdsp.pvoc.new { size = 2048, hop = 512, spread = true }
+
+BLOCKS.pvshift = function(inp, out, n, p1)
+   _pvshift:ratio(p1 or 1)
+   _pvshift:process(inp, out, n)
+end
+LATENCY.pvshift = _pvshift.latency
+
+
+----------------------------------------------------------------------------------
+-- native oscillators (libdsp.oscbank), one call per vector instead of one
+-- per sample. BLOCKS entries win over globals of the same name, so these
+-- replace the worp `square`, `saw` and `osc` above; p1: frequency (Hz).
+
+local function _oscillator(shape)
+   local bank = libdsp.oscbank.new(1, { shape = shape })
+   bank.amp[0] = 1
+   return function(inp, out, n, p1)
+      bank.freq[0] = p1
+      bank:render(out, n)
+   end
+end
+BLOCKS.square = _oscillator("square")
+BLOCKS.saw = _oscillator("saw")
+BLOCKS.osc = _oscillator("sine")
+
+-- 256 sine partials of a sawtooth spectrum at p1 Hz, those above nyquist muted
+local PARTIALS = 256
+local _partials = libdsp.oscbank.new(PARTIALS)
+local _partials_f0, _partials_rate = 0, 0
+BLOCKS.additive = function(inp, out, n, p1)
+   if p1 ~= _partials_f0 or SAMPLE_RATE ~= _partials_rate then
+      _partials_f0, _partials_rate = p1, SAMPLE_RATE
+      for k = 0, PARTIALS - 1 do
+         local f = p1 * (k + 1)
+         _partials.freq[k] = f
+         _partials.amp[k] = f < SAMPLE_RATE / 2 and 0.5 / (k + 1) or 0
+      end
+   end
+   _partials:render(out, n)
+end
+
+-- white, pink and brown noise, each from its own generator (libdsp.noise),
+-- uncorrelated between blocks and between luajit~ instances
+local function _noise(kind)
+   local gen = libdsp.noise.new()
+   return function(inp, out, n)
+      gen:fill(kind, out, n)
+   end
+end
+BLOCKS.noise = _noise("uniform")
+BLOCKS.pink = _noise("pink")
+BLOCKS.brown = _noise("brown")
+
+
+----------------------------------------------------------------------------------
+-- functions which ignore their input: luajit~ keeps running them when its
+-- signal inlet is not connected and skips every other function then
+
+GENERATORS = {
+   wavetable = true, square = true, saw = true, osc = true, voice = true, looper = true, additive = true,
+   noise = true, pink = true, brown = true,
+}
+
 ----------------------------------------------------------------------------------
 -- base (only attenuate) function
 
+--@native
 base = function(x, fb, n, p1)
    local c = p1 / 4
    return x * c
 end
 
 
+----------------------------------------------------------------------------------
+-- graphs: several stages fused into one function called once per vector
+
+local graph = require 'dsp_graph'
+
+graph.define("lpf_saturate_reverb", {
+   nodes = {
+      lp  = { fn = lpf1, p = graph.param(1) },
+      sat = { fn = saturate, p = 0.5 },
+      rev = { mod = Dsp:Reverb { wet = 0.3, dry = 0.7, room = 0.8, damp = 0.2 } },
+   },
+   edges = { "in -> lp -> sat -> rev -> out" },
+})
+
+
+----------------------------------------------------------------------------------
+-- compile the --@native functions above (falls back to lua on failure)
+
+require('dsp_native').compile()
@@ -0,0 +1,70 @@
+-- dsp_buffer.lua
+-- zero-copy access to buffer~ objects (see source/common/buffers.h).
+--
+--    local buffer = require 'dsp_buffer'
+--    local loop = buffer.bind("loop")          -- at load time, not in perform
+--
+--    looper = function(x, fb, n, p1)
+--       if loop.frames == 0 then return 0 end  -- no buffer~ named loop (yet)
+--       _pos = (_pos + p1) % loop.frames
+--       return buffer.read(loop, _pos)
+--    end
+--
+-- a view has the buffer~'s interleaved float `samples` (frame i, channel c
+-- at samples[i * channels + c]), `frames`, `channels` and `samplerate`.
+-- The object locks every bound buffer~ around its dsp functions, so
+-- samples is only valid inside them and NULL elsewhere. Set
+-- `view.modified = 1` after writing to have the buffer~ redrawn.
+
+local ffi = require 'ffi'
+
+local floor = math.floor
+
+local buffer = {}
+
+ffi.cdef [[
+typedef struct {
+   float *samples;
+   double samplerate;
+   int32_t frames;
+   int32_t channels;
+   int32_t modified;
+} dsp_buffer_view;
+]]
+
+local view_ptr = ffi.typeof("dsp_buffer_view *")
+
+-- the view of the buffer~ called name; the same view for every call with
+-- that name, also after the script is reloaded
+function buffer.bind(name)
+   return ffi.cast(view_ptr, buffer_view(name))
+end
+
+-- linearly interpolated sample at fractional frame pos, wrapping around the
+-- end of the buffer (0 while there is no buffer~)
+function buffer.read(view, pos, channel)
+   local frames, channels = view.frames, view.channels
+   if frames == 0 or view.samples == nil then
+      return 0
+   end
+   local i = floor(pos)
+   local frac = pos - i
+   i = i % frames
+   local j = (i + 1) % frames
+   local c = channel or 0
+   local s = view.samples
+   local a = s[i * channels + c]
+   return a + (s[j * channels + c] - a) * frac
+end
+
+-- store y at frame i (wrapping) and mark the buffer~ modified
+function buffer.write(view, i, y, channel)
+   local frames = view.frames
+   if frames == 0 or view.samples == nil then
+      return
+   end
+   view.samples[(floor(i) % frames) * view.channels + (channel or 0)] = y
+   view.modified = 1
+end
+
+return buffer
@@ -0,0 +1,263 @@
+-- dsp_graph.lua
+-- declarative dsp graphs fused into a single generated lua block function.
+--
+--    local graph = require 'dsp_graph'
+--
+--    graph.define("fx", {
+--       nodes = {
+--          lp  = { fn = lpf1, p = graph.param(1) },          -- fn(x, prev, n, p)
+--          sat = { fn = saturate, p = 0.5 },
+--          rev = { mod = Dsp:Reverb { wet = 0.5 },          -- worp module mod(x)
+--                  set = { wet = graph.param(1) } },         -- mod:set{...} per block
+--          osc = { tick = stk.SineWave(),                   -- stk object obj:tick([x])
+--                  set = { setFrequency = 220 } },           -- obj:setFrequency(220) per block
+--       },
+--       edges = { "in -> lp -> sat -> rev -> out" },
+--    })
+--
+-- then select `fx` on the object like any other function. Every node is
+-- called inline from one loop over the block, so LuaJIT traces a single
+-- straight-line loop with per-node state kept in locals, instead of the
+-- object entering and leaving lua once per sample per stage.
+--
+-- nodes:
+--    fn   = function(x, prev, n, p), the per-sample contract of the examples:
+--           prev is the node's previous output, n counts down to 0 over the
+--           block and p is the node's `p` (number or graph.param(k))
+--    mod  = callable (e.g. Dsp:* modules), called as mod(x) or mod() if unconnected
+--    tick = object with a tick method (e.g. stk objects), obj:tick(x) or obj:tick()
+--    set  = values applied once per block: mod:set(set) for `mod` nodes, or
+--           obj:<method>(value) for every entry for `tick` nodes
+--
+-- edges are "a -> b [-> c ...]" strings or { "a", "b" } pairs. `in` is the
+-- object's signal input and `out` its output; several edges into a node are
+-- summed.
+--
+-- graph.param(k) is the object's k-th parameter: luajit~ has one (its float
+-- inlet), luajit.stk~ has four (its inlets from left to right).
+
+local ffi = require 'ffi'
+
+local graph = {}
+
+BLOCKS = BLOCKS or {}
+
+
+local param_mt = {}
+
+function graph.param(k)
+   return setmetatable({ k = k }, param_mt)
+end
+
+local function value_code(v, where)
+   if getmetatable(v) == param_mt then
+      return "a" .. v.k
+   elseif type(v) == "number" then
+      return ("%.17g"):format(v)
+   end
+   error(("dsp_graph: %s must be a number or graph.param(k)"):format(where), 3)
+end
+
+
+----------------------------------------------------------------------------------
+-- graph structure
+
+local function parse_edges(def)
+   local edges = {}
+   for _, e in ipairs(def.edges or {}) do
+      if type(e) == "string" then
+         local names = {}
+         for name in e:gmatch("[^%s%->]+") do
+            names[#names + 1] = name
+         end
+         for i = 1, #names - 1 do
+            edges[#edges + 1] = { names[i], names[i + 1] }
+         end
+      else
+         edges[#edges + 1] = { e[1], e[2] }
+      end
+   end
+   return edges
+end
+
+-- nodes in dependency order (in/out excluded)
+local function toposort(nodes, edges)
+   local inputs = {}
+   for name in pairs(nodes) do
+      inputs[name] = {}
+   end
+   inputs.out = {}
+   for _, e in ipairs(edges) do
+      local from, to = e[1], e[2]
+      if from ~= "in" and not nodes[from] then
+         error("dsp_graph: unknown node '" .. tostring(from) .. "'", 3)
+      end
+      if to == "in" or (to ~= "out" and not nodes[to]) then
+         error("dsp_graph: unknown node '" .. tostring(to) .. "'", 3)
+      end
+      table.insert(inputs[to], from)
+   end
+
+   local order, state = {}, {}
+   local function visit(name)
+      if name == "in" or state[name] == "done" then
+         return
+      end
+      if state[name] == "visiting" then
+         error("dsp_graph: cycle through node '" .. name .. "'", 4)
+      end
+      state[name] = "visiting"
+      for _, from in ipairs(inputs[name]) do
+         visit(from)
+      end
+      state[name] = "done"
+      order[#order + 1] = name
+   end
+
+   -- sorted for a deterministic order of unrelated nodes
+   local names = {}
+   for name in pairs(nodes) do
+      names[#names + 1] = name
+   end
+   table.sort(names)
+   for _, name in ipairs(names) do
+      visit(name)
+   end
+   return order, inputs
+end
+
+
+----------------------------------------------------------------------------------
+-- code generation
+
+function graph.compile(def)
+   local nodes = def.nodes or {}
+   local order, inputs = toposort(nodes, parse_edges(def))
+
+   local upvalues = { ffi.cast, ffi.typeof("double *") }
+   local decl, before, load, loop, store = {}, {}, {}, {}, {}
+   local var = { ["in"] = "x_in" }
+
+   local function upvalue(v)
+      upvalues[#upvalues + 1] = v
+      return "u" .. #upvalues
+   end
+
+   local function input_code(name)
+      local srcs = inputs[name]
+      if #srcs == 0 then
+         return nil
+      end
+      local terms = {}
+      for i, from in ipairs(srcs) do
+         terms[i] = var[from]
+      end
+      return table.concat(terms, " + ")
+   end
+
+   for k, name in ipairs(order) do
+      local node = nodes[name]
+      local y = "y" .. k
+      local x = input_code(name)
+      var[name] = y
+
+      if node.fn then
+         local f = upvalue(node.fn)
+         local p = value_code(node.p or 0, "p of node '" .. name .. "'")
+         decl[#decl + 1] = ("local s%d = 0"):format(k)
+         load[#load + 1] = ("local prev%d = s%d"):format(k, k)
+         loop[#loop + 1] = ("local %s = %s(%s, prev%d, n - 1 - i, %s) or 0 -- %s")
+            :format(y, f, x or "0", k, p, name)
+         loop[#loop + 1] = ("prev%d = %s"):format(k, y)
+         store[#store + 1] = ("s%d = prev%d"):format(k, k)
+      elseif node.mod then
+         local m = upvalue(node.mod)
+         if node.set then
+            local fields = {}
+            for key, v in pairs(node.set) do
+               fields[#fields + 1] = ("[%q] = %s"):format(key, value_code(v, "set." .. key))
+            end
+            before[#before + 1] = ("%s:set{ %s }"):format(m, table.concat(fields, ", "))
+         end
+         loop[#loop + 1] = ("local %s = %s(%s) -- %s"):format(y, m, x or "", name)
+      elseif node.tick then
+         local obj = upvalue(node.tick)
+         local tick = upvalue(node.tick.tick)
+         for method, v in pairs(node.set or {}) do
+            local fn = upvalue(node.tick[method])
+            before[#before + 1] = ("%s(%s, %s)"):format(fn, obj, value_code(v, "set." .. method))
+         end
+         loop[#loop + 1] = ("local %s = %s(%s%s) -- %s"):format(y, tick, obj, x and ", " .. x or "", name)
+      else
+         error("dsp_graph: node '" .. name .. "' needs one of fn, mod or tick", 2)
+      end
+   end
+
+   local ups = {}
+   for i = 1, #upvalues do
+      ups[i] = "u" .. i
+   end
+
+   local src = table.concat({
+      ("local %s = ..."):format(table.concat(ups, ", ")),
+      table.concat(decl, "\n"),
+      "return function(inp, out, n, a1, a2, a3, a4)",
+      "   inp, out = u1(u2, inp), u1(u2, out)",
+      "   " .. table.concat(before, "\n   "),
+      "   " .. table.concat(load, "\n   "),
+      "   for i = 0, n - 1 do",
+      "      local x_in = inp[i]",
+      "      " .. table.concat(loop, "\n      "),
+      "      out[i] = " .. (input_code("out") or "0"),
+      "   end",
+      "   " .. table.concat(store, "\n   "),
+      "end",
+   }, "\n")
+
+   local factory = assert(loadstring(src, "=dsp_graph"))
+   return factory(unpack(upvalues, 1, #upvalues)), src
+end
+
+-- a linear chain of global per-sample functions given by name, e.g.
+-- graph.chain("lpf1 saturate base") or graph.chain{"lpf1", "saturate"}.
+-- every stage gets the object's first parameter as p.
+function graph.chain(names)
+   if type(names) == "string" then
+      local list = {}
+      for name in names:gmatch("%S+") do
+         list[#list + 1] = name
+      end
+      names = list
+   end
+
+   local nodes, path = {}, { "in" }
+   for i, name in ipairs(names) do
+      local fn = _G[name]
+      if type(fn) ~= "function" then
+         error("dsp_graph: no dsp function '" .. tostring(name) .. "'", 2)
+      end
+      local key = name .. "#" .. i    -- a function may appear more than once
+      nodes[key] = { fn = fn, p = graph.param(1) }
+      path[#path + 1] = key
+   end
+   path[#path + 1] = "out"
+
+   return graph.compile { nodes = nodes, edges = { table.concat(path, " -> ") } }
+end
+
+-- compile and register a graph as a selectable block function; graphs
+-- without an edge from `in` are also registered as GENERATORS
+function graph.define(name, def)
+   BLOCKS[name] = graph.compile(def)
+   local generator = true
+   for _, e in ipairs(parse_edges(def)) do
+      if e[1] == "in" then
+         generator = nil
+      end
+   end
+   GENERATORS = GENERATORS or {}
+   GENERATORS[name] = generator
+   return BLOCKS[name]
+end
+
+return graph
@@ -0,0 +1,92 @@
+-- dsp_midi.lua
+-- reads the midi messages luajit.stk~ hands to the global on_midi once per
+-- vector (see source/common/midi.h).
+--
+--    local midi = require 'dsp_midi'
+--
+--    on_midi = midi.handler {
+--       note_on  = function(offset, channel, note, velocity) ... end,
+--       note_off = function(offset, channel, note, velocity) ... end,
+--       control  = function(offset, channel, number, value) ... end,
+--       bend     = function(offset, channel, value) ... end,   -- -8192..8191
+--    }
+--
+-- or read the batch directly:
+--
+--    on_midi = function(events, count)
+--       local ev = midi.events(events)
+--       for i = 0, count - 1 do
+--          -- ev[i].offset, ev[i].status, ev[i].data1, ev[i].data2, ev[i].size
+--       end
+--    end
+--
+-- send raw bytes to the object with `midi <bytes...>` (e.g. midiin ->
+-- prepend midi). on_midi runs before the vector is processed; offset is the
+-- sample the message belongs to within it, so handlers that need to be
+-- sample accurate can spawn(function() wait(offset) ... end).
+-- note on with velocity 0 is reported as note_off.
+
+local ffi = require 'ffi'
+local bit = require 'bit'
+
+local band = bit.band
+
+local midi = {}
+
+ffi.cdef [[
+typedef struct {
+   int32_t offset;
+   uint8_t status;
+   uint8_t data1;
+   uint8_t data2;
+   uint8_t size;
+} dsp_midi_event;
+]]
+
+local event_ptr = ffi.typeof("const dsp_midi_event *")
+
+-- typed view of the lightuserdata passed to on_midi
+function midi.events(events)
+   return ffi.cast(event_ptr, events)
+end
+
+-- midi note number to frequency in Hz
+function midi.mtof(note)
+   return 440 * 2 ^ ((note - 69) / 12)
+end
+
+-- an on_midi function calling the given handlers (all optional) with
+-- (offset, channel 1-16, ...) per channel message
+function midi.handler(h)
+   local note_on, note_off = h.note_on, h.note_off
+   local control, program, bend = h.control, h.program, h.bend
+   local pressure, poly_pressure = h.pressure, h.poly_pressure
+   local other = h.other   -- other(offset, status, data1, data2) for system messages
+
+   return function(events, count)
+      local ev = ffi.cast(event_ptr, events)
+      for i = 0, count - 1 do
+         local e = ev[i]
+         local kind, ch = band(e.status, 0xF0), band(e.status, 0x0F) + 1
+         if kind == 0x90 and e.data2 > 0 then
+            if note_on then note_on(e.offset, ch, e.data1, e.data2) end
+         elseif kind == 0x80 or kind == 0x90 then
+            if note_off then note_off(e.offset, ch, e.data1, e.data2) end
+         elseif kind == 0xB0 then
+            if control then control(e.offset, ch, e.data1, e.data2) end
+         elseif kind == 0xE0 then
+            if bend then bend(e.offset, ch, e.data1 + e.data2 * 128 - 8192) end
+         elseif kind == 0xC0 then
+            if program then program(e.offset, ch, e.data1) end
+         elseif kind == 0xD0 then
+            if pressure then pressure(e.offset, ch, e.data1) end
+         elseif kind == 0xA0 then
+            if poly_pressure then poly_pressure(e.offset, ch, e.data1, e.data2) end
+         elseif other then
+            other(e.offset, e.status, e.data1, e.data2)
+         end
+      end
+   end
+end
+
+return midi
@@ -0,0 +1,664 @@
+-- dsp_native.lua
+-- compiles annotated dsp functions written in a restricted subset of lua to
+-- native code with the system c compiler.
+--
+-- annotate a function with `--@native` on the line before its definition:
+--
+--    --@native
+--    lpf1 = function(x, x0, n, decay)
+--       local b = 1 - decay
+--       return x0 + b * (x - x0)
+--    end
+--
+-- and call `require('dsp_native').compile()` at the end of the script. The
+-- annotated functions are translated to c, compiled into one shared object
+-- which is cached in CACHE_DIR (keyed on a hash of the generated code), and
+-- their block functions are registered in NATIVE[name]. luajit~ then calls
+-- the block function directly instead of calling the lua function per
+-- sample. A function outside the subset, or a failed compile, simply keeps
+-- running in lua.
+--
+-- the subset:
+--    - number locals and parameters, at most 4 parameters (x, prev, n, p1)
+--    - arithmetic + - * / % ^, comparisons, and/or/not, `c and a or b`
+--    - if/elseif/else, while, numeric for, do/end, break, return
+--    - math.* functions and constants
+--    - numeric globals (e.g. SAMPLE_RATE) are inlined as constants
+--
+-- falling off the end of a function returns 0, as luajit~ reads nil as 0.
+
+local ffi = require 'ffi'
+local bit = require 'bit'
+
+local native = {}
+
+NATIVE = NATIVE or {}
+
+local loaded = {}       -- keep compiled libraries loaded while the state lives
+local registered = {}   -- path -> names registered from that script
+
+pcall(ffi.cdef, "void *dsp_native_lookup(const char *name);")
+
+
+----------------------------------------------------------------------------------
+-- tokenizer
+
+local keywords = {}
+for k in ([[and break do else elseif end false for function if in local nil
+            not or repeat return then true until while]]):gmatch("%a+") do
+   keywords[k] = true
+end
+
+local EOF = { t = "eof", line = 0 }
+
+local function tokenize(src)
+   local toks = {}
+   local annotations = {}
+   local i, line, len = 1, 1, #src
+
+   local function skip_long(start, level)
+      local close = "]" .. level .. "]"
+      local e = src:find(close, start, true)
+      if not e then
+         error({ native = true, msg = "unfinished long string or comment" }, 0)
+      end
+      local _, nl = src:sub(i, e):gsub("\n", "")
+      line = line + nl
+      return e + #close
+   end
+
+   while i <= len do
+      local c = src:sub(i, i)
+      if c == "\n" then
+         line = line + 1
+         i = i + 1
+      elseif c:match("%s") then
+         i = i + 1
+      elseif src:sub(i, i + 1) == "--" then
+         local level = src:match("^%-%-%[(=*)%[", i)
+         if level then
+            i = skip_long(i, level)
+         else
+            local e = src:find("\n", i, true) or len + 1
+            if src:sub(i, e - 1):match("^%-%-@native%s*$") then
+               annotations[#annotations + 1] = #toks + 1
+            end
+            i = e
+         end
+      elseif c:match("[%a_]") then
+         local name = src:match("^[%w_]+", i)
+         toks[#toks + 1] = { t = keywords[name] and name or "name", v = name, line = line }
+         i = i + #name
+      elseif c:match("%d") or (c == "." and src:sub(i + 1, i + 1):match("%d")) then
+         local num = src:match("^0[xX]%x+", i)
+                  or src:match("^%d*%.?%d*[eE][%+%-]?%d+", i)
+                  or src:match("^%d*%.?%d*", i)
+         toks[#toks + 1] = { t = "number", v = tonumber(num), line = line }
+         i = i + #num
+      elseif c == '"' or c == "'" then
+         local j = i + 1
+         while j <= len and src:sub(j, j) ~= c do
+            j = j + (src:sub(j, j) == "\\" and 2 or 1)
+         end
+         toks[#toks + 1] = { t = "string", line = line }
+         i = j + 1
+      elseif src:match("^%[=*%[", i) then
+         local level = src:match("^%[(=*)%[", i)
+         toks[#toks + 1] = { t = "string", line = line }
+         i = skip_long(i, level)
+      else
+         local op = src:match("^%.%.%.", i) or src:match("^[=~<>]=", i) or src:match("^%.%.", i) or c
+         toks[#toks + 1] = { t = op, v = op, line = line }
+         i = i + #op
+      end
+   end
+   return toks, annotations
+end
+
+
+----------------------------------------------------------------------------------
+-- parser / c generator
+
+local binary_priority = {
+   ["or"] = { 1, 1 }, ["and"] = { 2, 2 },
+   ["<"] = { 3, 3 }, [">"] = { 3, 3 }, ["<="] = { 3, 3 }, [">="] = { 3, 3 },
+   ["~="] = { 3, 3 }, ["=="] = { 3, 3 },
+   [".."] = { 5, 4 },
+   ["+"] = { 6, 6 }, ["-"] = { 6, 6 },
+   ["*"] = { 7, 7 }, ["/"] = { 7, 7 }, ["%"] = { 7, 7 },
+   ["^"] = { 10, 9 },
+}
+local UNARY_PRIORITY = 8
+
+local math_functions = {
+   abs = { "fabs", 1 }, ceil = { "ceil", 1 }, floor = { "floor", 1 },
+   sqrt = { "sqrt", 1 }, exp = { "exp", 1 }, log = { "log", 1 }, log10 = { "log10", 1 },
+   sin = { "sin", 1 }, cos = { "cos", 1 }, tan = { "tan", 1 },
+   asin = { "asin", 1 }, acos = { "acos", 1 }, atan = { "atan", 1 }, atan2 = { "atan2", 2 },
+   sinh = { "sinh", 1 }, cosh = { "cosh", 1 }, tanh = { "tanh", 1 },
+   pow = { "pow", 2 }, fmod = { "fmod", 2 }, min = { "fmin", 2 }, max = { "fmax", 2 },
+}
+
+local math_constants = { pi = math.pi, huge = math.huge }
+
+local function literal(v)
+   if v == math.huge then return "HUGE_VAL" end
+   if v == -math.huge then return "(-HUGE_VAL)" end
+   if v ~= v then return "NAN" end
+   local s = ("%.17g"):format(v)
+   if not s:find("[%.eEn]") then
+      s = s .. ".0"
+   end
+   return s
+end
+
+local function num(code) return { ty = "num", code = code } end
+local function bool(code) return { ty = "bool", code = code } end
+
+local Parser = {}
+Parser.__index = Parser
+
+function Parser.new(toks, p)
+   return setmetatable({ toks = toks, p = p, scopes = {}, nlocal = 0, loops = 0, out = {}, indent = 1 }, Parser)
+end
+
+function Parser:peek(k) return self.toks[self.p + (k or 0)] or EOF end
+function Parser:next() local tok = self:peek(); self.p = self.p + 1; return tok end
+function Parser:check(t) return self:peek().t == t end
+function Parser:accept(t) if self:check(t) then return self:next() end end
+
+function Parser:fail(msg, tok)
+   tok = tok or self:peek()
+   error({ native = true, msg = ("line %d: %s"):format(tok.line, msg) }, 0)
+end
+
+function Parser:expect(t)
+   local tok = self:next()
+   if tok.t ~= t then
+      self:fail(("'%s' expected near '%s'"):format(t, tostring(tok.v or tok.t)), tok)
+   end
+   return tok
+end
+
+function Parser:emit(line)
+   self.out[#self.out + 1] = ("    "):rep(self.indent) .. line
+end
+
+function Parser:open_scope() self.scopes[#self.scopes + 1] = {} end
+function Parser:close_scope() self.scopes[#self.scopes] = nil end
+
+function Parser:declare(name, cname)
+   if not cname then
+      self.nlocal = self.nlocal + 1
+      cname = ("v_%s_%d"):format(name, self.nlocal)
+   end
+   self.scopes[#self.scopes][name] = cname
+   return cname
+end
+
+function Parser:resolve(name)
+   for i = #self.scopes, 1, -1 do
+      local cname = self.scopes[i][name]
+      if cname then return cname end
+   end
+end
+
+function Parser:numeric(e, tok)
+   if e.ty ~= "num" then
+      self:fail("number expected", tok)
+   end
+   return e.code
+end
+
+function Parser:condition(e, tok)
+   if e.ty ~= "bool" then
+      self:fail("comparison expected (numbers are always true in lua)", tok)
+   end
+   return e.code
+end
+
+-- expressions
+
+function Parser:call_args(count, tok)
+   self:expect("(")
+   local args = {}
+   if not self:check(")") then
+      repeat
+         args[#args + 1] = self:numeric(self:expr(), tok)
+      until not self:accept(",")
+   end
+   self:expect(")")
+   if #args ~= count then
+      self:fail(("%d argument(s) expected"):format(count), tok)
+   end
+   return table.concat(args, ", ")
+end
+
+function Parser:primary()
+   local tok = self:next()
+   if tok.t == "number" then
+      return num(literal(tok.v))
+   elseif tok.t == "(" then
+      local e = self:expr()
+      self:expect(")")
+      return e.ty == "cond" and e or { ty = e.ty, code = "(" .. e.code .. ")" }
+   elseif tok.t == "name" then
+      local cname = self:resolve(tok.v)
+      if cname then
+         return num(cname)
+      elseif tok.v == "math" then
+         self:expect(".")
+         local field = self:expect("name").v
+         if math_functions[field] then
+            local f = math_functions[field]
+            return num(f[1] .. "(" .. self:call_args(f[2], tok) .. ")")
+         elseif math_constants[field] then
+            return num(literal(math_constants[field]))
+         end
+         self:fail("math." .. field .. " is not supported", tok)
+      elseif type(_G[tok.v]) == "number" then
+         return num(literal(_G[tok.v]))
+      end
+      self:fail("'" .. tok.v .. "' is not a local, parameter or numeric global", tok)
+   elseif tok.t == "true" or tok.t == "false" then
+      return bool(tok.t == "true" and "1" or "0")
+   end
+   self:fail("unsupported expression near '" .. tostring(tok.v or tok.t) .. "'", tok)
+end
+
+function Parser:unary(op, e, tok)
+   if op == "-" then
+      return num("(-" .. self:numeric(e, tok) .. ")")
+   end
+   return bool("(!" .. self:condition(e, tok) .. ")")
+end
+
+local c_operators = { ["~="] = "!=", ["and"] = "&&", ["or"] = "||" }
+
+function Parser:binary(op, a, b, tok)
+   if op == "+" or op == "-" or op == "*" or op == "/" then
+      return num(("(%s %s %s)"):format(self:numeric(a, tok), op, self:numeric(b, tok)))
+   elseif op == "%" then
+      return num(("dspn_mod(%s, %s)"):format(self:numeric(a, tok), self:numeric(b, tok)))
+   elseif op == "^" then
+      return num(("pow(%s, %s)"):format(self:numeric(a, tok), self:numeric(b, tok)))
+   elseif binary_priority[op][1] == 3 then
+      return bool(("(%s %s %s)"):format(self:numeric(a, tok), c_operators[op] or op, self:numeric(b, tok)))
+   elseif op == "and" then
+      if a.ty == "bool" and b.ty == "bool" then
+         return bool(("(%s && %s)"):format(a.code, b.code))
+      elseif a.ty == "bool" and b.ty == "num" then
+         return { ty = "cond", cond = a.code, val = b.code }    -- first half of `c and a or b`
+      end
+   elseif op == "or" then
+      if a.ty == "bool" and b.ty == "bool" then
+         return bool(("(%s || %s)"):format(a.code, b.code))
+      elseif a.ty == "cond" and b.ty == "num" then
+         return num(("(%s ? %s : %s)"):format(a.cond, a.val, b.code))
+      elseif a.ty == "cond" and b.ty == "cond" then
+         return { ty = "cond", cond = ("(%s || %s)"):format(a.cond, b.cond),
+                  val = ("(%s ? %s : %s)"):format(a.cond, a.val, b.val) }
+      end
+   end
+   self:fail("unsupported use of '" .. op .. "'", tok)
+end
+
+function Parser:subexpr(limit)
+   local e
+   local tok = self:peek()
+   if tok.t == "not" or tok.t == "-" then
+      self:next()
+      e = self:unary(tok.t, self:subexpr(UNARY_PRIORITY), tok)
+   else
+      e = self:primary()
+   end
+   local prio = binary_priority[self:peek().t]
+   while prio and prio[1] > limit do
+      local optok = self:next()
+      e = self:binary(optok.t, e, self:subexpr(prio[2]), optok)
+      prio = binary_priority[self:peek().t]
+   end
+   return e
+end
+
+function Parser:expr()
+   return self:subexpr(0)
+end
+
+-- statements
+
+local block_end = { ["end"] = true, ["else"] = true, ["elseif"] = true, ["eof"] = true }
+
+function Parser:block()
+   self:open_scope()
+   while not block_end[self:peek().t] do
+      if self:statement() then
+         break  -- return must be the last statement of a block
+      end
+   end
+   self:close_scope()
+end
+
+function Parser:nested(header)
+   self:emit(header)
+   self.indent = self.indent + 1
+   self:block()
+   self.indent = self.indent - 1
+end
+
+function Parser:statement()
+   local tok = self:next()
+   local t = tok.t
+
+   if t == ";" then
+      return false
+   elseif t == "local" then
+      local name = self:expect("name").v
+      local init = "0.0"
+      if self:accept("=") then
+         init = self:numeric(self:expr(), tok)
+      end
+      if self:check(",") then
+         self:fail("multiple assignment is not supported")
+      end
+      self:emit(("double %s = %s;"):format(self:declare(name), init))
+   elseif t == "name" then
+      local cname = self:resolve(tok.v)
+      if not cname then
+         self:fail("assignment to '" .. tok.v .. "' (only locals and parameters)", tok)
+      end
+      self:expect("=")
+      self:emit(("%s = %s;"):format(cname, self:numeric(self:expr(), tok)))
+   elseif t == "if" then
+      local cond = self:condition(self:expr(), tok)
+      self:expect("then")
+      self:nested(("if (%s) {"):format(cond))
+      while self:check("elseif") do
+         local etok = self:next()
+         cond = self:condition(self:expr(), etok)
+         self:expect("then")
+         self:nested(("} else if (%s) {"):format(cond))
+      end
+      if self:accept("else") then
+         self:nested("} else {")
+      end
+      self:expect("end")
+      self:emit("}")
+   elseif t == "while" then
+      local cond = self:condition(self:expr(), tok)
+      self:expect("do")
+      self.loops = self.loops + 1
+      self:nested(("while (%s) {"):format(cond))
+      self.loops = self.loops - 1
+      self:expect("end")
+      self:emit("}")
+   elseif t == "for" then
+      local name = self:expect("name").v
+      self:expect("=")
+      local first = self:numeric(self:expr(), tok)
+      self:expect(",")
+      local limit = self:numeric(self:expr(), tok)
+      local step = "1.0"
+      if self:accept(",") then
+         step = self:numeric(self:expr(), tok)
+      end
+      self:expect("do")
+      self:open_scope()
+      local var = self:declare(name)
+      local n = self.nlocal
+      self:emit(("double limit_%d = %s, step_%d = %s;"):format(n, limit, n, step))
+      self.loops = self.loops + 1
+      self:nested(("for (double %s = %s; step_%d > 0 ? %s <= limit_%d : %s >= limit_%d; %s += step_%d) {")
+         :format(var, first, n, var, n, var, n, var, n))
+      self.loops = self.loops - 1
+      self:close_scope()
+      self:expect("end")
+      self:emit("}")
+   elseif t == "do" then
+      self:nested("{")
+      self:expect("end")
+      self:emit("}")
+   elseif t == "break" then
+      if self.loops == 0 then
+         self:fail("break outside a loop", tok)
+      end
+      self:emit("break;")
+   elseif t == "return" then
+      if block_end[self:peek().t] or self:check(";") then
+         self:emit("return 0.0;")
+      else
+         self:emit(("return %s;"):format(self:numeric(self:expr(), tok)))
+      end
+      self:accept(";")
+      return true
+   else
+      self:fail("unsupported statement near '" .. tostring(tok.v or t) .. "'", tok)
+   end
+   return false
+end
+
+-- `name = function(...)` or `function name(...)` following an annotation
+function Parser:func()
+   local name
+   if self:accept("function") then
+      name = self:expect("name").v
+   elseif self:check("name") and self:peek(1).t == "=" then
+      name = self:next().v
+      self:next()
+      self:expect("function")
+   else
+      self:fail("global function definition expected after --@native")
+   end
+   if self:check(".") or self:check(":") then
+      self:fail("only plain global functions are supported")
+   end
+
+   self:open_scope()
+   local params = {}
+   self:expect("(")
+   if not self:check(")") then
+      repeat
+         local pname = self:expect("name").v
+         params[#params + 1] = self:declare(pname, "v_" .. pname)
+      until not self:accept(",")
+   end
+   self:expect(")")
+   if #params > 4 then
+      self:fail("at most 4 parameters (x, prev, n, p1) are supported")
+   end
+   for i = #params + 1, 4 do
+      params[i] = "unused_" .. i
+   end
+
+   self:block()
+   self:expect("end")
+   self:close_scope()
+
+   return name, params
+end
+
+
+----------------------------------------------------------------------------------
+-- code generation
+
+local header = [[
+// generated by dsp_native.lua from %s, do not edit
+#include <math.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define DSPN_EXPORT __declspec(dllexport)
+#else
+#define DSPN_EXPORT __attribute__((visibility("default")))
+#endif
+
+static inline double dspn_mod(double a, double b)
+{
+    return a - floor(a / b) * b;
+}
+]]
+
+-- same contract as luajit~'s per-sample loop: fn(x, prev, n, p1) with n
+-- counting down to 0 and prev the previous output
+local block_template = [[
+
+static double dspn_%s(double %s, double %s, double %s, double %s)
+{
+%s
+    return 0.0;
+}
+
+static void dspn_%s_block(const double *in, double *out, long frames, double *v1, double p1)
+{
+    double prev = *v1;
+    for (long i = 0; i < frames; i++) {
+        prev = dspn_%s(in[i], prev, (double)(frames - 1 - i), p1);
+        out[i] = prev;
+    }
+    *v1 = prev;
+}
+]]
+
+local function translate(src, path)
+   local toks, annotations = tokenize(src)
+   local parts = { header:format(path) }
+   local lookup = {}
+   local names = {}
+
+   for _, index in ipairs(annotations) do
+      local parser = Parser.new(toks, index)
+      local ok, name, params = pcall(parser.func, parser)
+      if ok then
+         local p = params
+         parts[#parts + 1] = block_template:format(name, p[1], p[2], p[3], p[4],
+            table.concat(parser.out, "\n"), name, name)
+         lookup[#lookup + 1] = ('    if (strcmp(name, "%s") == 0) return (void *)dspn_%s_block;'):format(name, name)
+         names[#names + 1] = name
+      elseif type(name) == "table" and name.native then
+         print(("dsp_native: %s: %s (stays in lua)"):format(path, name.msg))
+      else
+         error(name, 0)
+      end
+   end
+
+   parts[#parts + 1] = ([[
+
+DSPN_EXPORT void *dsp_native_lookup(const char *name)
+{
+%s
+    return NULL;
+}
+]]):format(table.concat(lookup, "\n"))
+
+   return table.concat(parts), names
+end
+
+
+----------------------------------------------------------------------------------
+-- compile and cache
+
+local function hash(s)
+   local h = 0x811c9dc5
+   for i = 1, #s do
+      h = bit.bxor(h, s:byte(i))
+      h = bit.tobit(bit.lshift(h, 24) + h * 403)     -- h * 16777619 (mod 2^32)
+   end
+   return bit.tohex(h)
+end
+
+local function exists(path)
+   local f = io.open(path, "rb")
+   if f then
+      f:close()
+      return true
+   end
+   return false
+end
+
+local function build(csrc, libpath)
+   local cfile = libpath .. ".c"
+   local tmp = libpath .. ".tmp"
+   local f = io.open(cfile, "wb")
+   if not f then
+      return false
+   end
+   f:write(csrc)
+   f:close()
+
+   local cc = os.getenv("CC") or "cc"
+   local cmd = ('%s -O2 -shared -fPIC -o "%s" "%s" -lm'):format(cc, tmp, cfile)
+   local status = os.execute(cmd)
+   if not (status == 0 or status == true) then
+      os.remove(tmp)
+      return false
+   end
+   return os.rename(tmp, libpath)
+end
+
+-- compile the annotated functions of `path` (default: the calling script)
+function native.compile(path)
+   if not path then
+      local source = debug.getinfo(2, "S").source
+      path = source:sub(1, 1) == "@" and source:sub(2) or nil
+   end
+
+   -- forget what this script registered before (e.g. on reload)
+   for _, name in ipairs(registered[path or ""] or {}) do
+      NATIVE[name] = nil
+   end
+   registered[path or ""] = nil
+
+   if not path then
+      print("dsp_native: cannot tell which script to compile, pass its path")
+      return {}
+   end
+   if ffi.os == "Windows" then
+      return {}
+   end
+   local f = io.open(path, "rb")
+   if not f then
+      return {}
+   end
+   local src = f:read("*a")
+   f:close()
+
+   local ok, csrc, names = pcall(translate, src, path)
+   if not ok then
+      print("dsp_native: " .. tostring(type(csrc) == "table" and csrc.msg or csrc))
+      return {}
+   end
+   if #names == 0 then
+      return {}
+   end
+
+   local dir = CACHE_DIR or os.getenv("TMPDIR") or "/tmp"
+   local ext = ffi.os == "OSX" and "dylib" or "so"
+   local libpath = ("%s/native_%s.%s"):format(dir, hash(csrc), ext)
+
+   if not exists(libpath) and not build(csrc, libpath) then
+      print("dsp_native: compiling " .. path .. " failed (functions stay in lua)")
+      return {}
+   end
+
+   local lib = loaded[libpath]
+   if not lib then
+      local lok, l = pcall(ffi.load, libpath)
+      if not lok then
+         print("dsp_native: " .. tostring(l))
+         return {}
+      end
+      lib = l
+      loaded[libpath] = lib
+   end
+
+   for _, name in ipairs(names) do
+      NATIVE[name] = tonumber(ffi.cast("uintptr_t", lib.dsp_native_lookup(name)))
+   end
+   registered[path] = names
+   return names
+end
+
+-- exposed for tests
+native.translate = translate
+
+return native
@@ -0,0 +1,46 @@
+-- dsp_params.lua
+-- binds the named parameters declared in a script's PARAMS table to the
+-- native values of the object (see source/common/params.h).
+--
+--    PARAMS = {
+--       { name = "cutoff", default = 1000, min = 20, max = 20000, smooth = 20 },
+--    }
+--
+--    lowpass = function(x, fb, n, p1)
+--       return fb + (x - fb) * P.cutoff / SAMPLE_RATE
+--    end
+--
+-- the object sets the global P after running the script, so read P inside
+-- the dsp functions rather than at load time. `set cutoff 500` changes it.
+
+local ffi = require 'ffi'
+
+local params = {}
+
+-- ffi pointer type with one double field per declared name, in order
+function params.type(decl)
+   local fields, seen = {}, {}
+   for i, p in ipairs(decl) do
+      local name = p.name
+      if type(name) ~= "string" or not name:match("^[%a_][%w_]*$") then
+         error(("PARAMS[%d]: '%s' is not a valid name"):format(i, tostring(name)), 2)
+      end
+      if seen[name] then
+         error(("PARAMS[%d]: '%s' is declared twice"):format(i, name), 2)
+      end
+      seen[name] = true
+      fields[i] = "double " .. name .. ";"
+   end
+   if #fields == 0 then
+      return nil
+   end
+   return ffi.typeof("struct { " .. table.concat(fields, " ") .. " } *")
+end
+
+-- the value of P for the declaration and the object's native values
+function params.bind(decl, values)
+   local T = params.type(decl)
+   return T and ffi.cast(T, values) or nil
+end
+
+return params
@@ -1,6 +1,8 @@
 -- dsp.lua
 
-SAMPLE_RATE = 44100.0
+-- SAMPLE_RATE is set by luajit.stk~ before the script runs and follows the
+-- dsp rate between vectors; the fallback is for other hosts
+SAMPLE_RATE = SAMPLE_RATE or 44100.0
 
 
 function dump(o)
@@ -38,6 +40,19 @@ pitshift = function(x, fb, n, shift, p1, p2, p3)
    return _pitshift:tick(x)
 end
 
+-- the same as a native phase vocoder (libdsp.pvoc): better quality and a
+-- fixed cost, one 2048 point frame every 512 samples spread over the
+-- vectors of the next hop; delayed by 2560 samples (`latency`)
+local libdsp = require 'libdsp'
+local _pvshift = libdsp.pvoc.new { size = 2048, hop = 512, spread = true }
+BLOCKS = BLOCKS or {}
+LATENCY = LATENCY or {}
+BLOCKS.pvshift = function(inp, out, n, shift, p1, p2, p3)
+   _pvshift:ratio(shift)
+   _pvshift:process(inp, out, n)
+end
+LATENCY.pvshift = _pvshift.latency
+
 
 local _sine = stk.SineWave()
 sine = function(x, fb, n, freq, time, phase, phase_offset)
@@ -59,6 +74,82 @@ delay = function(x, fb, n, delay, fb_ratio, balance, tap_delay)
 end
 
 
+
+-- named parameters: `set <name> <value>` messages, read through P (see dsp_params.lua)
+PARAMS = {
+   { name = "frequency", default = 220, min = 20, max = 2000, smooth = 30 },
+   { name = "pressure", default = 64, min = 0, max = 128, smooth = 20 },
+   { name = "position", default = 64, min = 0, max = 128, smooth = 20 },
+   { name = "vibrato", default = 0, min = 0, max = 128, smooth = 50 },
+   { name = "volume", default = 100, min = 0, max = 128, smooth = 20 },
+}
+
+local _bowed = stk.Bowed(20)
+local _bowing = false
+bowed = function(x, fb, n, p0, p1, p2, p3)
+   if not _bowing then
+      _bowed:noteOn(P.frequency, 0.8)
+      _bowing = true
+   end
+   if n == 0 then  -- once per vector: P only changes between vectors
+      _bowed:setFrequency(P.frequency)
+      _bowed:controlChange(2, P.pressure)
+      _bowed:controlChange(4, P.position)
+      _bowed:controlChange(1, P.vibrato)
+      _bowed:controlChange(128, P.volume)
+   end
+   return _bowed:tick()
+end
+
+
+-- sequences: spawn(fn) runs fn as a coroutine, wait(samples) resumes it at
+-- that exact sample inside the vector and now() is the current sample time
+local _pluck = stk.Plucked(50)
+local _pattern = { 220, 330, 440, 330, 262, 392 }
+spawn(function()
+   local step = 0
+   while true do
+      step = step % #_pattern + 1
+      _pluck:noteOn(_pattern[step], 0.7)
+      wait(SAMPLE_RATE / 8)
+   end
+end)
+
+plucked_seq = function(x, fb, n, p0, p1, p2, p3)
+   return _pluck:tick()
+end
+
+-- midi: `midi <bytes...>` messages (midiin -> prepend midi) reach on_midi
+-- once per vector with their sample offsets (see dsp_midi.lua)
+local midi = require 'dsp_midi'
+local _keys = {}
+for i = 1, 4 do
+   _keys[i] = stk.Rhodey()
+end
+local _key = 0
+on_midi = midi.handler {
+   note_on = function(offset, channel, note, velocity)
+      _key = _key % #_keys + 1
+      local voice = _keys[_key]
+      if offset > 0 then  -- start the note at its sample within the vector
+         spawn(function()
+            wait(offset)
+            voice:noteOn(midi.mtof(note), velocity / 127)
+         end)
+      else
+         voice:noteOn(midi.mtof(note), velocity / 127)
+      end
+   end,
+}
+
+rhodey_midi = function(x, fb, n, p0, p1, p2, p3)
+   local y = 0
+   for i = 1, #_keys do
+      y = y + _keys[i]:tick()
+   end
+   return y * 0.25
+end
+
 base = function(x, n, p0, p1, p2, p3)
    return x / 2
 end
@@ -427,21 +427,21 @@ end
 --
 -- Random noise generator module, generates noise in the range -1.0 .. +1.0
 --
--- The noise module can generate both uniform and gaussian white noise.
---
--- The gaussian noise is based on code from ..., check the original document at
--- [http://www.taygeta.com/random/gaussian.html] for more details about the
--- implementation
+-- The noise module can generate uniform and gaussian white noise, and pink
+-- and brown noise. Every instance has its own native generator (libdsp.noise)
+-- that fills NOISE_BLOCK values at a time; fn_gen hands them out one by one.
+-- Every instance gets a seed of its own, so parallel voices are not
+-- correlated; set `seed` for reproducible renders.
 --
 
+local NOISE_BLOCK = 64
+
 function Dsp:Noise(init)
 
-	local random, sqrt, log = math.random, math.sqrt, math.log
-	local type, y1, y2
-	
-	local function rand()
-		return 2 * random() - 1
-	end
+	local libdsp = require 'libdsp'
+	local gen = libdsp.noise.new()
+	local buf = require('ffi').new("double[?]", NOISE_BLOCK)
+	local type, pos = "uniform", NOISE_BLOCK
 	
 	return Dsp:Mod({
 		description = "Noise generator",
@@ -450,30 +450,24 @@ function Dsp:Noise(init)
 				id = "type",
 				description = "Noise type",
 				type = "enum",
-				options = { "uniform", "gaussian" },
+				options = { "uniform", "gaussian", "pink", "brown" },
 				default = "uniform",
-				fn_set = function(val) type = val end
+				fn_set = function(val) type = val; pos = NOISE_BLOCK end
+			}, {
+				id = "seed",
+				description = "Random seed (restarts the sequence)",
+				max = 2^32,
+				fn_set = function(val) gen:seed(val); pos = NOISE_BLOCK end
 			},
 		},
 
 		fn_gen = function()
-
-			if type == "uniform" then
-				return rand()
-			end
-		
-			if type == "gaussian" then
-
-				local x1, x2, w
-				repeat
-					x1, x2 = rand(), rand()
-					w = x1 * x1 + x2 * x2
-				until w < 1
-				w = sqrt((-2 * log(w)) / w)
-				y1 = x1 * w
-				y2 = x2 * w
-				return y1
+			if pos == NOISE_BLOCK then
+				gen:fill(type, buf, NOISE_BLOCK)
+				pos = 0
 			end
+			pos = pos + 1
+			return buf[pos - 1]
 		end,
 
 	}, init)
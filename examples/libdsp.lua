@@ -0,0 +1,642 @@
+-- libdsp.lua
+-- ffi bindings for the native dsp kernels in `source/projects/libdsp`
+--
+-- usage (no setup needed inside luajit~ or luajit.stk~):
+--
+--    local libdsp = require 'libdsp'
+--    libdsp.scale_linear(50, 1, 127, 1, 100)
+--
+-- the externals set LIBDSP_PATH to the library in the package's `support`
+-- folder. Outside of Max set it before requiring this module.
+--
+-- Plain C functions are reachable directly on the module (or via
+-- `libdsp.C` in hot loops); lua helpers live in sub-tables.
+
+local ffi = require 'ffi'
+
+ffi.cdef[[
+double scale_linear(double x, double in_min, double in_max, double out_min, double out_max);
+double scale_sine1(double x, double in_min, double in_max, double out_min, double out_max);
+double scale_sine2(double x, double in_min, double in_max, double out_min, double out_max);
+double scale_exp1(double x, double s, double in_min, double in_max, double out_min, double out_max);
+double scale_exp2(double x, double s, double in_min, double in_max, double out_min, double out_max);
+double scale_log1(double x, double p, double i_min, double i_max, double o_min, double o_max);
+double scale_log2(double x, double p, double i_min, double i_max, double o_min, double o_max);
+
+const double* dsp_store_publish(const char* name, const double* data, size_t count);
+const double* dsp_store_lookup(const char* name, size_t* count);
+void dsp_store_release(const double* data);
+size_t dsp_store_size(const double* data);
+
+typedef struct dsp_stream dsp_stream;
+dsp_stream* dsp_stream_open(const char* path, size_t ring_frames);
+void dsp_stream_close(dsp_stream* s);
+size_t dsp_stream_read(dsp_stream* s, float* out, size_t frames);
+size_t dsp_stream_read_double(dsp_stream* s, double* out, size_t frames);
+const float* dsp_stream_peek(dsp_stream* s, size_t* frames);
+void dsp_stream_advance(dsp_stream* s, size_t frames);
+void dsp_stream_seek(dsp_stream* s, size_t frame);
+void dsp_stream_loop(dsp_stream* s, int loop);
+int dsp_stream_done(dsp_stream* s);
+size_t dsp_stream_frames(const dsp_stream* s);
+int dsp_stream_channels(const dsp_stream* s);
+double dsp_stream_samplerate(const dsp_stream* s);
+size_t dsp_stream_position(const dsp_stream* s);
+
+const float* dsp_cache_load(const char* path);
+const float* dsp_cache_publish(const char* key, const float* samples, size_t frames, int channels, double samplerate);
+const float* dsp_cache_get(const char* key);
+void dsp_cache_release(const float* samples);
+size_t dsp_cache_frames(const float* samples);
+int dsp_cache_channels(const float* samples);
+double dsp_cache_samplerate(const float* samples);
+void dsp_cache_set_limit(size_t bytes);
+size_t dsp_cache_usage(void);
+
+typedef struct dsp_conv dsp_conv;
+dsp_conv* dsp_conv_new(const float* ir, size_t frames, size_t stride, size_t block, int threaded);
+void dsp_conv_free(dsp_conv* c);
+void dsp_conv_process(dsp_conv* c, const double* in, double* out, size_t frames);
+size_t dsp_conv_block(const dsp_conv* c);
+long dsp_conv_misses(const dsp_conv* c);
+
+typedef struct dsp_stft dsp_stft;
+dsp_stft* dsp_stft_new(size_t size, size_t hop, int polar, int spread);
+void dsp_stft_free(dsp_stft* s);
+size_t dsp_stft_feed(dsp_stft* s, const double* in, double* out, size_t frames);
+int dsp_stft_ready(const dsp_stft* s);
+float* dsp_stft_bins(dsp_stft* s, int which);
+void dsp_stft_synthesize(dsp_stft* s);
+size_t dsp_stft_size(const dsp_stft* s);
+size_t dsp_stft_hop(const dsp_stft* s);
+size_t dsp_stft_latency(const dsp_stft* s);
+
+typedef struct dsp_pvoc dsp_pvoc;
+dsp_pvoc* dsp_pvoc_new(size_t size, size_t hop, int spread);
+void dsp_pvoc_free(dsp_pvoc* p);
+void dsp_pvoc_set_ratio(dsp_pvoc* p, double ratio);
+void dsp_pvoc_process(dsp_pvoc* p, const double* in, double* out, size_t frames);
+size_t dsp_pvoc_latency(const dsp_pvoc* p);
+
+typedef struct dsp_oscbank dsp_oscbank;
+dsp_oscbank* dsp_oscbank_new(int count, double samplerate);
+void dsp_oscbank_free(dsp_oscbank* b);
+int dsp_oscbank_count(const dsp_oscbank* b);
+void dsp_oscbank_set_samplerate(dsp_oscbank* b, double samplerate);
+float* dsp_oscbank_freq(dsp_oscbank* b);
+float* dsp_oscbank_amp(dsp_oscbank* b);
+void dsp_oscbank_shape(dsp_oscbank* b, int i, int shape);
+void dsp_oscbank_table(dsp_oscbank* b, int i, const float* table, size_t size);
+void dsp_oscbank_phase(dsp_oscbank* b, int i, double phase);
+void dsp_oscbank_render(dsp_oscbank* b, double* out, size_t frames);
+
+double dsp_math_sin(double x, int tier);
+double dsp_math_cos(double x, int tier);
+double dsp_math_tan(double x, int tier);
+double dsp_math_exp2(double x, int tier);
+double dsp_math_log2(double x, int tier);
+double dsp_math_pow(double x, double y, int tier);
+double dsp_math_tanh(double x, int tier);
+double dsp_math_db_to_lin(double db, int tier);
+double dsp_math_lin_to_db(double x, int tier);
+void dsp_math_sin_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_cos_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_tan_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_exp2_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_log2_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_pow_n(double* out, const double* x, const double* y, size_t n, int tier);
+void dsp_math_tanh_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_db_to_lin_n(double* out, const double* in, size_t n, int tier);
+void dsp_math_lin_to_db_n(double* out, const double* in, size_t n, int tier);
+
+typedef struct dsp_noise dsp_noise;
+dsp_noise* dsp_noise_new(uint64_t seed);
+void dsp_noise_free(dsp_noise* nz);
+void dsp_noise_seed(dsp_noise* nz, uint64_t seed);
+double dsp_noise_next(dsp_noise* nz);
+void dsp_noise_fill(dsp_noise* nz, int kind, double* out, size_t frames);
+]]
+
+local C = ffi.load(LIBDSP_PATH or "libdsp")
+
+local libdsp = setmetatable({ C = C }, { __index = C })
+
+
+----------------------------------------------------------------------------------
+-- store: read-only arrays shared by every instance in the process
+--
+--    local wt = libdsp.store.publish("sine1024", values)   -- table or double*, n
+--    local wt, n = libdsp.store.lookup("sine1024")
+--    local y = wt[i]                                       -- const double*
+--
+-- views are released when they are garbage collected. Writing through a
+-- view faults: the pages are read-only.
+
+local store = {}
+
+local size_t1 = ffi.typeof("size_t[1]")
+local doubles = ffi.typeof("double[?]")
+
+function store.publish(name, values, count)
+   if type(values) == "table" then
+      count = #values
+      values = doubles(count, values)
+   end
+   local view = C.dsp_store_publish(name, values, count)
+   if view == nil then
+      error("libdsp.store: cannot publish '" .. name .. "'")
+   end
+   return ffi.gc(view, C.dsp_store_release), count
+end
+
+function store.lookup(name)
+   local count = size_t1()
+   local view = C.dsp_store_lookup(name, count)
+   if view == nil then
+      return nil
+   end
+   return ffi.gc(view, C.dsp_store_release), tonumber(count[0])
+end
+
+-- publish the result of `build()` unless another instance already did
+function store.get(name, build)
+   local view, count = store.lookup(name)
+   if view == nil then
+      view, count = store.publish(name, build())
+   end
+   return view, count
+end
+
+libdsp.store = store
+
+
+----------------------------------------------------------------------------------
+-- stream: WAV/AIFF files played from disk without loading them
+--
+--    local s = libdsp.stream.open("/path/to/long.wav")
+--    s:loop(true)
+--    local y = s:tick()                  -- next frame, first channel
+--    local n = s:read(floats, frames)    -- interleaved float*, or
+--    local p, n = s:peek()               -- zero-copy: n frames at p ...
+--    s:advance(n)                        -- ... then release them
+--
+-- a background thread decodes ahead of the reader, so opening is cheap and
+-- reading never waits for the disk (frames not decoded yet are silent).
+-- Open streams at load time; the file is closed when the stream is
+-- garbage collected.
+
+local stream = {}
+
+local floats = ffi.typeof("float[?]")
+local TICK_BLOCK = 64
+
+local Stream = {}
+Stream.__index = Stream
+
+function stream.open(path, read_ahead)
+   local s = C.dsp_stream_open(path, read_ahead or 0)
+   if s == nil then
+      error("libdsp.stream: cannot open '" .. path .. "'", 2)
+   end
+   local channels = C.dsp_stream_channels(s)
+   return setmetatable({
+      s = ffi.gc(s, C.dsp_stream_close),
+      channels = channels,
+      frames = tonumber(C.dsp_stream_frames(s)),
+      samplerate = C.dsp_stream_samplerate(s),
+      buf = floats(TICK_BLOCK * channels),
+      i = 0,
+      n = 0,
+   }, Stream)
+end
+
+-- one frame per call like stk's FileWvIn:tick(), read from the stream in blocks
+function Stream:tick(channel)
+   local i = self.i
+   if i >= self.n then
+      C.dsp_stream_read(self.s, self.buf, TICK_BLOCK)
+      self.n = TICK_BLOCK
+      i = 0
+   end
+   self.i = i + 1
+   return self.buf[i * self.channels + (channel or 0)]
+end
+
+-- interleaved float* (or double*, the layout of stk::StkFrames with read_double)
+function Stream:read(out, frames)
+   return tonumber(C.dsp_stream_read(self.s, out, frames))
+end
+
+function Stream:read_double(out, frames)
+   return tonumber(C.dsp_stream_read_double(self.s, out, frames))
+end
+
+function Stream:peek()
+   local n = size_t1()
+   local p = C.dsp_stream_peek(self.s, n)
+   return p, tonumber(n[0])
+end
+
+function Stream:advance(frames)
+   C.dsp_stream_advance(self.s, frames)
+end
+
+function Stream:seek(frame)
+   self.i, self.n = 0, 0
+   C.dsp_stream_seek(self.s, frame)
+end
+
+function Stream:loop(on)
+   C.dsp_stream_loop(self.s, on and 1 or 0)
+end
+
+function Stream:done()
+   return self.i >= self.n and C.dsp_stream_done(self.s) ~= 0
+end
+
+function Stream:position()
+   return tonumber(C.dsp_stream_position(self.s))
+end
+
+libdsp.stream = stream
+
+
+----------------------------------------------------------------------------------
+-- cache: decoded sample files and tables shared by every instance
+--
+--    local s, frames, channels, sr = libdsp.cache.load("/path/to/ir.wav")
+--    local y = s[i * channels + c]                 -- const float*, interleaved
+--    libdsp.cache.publish("saw2048", values, 2048) -- table or float*
+--    local t, n = libdsp.cache.get("saw2048")      -- lock-free, nil if absent
+--    libdsp.cache.limit(512 * 1024 * 1024)         -- bytes kept when unused
+--
+-- the same file (or identical contents under another name) is decoded
+-- once per process. Views are released when garbage collected; released
+-- entries stay cached until the limit is reached (least recently used go
+-- first). load and publish may decode or copy: call them at load time.
+
+local cache = {}
+
+local function cache_view(view)
+   if view == nil then
+      return nil
+   end
+   return ffi.gc(view, C.dsp_cache_release), tonumber(C.dsp_cache_frames(view)),
+      C.dsp_cache_channels(view), C.dsp_cache_samplerate(view)
+end
+
+function cache.load(path)
+   return cache_view(C.dsp_cache_load(path))
+end
+
+function cache.get(key)
+   return cache_view(C.dsp_cache_get(key))
+end
+
+function cache.publish(key, values, frames, channels, samplerate)
+   channels = channels or 1
+   if type(values) == "table" then
+      frames = frames or math.floor(#values / channels)
+      values = floats(frames * channels, values)
+   end
+   local view = C.dsp_cache_publish(key, values, frames, channels, samplerate or 0)
+   if view == nil then
+      error("libdsp.cache: cannot publish '" .. key .. "'", 2)
+   end
+   return cache_view(view)
+end
+
+function cache.limit(bytes)
+   C.dsp_cache_set_limit(bytes)
+end
+
+function cache.usage()
+   return tonumber(C.dsp_cache_usage())
+end
+
+libdsp.cache = cache
+
+
+----------------------------------------------------------------------------------
+-- conv: partitioned fft convolution for long impulse responses
+--
+--    local ir, frames, channels = libdsp.cache.load("/path/to/hall.wav")
+--    local rev = libdsp.conv.new(ir, frames, { stride = channels, threaded = true })
+--    BLOCKS.hall = function(inp, out, n) rev:process(inp, out, n) end
+--
+-- ir is a float* (with `frames`) or a table. Options: block (partition
+-- size, 256 by default; no latency when it divides the vector size),
+-- stride (IR channels when interleaved), threaded (tail on libdsp's
+-- background thread, shared by all convolvers: flat cost on the audio
+-- thread whatever the IR length). Create convolvers at load time, the IR
+-- is transformed when they are created.
+
+local conv = {}
+
+local double_ptr = ffi.typeof("double *")
+
+local Conv = {}
+Conv.__index = Conv
+
+function conv.new(ir, frames, opts)
+   opts = opts or {}
+   if type(ir) == "table" then
+      frames = frames or #ir
+      ir = floats(frames, ir)
+   end
+   local c = C.dsp_conv_new(ir, frames, opts.stride or 1, opts.block or 0, opts.threaded and 1 or 0)
+   if c == nil then
+      error("libdsp.conv: cannot create a convolver", 2)
+   end
+   return setmetatable({ c = ffi.gc(c, C.dsp_conv_free), block = tonumber(C.dsp_conv_block(c)) }, Conv)
+end
+
+-- in and out are double* or lightuserdata (the BLOCKS contract)
+function Conv:process(inp, out, frames)
+   C.dsp_conv_process(self.c, ffi.cast(double_ptr, inp), ffi.cast(double_ptr, out), frames)
+end
+
+function Conv:misses()
+   return tonumber(C.dsp_conv_misses(self.c))
+end
+
+libdsp.conv = conv
+
+
+----------------------------------------------------------------------------------
+-- stft: spectral processing with windowing and overlap-add done natively
+--
+--    local spec = libdsp.stft.new{ size = 2048, hop = 512, polar = true }
+--    BLOCKS.blur = function(inp, out, n)
+--       spec:process(inp, out, n, function(mag, phase, bins)
+--          for k = 0, bins - 1 do phase[k] = phase[k] + math.random() end
+--       end)
+--    end
+--
+-- The function runs once per hop with float* bins (mag/phase when polar,
+-- re/im otherwise) to change in place; it is a plain lua call, so it
+-- compiles with the rest of the block. Output is delayed by spec.latency
+-- samples (the fft size). size defaults to 1024, hop to size / 4.
+--
+-- A frame's work lands in the vector where its hop ends: with a hop of
+-- eight vectors, one vector in eight does a whole frame and the others
+-- none. spread = true computes each frame in slices during the next hop
+-- instead, so every vector does an eighth, for hop samples more latency.
+-- The function still runs in one piece, in one of those vectors.
+
+local stft = {}
+
+local Stft = {}
+Stft.__index = Stft
+
+function stft.new(opts)
+   opts = opts or {}
+   local size = opts.size or 1024
+   local s = C.dsp_stft_new(size, opts.hop or size / 4, opts.polar and 1 or 0, opts.spread and 1 or 0)
+   if s == nil then
+      error("libdsp.stft: size must be a power of two and hop at most size", 2)
+   end
+   return setmetatable({
+      s = ffi.gc(s, C.dsp_stft_free),
+      a = C.dsp_stft_bins(s, 0),
+      b = C.dsp_stft_bins(s, 1),
+      bins = size / 2 + 1,
+      size = size,
+      hop = tonumber(C.dsp_stft_hop(s)),
+      latency = tonumber(C.dsp_stft_latency(s)),
+   }, Stft)
+end
+
+-- in and out are double* or lightuserdata (the BLOCKS contract)
+function Stft:process(inp, out, frames, fn)
+   local s = self.s
+   inp, out = ffi.cast(double_ptr, inp), ffi.cast(double_ptr, out)
+   local done = 0
+   while done < frames do
+      done = done + tonumber(C.dsp_stft_feed(s, inp + done, out + done, frames - done))
+      if C.dsp_stft_ready(s) ~= 0 then
+         fn(self.a, self.b, self.bins)
+         C.dsp_stft_synthesize(s)
+      end
+   end
+end
+
+libdsp.stft = stft
+
+
+----------------------------------------------------------------------------------
+-- pvoc: phase-locked phase vocoder pitch shifter, entirely native
+--
+--    local shift = libdsp.pvoc.new{ size = 2048, hop = 512, spread = true }
+--    BLOCKS.up = function(inp, out, n, p1) shift:ratio(p1) shift:process(inp, out, n) end
+--    LATENCY.up = shift.latency
+--
+-- The cost is one frame per hop (about 130 us at size 2048). size defaults
+-- to 2048, hop to size / 4; spread as for stft, which makes the cost per
+-- vector even.
+
+local pvoc = {}
+
+local Pvoc = {}
+Pvoc.__index = Pvoc
+
+function pvoc.new(opts)
+   opts = opts or {}
+   local p = C.dsp_pvoc_new(opts.size or 0, opts.hop or 0, opts.spread and 1 or 0)
+   if p == nil then
+      error("libdsp.pvoc: size must be a power of two and hop at most size", 2)
+   end
+   return setmetatable({ p = ffi.gc(p, C.dsp_pvoc_free), latency = tonumber(C.dsp_pvoc_latency(p)) }, Pvoc)
+end
+
+function Pvoc:ratio(r)
+   C.dsp_pvoc_set_ratio(self.p, r)
+end
+
+-- in and out are double* or lightuserdata (the BLOCKS contract)
+function Pvoc:process(inp, out, frames)
+   C.dsp_pvoc_process(self.p, ffi.cast(double_ptr, inp), ffi.cast(double_ptr, out), frames)
+end
+
+libdsp.pvoc = pvoc
+
+
+----------------------------------------------------------------------------------
+-- oscbank: band-limited oscillators summed natively, one call per vector
+--
+--    local bank = libdsp.oscbank.new(256, { shape = "sine" })
+--    for k = 0, 255 do bank.freq[k] = 110 * (k + 1); bank.amp[k] = 0.1 / (k + 1) end
+--    BLOCKS.additive = function(inp, out, n) bank:render(out, n) end
+--
+-- freq (Hz) and amp are float arrays indexed from 0, written between
+-- renders without any calls; amplitude changes are ramped over a vector.
+-- Shapes: sine, saw, square, triangle (PolyBLEP) and table (a cycle of
+-- floats, e.g. from libdsp.store or libdsp.cache, kept alive by the bank).
+-- Without opts.samplerate a bank follows SAMPLE_RATE, which the externals
+-- update when the dsp rate or the oversampling factor changes.
+
+local oscbank = {}
+
+local SHAPES = { sine = 0, saw = 1, square = 2, triangle = 3, table = 4 }
+
+local Oscbank = {}
+Oscbank.__index = Oscbank
+
+function oscbank.new(count, opts)
+   opts = opts or {}
+   local rate = opts.samplerate or SAMPLE_RATE or 44100
+   local b = C.dsp_oscbank_new(count, rate)
+   if b == nil then
+      error("libdsp.oscbank: cannot create a bank of " .. tostring(count), 2)
+   end
+   local self = setmetatable({
+      b = ffi.gc(b, C.dsp_oscbank_free),
+      freq = C.dsp_oscbank_freq(b),
+      amp = C.dsp_oscbank_amp(b),
+      count = count,
+      tables = {},
+      rate = rate,
+      follow = opts.samplerate == nil,
+   }, Oscbank)
+   if opts.shape then
+      for i = 0, count - 1 do self:shape(i, opts.shape) end
+   end
+   return self
+end
+
+function Oscbank:shape(i, name)
+   local shape = SHAPES[name]
+   if shape == nil then
+      error("libdsp.oscbank: unknown shape " .. tostring(name), 2)
+   end
+   C.dsp_oscbank_shape(self.b, i, shape)
+end
+
+-- t: float* (with size) or a table of values
+function Oscbank:table(i, t, size)
+   if type(t) == "table" then
+      size = #t
+      t = floats(size, t)
+   end
+   self.tables[i] = t
+   C.dsp_oscbank_table(self.b, i, t, size)
+end
+
+-- a fixed rate, SAMPLE_RATE is no longer followed
+function Oscbank:samplerate(rate)
+   self.rate, self.follow = rate, false
+   C.dsp_oscbank_set_samplerate(self.b, rate)
+end
+
+function Oscbank:phase(i, cycles)
+   C.dsp_oscbank_phase(self.b, i, cycles)
+end
+
+-- out is a double* or lightuserdata (the BLOCKS contract)
+function Oscbank:render(out, frames)
+   local rate = self.follow and SAMPLE_RATE
+   if rate and rate ~= self.rate then
+      self.rate = rate
+      C.dsp_oscbank_set_samplerate(self.b, rate)
+   end
+   C.dsp_oscbank_render(self.b, ffi.cast(double_ptr, out), frames)
+end
+
+libdsp.oscbank = oscbank
+
+
+----------------------------------------------------------------------------------
+-- math: sin, cos, tan, exp2, log2, pow, tanh, db_to_lin and lin_to_db in
+-- three accuracy tiers, as plain functions and as block versions
+--
+--    local fm = libdsp.math.medium
+--    local g = fm.db_to_lin(p1)                    -- one value
+--    fm.tanh_n(out, inp, n)                        -- a vector (out may be inp)
+--    fm.pow_n(out, x, y, n)
+--
+-- fast is about 1e-4 (modulation, control rates), medium about 1e-7
+-- (float precision), precise about 1e-13. The block versions are up to 6
+-- times faster than a loop over math.* (exp2 and log2 gain least, and
+-- precise exp2 none); the scalar ones are worth it for sin/cos/tanh and
+-- the dB conversions, where libm is slowest.
+
+local math_names = { "sin", "cos", "tan", "exp2", "log2", "tanh", "db_to_lin", "lin_to_db" }
+
+local function math_tier(tier)
+   local t = {}
+   for _, name in ipairs(math_names) do
+      local f, f_n = C["dsp_math_" .. name], C["dsp_math_" .. name .. "_n"]
+      t[name] = function(x) return f(x, tier) end
+      t[name .. "_n"] = function(out, inp, n)
+         f_n(ffi.cast(double_ptr, out), ffi.cast(double_ptr, inp), n, tier)
+      end
+   end
+   t.pow = function(x, y) return C.dsp_math_pow(x, y, tier) end
+   t.pow_n = function(out, x, y, n)
+      C.dsp_math_pow_n(ffi.cast(double_ptr, out), ffi.cast(double_ptr, x), ffi.cast(double_ptr, y), n, tier)
+   end
+   return t
+end
+
+libdsp.math = {
+   fast = math_tier(0),
+   medium = math_tier(1),
+   precise = math_tier(2),
+}
+
+
+----------------------------------------------------------------------------------
+-- noise: a random number generator per instance, with block fills
+--
+--    local gen = libdsp.noise.new()            -- or .new(seed)
+--    BLOCKS.hiss = function(inp, out, n) gen:pink(out, n) end
+--    local x = gen:next()                       -- one uniform value
+--
+-- Fills: uniform ([-1, 1)), gaussian (unit variance), pink and brown
+-- (about [-1, 1]). Unlike math.random, every generator has its own state,
+-- so voices do not share (and correlate through) one sequence. Without a
+-- seed (or with 0), every generator gets one of its own, different in every
+-- instance and every run; pass a seed for reproducible renders. gen:seed(s)
+-- restarts a generator.
+
+local noise = {}
+
+local NOISE_KINDS = { uniform = 0, gaussian = 1, pink = 2, brown = 3 }
+
+local Noise = {}
+Noise.__index = Noise
+
+function noise.new(seed)
+   local nz = C.dsp_noise_new(seed or 0)
+   if nz == nil then
+      error("libdsp.noise: out of memory", 2)
+   end
+   return setmetatable({ nz = ffi.gc(nz, C.dsp_noise_free) }, Noise)
+end
+
+function Noise:seed(seed)
+   C.dsp_noise_seed(self.nz, seed)
+end
+
+function Noise:next()
+   return C.dsp_noise_next(self.nz)
+end
+
+-- out is a double* or lightuserdata (the BLOCKS contract)
+function Noise:fill(kind, out, frames)
+   local k = NOISE_KINDS[kind]
+   if k == nil then
+      error("libdsp.noise: unknown kind " .. tostring(kind), 2)
+   end
+   C.dsp_noise_fill(self.nz, k, ffi.cast(double_ptr, out), frames)
+end
+
+for kind, k in pairs(NOISE_KINDS) do
+   Noise[kind] = function(self, out, frames)
+      C.dsp_noise_fill(self.nz, k, ffi.cast(double_ptr, out), frames)
+   end
+end
+
+libdsp.noise = noise
+
+return libdsp
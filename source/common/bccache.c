@@ -0,0 +1,244 @@
+/**
+    @file
+    bccache: on-disk luajit bytecode cache for lua dsp scripts
+*/
+
+#include "bccache.h"
+
+#include <lauxlib.h>
+#include <luajit.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define bccache_mkdir(p) _mkdir(p)
+#define bccache_getpid() _getpid()
+#else
+#include <unistd.h>
+#define bccache_mkdir(p) mkdir(p, 0755)
+#define bccache_getpid() getpid()
+#endif
+
+#define BCCACHE_MAGIC   0x4342544aU     // "JTBC"
+#define BCCACHE_REGKEY  "bccache.dir"   // registry key of the cache directory
+#define BCCACHE_PATH_CHARS 4096
+
+
+// header written in front of the bytecode of every cache entry
+typedef struct _bccache_header {
+    uint32_t magic;
+    uint32_t version;   // LUAJIT_VERSION_NUM of the writer
+    int64_t mtime;      // source modification time
+    uint64_t size;      // source size in bytes
+    uint64_t hash;      // fnv-1a hash of the source
+} t_bccache_header;
+
+// growable buffer for lua_dump
+typedef struct _bccache_buf {
+    char *data;
+    size_t len;
+    size_t cap;
+} t_bccache_buf;
+
+
+//-----------------------------------------------------------------------------------------------
+
+static uint64_t bccache_hash(const char *data, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+
+static char *bccache_readfile(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    char *data = NULL;
+    long size;
+
+    if (f == NULL) {
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+        data = (char *)malloc(size > 0 ? (size_t)size : 1);
+        if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+        *len = (size_t)size;
+    }
+    fclose(f);
+    return data;
+}
+
+
+static int bccache_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    t_bccache_buf *buf = (t_bccache_buf *)ud;
+    (void)L;
+
+    if (buf->len + sz > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 4096;
+        while (cap < buf->len + sz) {
+            cap *= 2;
+        }
+        char *data = (char *)realloc(buf->data, cap);
+        if (data == NULL) {
+            return 1;
+        }
+        buf->data = data;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, p, sz);
+    buf->len += sz;
+    return 0;
+}
+
+
+static const char *bccache_dir(lua_State *L)
+{
+    lua_getfield(L, LUA_REGISTRYINDEX, BCCACHE_REGKEY);
+    const char *dir = lua_tostring(L, -1);
+    lua_pop(L, 1);  // the string stays alive in the registry
+    return dir;
+}
+
+
+// dump the function on top of the stack into the cache entry
+static void bccache_store(lua_State *L, const char *entry, const t_bccache_header *header)
+{
+    t_bccache_buf buf = { NULL, 0, 0 };
+    char tmp[BCCACHE_PATH_CHARS];
+
+    if (lua_dump(L, bccache_writer, &buf) == 0 && buf.data) {
+        // write to a temporary file first so readers never see partial entries
+        snprintf(tmp, sizeof(tmp), "%s.%d.tmp", entry, (int)bccache_getpid());
+        FILE *f = fopen(tmp, "wb");
+        if (f) {
+            int ok = fwrite(header, sizeof(*header), 1, f) == 1
+                  && fwrite(buf.data, 1, buf.len, f) == buf.len;
+            ok = (fclose(f) == 0) && ok;
+#ifdef _WIN32
+            if (ok) {
+                remove(entry);
+            }
+#endif
+            if (!ok || rename(tmp, entry) != 0) {
+                remove(tmp);
+            }
+        }
+    }
+    free(buf.data);
+}
+
+
+// `require` searcher: package.searchpath + bccache_loadfile
+static int bccache_searcher(lua_State *L)
+{
+    const char *name = luaL_checkstring(L, 1);
+
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchpath");
+    if (!lua_isfunction(L, -1)) {
+        lua_pushliteral(L, "");
+        return 1;
+    }
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+    if (lua_isnil(L, -2)) {
+        return 1;   // error message listing the tried paths
+    }
+
+    const char *path = lua_tostring(L, -2);
+    if (bccache_loadfile(L, path) != 0) {
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s",
+                          name, path, lua_tostring(L, -1));
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+void bccache_install(lua_State *L, const char *cache_dir)
+{
+    bccache_mkdir(cache_dir);   // may already exist
+
+    lua_pushstring(L, cache_dir);
+    lua_setfield(L, LUA_REGISTRYINDEX, BCCACHE_REGKEY);
+
+    // insert the searcher right after package.preload's
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "loaders");
+    for (int i = (int)lua_objlen(L, -1); i >= 2; i--) {
+        lua_rawgeti(L, -1, i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pushcfunction(L, bccache_searcher);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
+}
+
+
+int bccache_loadfile(lua_State *L, const char *path)
+{
+    const char *dir = bccache_dir(L);
+    char entry[BCCACHE_PATH_CHARS];
+    t_bccache_header header;
+    struct stat st;
+    size_t len = 0;
+    size_t cached_len = 0;
+    int status;
+
+    if (dir == NULL || stat(path, &st) != 0) {
+        return luaL_loadfile(L, path);
+    }
+    char *src = bccache_readfile(path, &len);
+    if (src == NULL) {
+        return luaL_loadfile(L, path);
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = BCCACHE_MAGIC;
+    header.version = LUAJIT_VERSION_NUM;
+    header.mtime = (int64_t)st.st_mtime;
+    header.size = (uint64_t)len;
+    header.hash = bccache_hash(src, len);
+
+    snprintf(entry, sizeof(entry), "%s/%016llx.ljbc", dir,
+             (unsigned long long)bccache_hash(path, strlen(path)));
+
+    const char *chunkname = lua_pushfstring(L, "@%s", path);
+
+    char *cached = bccache_readfile(entry, &cached_len);
+    if (cached && cached_len > sizeof(header) && memcmp(cached, &header, sizeof(header)) == 0) {
+        status = luaL_loadbuffer(L, cached + sizeof(header), cached_len - sizeof(header), chunkname);
+        if (status == 0) {
+            free(cached);
+            free(src);
+            lua_remove(L, -2);  // chunkname
+            return 0;
+        }
+        lua_pop(L, 1);  // incompatible entry: recompile and overwrite it
+    }
+    free(cached);
+
+    status = luaL_loadbuffer(L, src, len, chunkname);
+    if (status == 0) {
+        bccache_store(L, entry, &header);
+    }
+    free(src);
+    lua_remove(L, -2);  // chunkname
+    return status;
+}
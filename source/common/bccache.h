@@ -0,0 +1,32 @@
+/**
+    @file
+    bccache: on-disk luajit bytecode cache for lua dsp scripts
+
+    Scripts (and modules found by `require`) are compiled once and their
+    bytecode is stored in a cache directory. An entry is only reused if the
+    source path, mtime, size and content hash all still match.
+*/
+
+#ifndef BCCACHE_H
+#define BCCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lua.h>
+
+// set the cache directory for this state and install a `require` searcher
+// that loads lua modules through the cache (created on demand)
+void bccache_install(lua_State *L, const char *cache_dir);
+
+// like luaL_loadfile, but hits the cache when valid (falls back to luaL_loadfile
+// if bccache_install was not called). Returns 0 and pushes the chunk, or
+// returns an error code and pushes the error message.
+int bccache_loadfile(lua_State *L, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BCCACHE_H
@@ -0,0 +1,108 @@
+// bench_open.c
+//
+// Simulates opening a patch with N luajit~ instances: every instance creates
+// a lua state and runs examples/dsp.lua (which requires dsp_worp and fun).
+//
+//     ./bench_open [instances=50]
+//
+// Reports the total time without the bytecode cache, with a cold cache
+// (first open, entries are written) and with a warm cache. Build with
+// build.sh, after libdsp has been built into support/.
+
+#include "bccache.h"
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define EXAMPLES "../../../examples"
+#define SCRIPT EXAMPLES "/dsp.lua"
+#define LIBDSP "../../../support/libdsp.so"
+#define CACHE_DIR "./bench_cache"
+
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+
+// no buffer~ in the bench: every name gets the same empty view
+static int buffer_view(lua_State *L)
+{
+    static double view[8];
+    lua_pushlightuserdata(L, view);
+    return 1;
+}
+
+
+static lua_State *open_instance(int use_cache)
+{
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+
+    lua_getglobal(L, "package");
+    lua_pushstring(L, EXAMPLES "/?.lua");
+    lua_setfield(L, -2, "path");
+    lua_pop(L, 1);
+
+    // as set by the externals before the script runs
+    lua_pushstring(L, LIBDSP);
+    lua_setglobal(L, "LIBDSP_PATH");
+    lua_pushstring(L, CACHE_DIR);
+    lua_setglobal(L, "CACHE_DIR");
+    lua_register(L, "buffer_view", buffer_view);
+
+    if (use_cache) {
+        bccache_install(L, CACHE_DIR);
+    }
+    if (bccache_loadfile(L, SCRIPT) || lua_pcall(L, 0, 0, 0)) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        exit(1);
+    }
+    return L;
+}
+
+
+static double open_patch(int instances, int use_cache)
+{
+    lua_State **states = malloc(instances * sizeof(lua_State *));
+    double t0 = now_ms();
+
+    for (int i = 0; i < instances; i++) {
+        states[i] = open_instance(use_cache);
+    }
+    double elapsed = now_ms() - t0;
+
+    for (int i = 0; i < instances; i++) {
+        lua_close(states[i]);
+    }
+    free(states);
+    return elapsed;
+}
+
+
+int main(int argc, char **argv)
+{
+    int instances = argc > 1 ? atoi(argv[1]) : 50;
+
+    system("rm -rf " CACHE_DIR);
+    system("mkdir -p " CACHE_DIR);
+
+    // the library dsp_native compiles for dsp.lua is cached in CACHE_DIR as
+    // well: build it before timing, so only the bytecode cache differs
+    open_patch(1, 0);
+
+    printf("instances: %d\n", instances);
+    printf("no cache:   %8.2f ms\n", open_patch(instances, 0));
+    system("rm -f " CACHE_DIR "/*.ljbc");
+    printf("cold cache: %8.2f ms\n", open_patch(instances, 1));
+    printf("warm cache: %8.2f ms\n", open_patch(instances, 1));
+    return 0;
+}
@@ -0,0 +1,14 @@
+DEPS=../../../build/deps
+LUAJIT=${DEPS}/luajit-install
+
+
+cc -O2 \
+	-I.. \
+	-I${LUAJIT}/include/luajit-2.1 \
+	-o bench_open \
+	bench_open.c \
+	../bccache.c \
+	${LUAJIT}/lib/libluajit-5.1.a \
+	-lm -ldl
+
+./bench_open 50
@@ -0,0 +1,143 @@
+/**
+    @file
+    blockops: vectorized scans over the audio vectors of a perform routine
+*/
+
+#include "blockops.h"
+
+#include <math.h>
+
+#if defined(_MSC_VER) && defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCKOPS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BLOCKOPS_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+double blockops_peak(const double *x, long n)
+{
+    double peak = 0.0;
+    long i = 0;
+
+#if defined(BLOCKOPS_SSE2)
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d m0 = _mm_setzero_pd();
+    __m128d m1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        m0 = _mm_max_pd(m0, _mm_andnot_pd(sign, _mm_loadu_pd(x + i)));
+        m1 = _mm_max_pd(m1, _mm_andnot_pd(sign, _mm_loadu_pd(x + i + 2)));
+    }
+    m0 = _mm_max_pd(m0, m1);
+    m0 = _mm_max_sd(m0, _mm_unpackhi_pd(m0, m0));
+    peak = _mm_cvtsd_f64(m0);
+#elif defined(BLOCKOPS_NEON)
+    float64x2_t m0 = vdupq_n_f64(0.0);
+    float64x2_t m1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        m0 = vmaxq_f64(m0, vabsq_f64(vld1q_f64(x + i)));
+        m1 = vmaxq_f64(m1, vabsq_f64(vld1q_f64(x + i + 2)));
+    }
+    peak = vmaxvq_f64(vmaxq_f64(m0, m1));
+#endif
+
+    for (; i < n; i++) {
+        double a = fabs(x[i]);
+        if (a > peak) {
+            peak = a;
+        }
+    }
+    return peak;
+}
+
+
+long blockops_sanitize(double *x, long n)
+{
+    long bad = 0;
+    long i = 0;
+
+    // x * 0 is 0 for finite x and NaN for NaN and +-Inf: scan for any
+    // unordered lane first, the common all-finite case writes nothing
+#if defined(BLOCKOPS_SSE2)
+    const __m128d zero = _mm_setzero_pd();
+    __m128d ok = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (; i + 2 <= n; i += 2) {
+        __m128d t = _mm_mul_pd(_mm_loadu_pd(x + i), zero);
+        ok = _mm_and_pd(ok, _mm_cmpord_pd(t, t));
+    }
+    if (_mm_movemask_pd(ok) == 3) {
+        for (; i < n; i++) {
+            if (!isfinite(x[i])) {
+                x[i] = 0.0;
+                bad++;
+            }
+        }
+        return bad;
+    }
+    i = 0;
+#elif defined(BLOCKOPS_NEON)
+    uint64x2_t ok = vdupq_n_u64(~0ULL);
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t t = vmulq_n_f64(vld1q_f64(x + i), 0.0);
+        ok = vandq_u64(ok, vceqq_f64(t, t));
+    }
+    if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) == ~0ULL) {
+        for (; i < n; i++) {
+            if (!isfinite(x[i])) {
+                x[i] = 0.0;
+                bad++;
+            }
+        }
+        return bad;
+    }
+    i = 0;
+#endif
+
+    for (; i < n; i++) {
+        if (!isfinite(x[i])) {
+            x[i] = 0.0;
+            bad++;
+        }
+    }
+    return bad;
+}
+
+
+t_blockops_fpstate blockops_ftz_enter(void)
+{
+#if defined(BLOCKOPS_SSE2)
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | 0x8040);   // FTZ | DAZ
+    return csr;
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+    unsigned long long fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24)));    // FZ
+    return fpcr;
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    unsigned long long fpcr = _ReadStatusReg(ARM64_FPCR);
+    _WriteStatusReg(ARM64_FPCR, fpcr | (1ULL << 24));
+    return fpcr;
+#else
+    return 0;
+#endif
+}
+
+
+void blockops_ftz_exit(t_blockops_fpstate state)
+{
+#if defined(BLOCKOPS_SSE2)
+    _mm_setcsr((unsigned int)state);
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(state));
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    _WriteStatusReg(ARM64_FPCR, (__int64)state);
+#else
+    (void)state;
+#endif
+}
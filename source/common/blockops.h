@@ -0,0 +1,35 @@
+/**
+    @file
+    blockops: vectorized scans over the audio vectors of a perform routine
+
+    Cheap whole-vector checks that let perform routines decide what to do
+    without looking at every sample in lua. SSE2 and NEON are used where the
+    compiler targets them, with a scalar fallback elsewhere.
+*/
+
+#ifndef BLOCKOPS_H
+#define BLOCKOPS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// floating point control state saved by blockops_ftz_enter
+typedef unsigned long long t_blockops_fpstate;
+
+// largest absolute value in x[0..n)
+double blockops_peak(const double *x, long n);
+
+// replace NaN and +-Inf in x[0..n) by 0, returns how many were replaced
+long blockops_sanitize(double *x, long n);
+
+// flush denormal results and inputs to zero until blockops_ftz_exit
+// (FTZ/DAZ on x86, FZ on arm64), returns the state to restore
+t_blockops_fpstate blockops_ftz_enter(void);
+void blockops_ftz_exit(t_blockops_fpstate state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLOCKOPS_H
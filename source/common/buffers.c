@@ -0,0 +1,152 @@
+/**
+    @file
+    buffers: zero-copy access to named buffer~ objects from lua
+*/
+
+#include "buffers.h"
+
+#include "ext_buffer.h"
+
+#include <lauxlib.h>
+
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define buffers_load(p) (MemoryBarrier(), *(volatile long *)(p))
+#define buffers_store(p, v) (MemoryBarrier(), *(volatile long *)(p) = (v), MemoryBarrier())
+#else
+#define buffers_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define buffers_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+
+typedef struct _buffers_slot {
+    t_symbol *name;
+    t_buffer_ref *ref;
+    t_buffer_obj *locked;   // buffer~ locked by perform (or NULL)
+    t_buffers_view view;
+} t_buffers_slot;
+
+struct _buffers {
+    t_object *owner;
+    long count;             // slots in use, published after a slot is set up
+    t_buffers_slot slots[BUFFERS_MAX];
+};
+
+
+t_buffers *buffers_new(t_object *owner)
+{
+    t_buffers *b = (t_buffers *)calloc(1, sizeof(t_buffers));
+
+    if (b) {
+        b->owner = owner;
+    }
+    return b;
+}
+
+
+void buffers_free(t_buffers *b)
+{
+    if (b) {
+        for (long i = 0; i < b->count; i++) {
+            object_free(b->slots[i].ref);
+        }
+        free(b);
+    }
+}
+
+
+// slots are never released, so a rerun script finds its bindings again
+static int buffers_lua_view(lua_State *L)
+{
+    t_buffers *b = (t_buffers *)lua_touserdata(L, lua_upvalueindex(1));
+    t_symbol *name = gensym(luaL_checkstring(L, 1));
+    t_buffers_slot *slot;
+
+    for (long i = 0; i < b->count; i++) {
+        if (b->slots[i].name == name) {
+            lua_pushlightuserdata(L, &b->slots[i].view);
+            return 1;
+        }
+    }
+    if (b->count == BUFFERS_MAX) {
+        return luaL_error(L, "buffer_view: more than %d buffer~ bound", BUFFERS_MAX);
+    }
+
+    slot = &b->slots[b->count];
+    slot->name = name;
+    slot->ref = buffer_ref_new(b->owner, name);
+    slot->locked = NULL;
+    slot->view.samples = NULL;
+    slot->view.samplerate = 0.0;
+    slot->view.frames = 0;
+    slot->view.channels = 0;
+    slot->view.modified = 0;
+    buffers_store(&b->count, b->count + 1);
+
+    lua_pushlightuserdata(L, &slot->view);
+    return 1;
+}
+
+
+void buffers_install(t_buffers *b, lua_State *L)
+{
+    lua_pushlightuserdata(L, b);
+    lua_pushcclosure(L, buffers_lua_view, 1);
+    lua_setglobal(L, "buffer_view");
+}
+
+
+void buffers_lock(t_buffers *b)
+{
+    long count = buffers_load(&b->count);
+
+    for (long i = 0; i < count; i++) {
+        t_buffers_slot *slot = &b->slots[i];
+        t_buffer_obj *obj = buffer_ref_getobject(slot->ref);
+        float *samples = obj ? buffer_locksamples(obj) : NULL;
+
+        if (samples) {
+            slot->locked = obj;
+            slot->view.samples = samples;
+            slot->view.samplerate = buffer_getsamplerate(obj);
+            slot->view.frames = (int32_t)buffer_getframecount(obj);
+            slot->view.channels = (int32_t)buffer_getchannelcount(obj);
+        } else {
+            slot->view.frames = 0;
+            slot->view.channels = 0;
+        }
+    }
+}
+
+
+void buffers_unlock(t_buffers *b)
+{
+    long count = buffers_load(&b->count);
+
+    for (long i = 0; i < count; i++) {
+        t_buffers_slot *slot = &b->slots[i];
+
+        if (slot->locked) {
+            if (slot->view.modified) {
+                buffer_setdirty(slot->locked);
+                slot->view.modified = 0;
+            }
+            buffer_unlocksamples(slot->locked);
+            slot->locked = NULL;
+            slot->view.samples = NULL;
+        }
+    }
+}
+
+
+t_max_err buffers_notify(t_buffers *b, t_symbol *s, t_symbol *msg, void *sender, void *data)
+{
+    long count = buffers_load(&b->count);
+
+    for (long i = 0; i < count; i++) {
+        buffer_ref_notify(b->slots[i].ref, s, msg, sender, data);
+    }
+    return MAX_ERR_NONE;
+}
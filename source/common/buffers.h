@@ -0,0 +1,57 @@
+/**
+    @file
+    buffers: zero-copy access to named buffer~ objects from lua
+
+    A script binds a buffer~ by name (dsp_buffer.lua) and gets an ffi view
+    of its interleaved float samples, frame and channel counts. The object
+    locks every bound buffer~ once per vector around its dsp functions and
+    unlocks it afterwards, marking it dirty if lua set `modified`. Outside
+    perform (and while no buffer~ of that name exists) `samples` is NULL.
+*/
+
+#ifndef BUFFERS_H
+#define BUFFERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ext.h"
+#include "ext_obex.h"
+
+#include <lua.h>
+#include <stdint.h>
+
+#define BUFFERS_MAX 16
+
+// what lua sees, keep in sync with dsp_buffer.lua. 32-bit counts so lua
+// reads them as plain numbers
+typedef struct _buffers_view {
+    float *samples;     // interleaved frames (NULL when not locked)
+    double samplerate;
+    int32_t frames;
+    int32_t channels;
+    int32_t modified;   // set by lua after writing samples
+} t_buffers_view;
+
+typedef struct _buffers t_buffers;
+
+t_buffers *buffers_new(t_object *owner);
+void buffers_free(t_buffers *b);
+
+// register buffer_view(name) as a global of L: binds (or finds) the buffer~
+// and returns its t_buffers_view as lightuserdata. Main thread only.
+void buffers_install(t_buffers *b, lua_State *L);
+
+// perform: lock every bound buffer~ before running lua, unlock after
+void buffers_lock(t_buffers *b);
+void buffers_unlock(t_buffers *b);
+
+// forward of the object's notify method, tracks buffer~ creation and removal
+t_max_err buffers_notify(t_buffers *b, t_symbol *s, t_symbol *msg, void *sender, void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUFFERS_H
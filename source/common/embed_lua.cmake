@@ -0,0 +1,57 @@
+# embed_lua_modules(<target> <module>...)
+#
+# Compiles the named lua modules from the package's `examples` folder to
+# luajit bytecode headers at build time and generates `embedded_modules.h`,
+# the table `embedded_install()` (embedded.c) registers in package.preload.
+#
+# Expects LUAJIT to point at the luajit install prefix.
+
+function(embed_lua_modules target)
+    set(examples ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/../../examples)
+    set(outdir ${CMAKE_CURRENT_BINARY_DIR}/embedded)
+    set(table ${outdir}/embedded_modules.h)
+
+    find_program(LUAJIT_BIN
+        NAMES luajit luajit-2.1.0-beta3
+        PATHS ${LUAJIT}/bin
+        NO_DEFAULT_PATH
+    )
+
+    file(MAKE_DIRECTORY ${outdir})
+    set(includes "")
+    set(entries "")
+    set(headers "")
+
+    if (LUAJIT_BIN)
+        foreach (module ${ARGN})
+            set(src ${examples}/${module}.lua)
+            set(header ${outdir}/${module}_bc.h)
+            # -g keeps debug info so errors still point at the source lines
+            add_custom_command(
+                OUTPUT ${header}
+                COMMAND ${CMAKE_COMMAND} -E env
+                    "LUA_PATH=${LUAJIT}/share/luajit-2.1/?.lua$<SEMICOLON>${LUAJIT}/share/luajit-2.1.0-beta3/?.lua$<SEMICOLON>$<SEMICOLON>"
+                    ${LUAJIT_BIN} -b -g -n ${module} ${src} ${header}
+                DEPENDS ${src}
+                COMMENT "Embedding ${module}.lua as bytecode"
+                VERBATIM
+            )
+            list(APPEND headers ${header})
+            string(APPEND includes "#include \"${module}_bc.h\"\n")
+            string(APPEND entries "    { \"${module}\", luaJIT_BC_${module}, luaJIT_BC_${module}_SIZE },\n")
+        endforeach ()
+    else ()
+        message(WARNING "luajit not found in ${LUAJIT}/bin: lua modules will not be embedded")
+    endif ()
+
+    file(CONFIGURE OUTPUT ${table} CONTENT
+"// generated by embed_lua.cmake, do not edit
+${includes}
+static const t_embedded_module embedded_modules[] = {
+${entries}    { NULL, NULL, 0 }
+};
+")
+
+    target_sources(${target} PRIVATE ${headers} ${table})
+    target_include_directories(${target} PRIVATE ${outdir})
+endfunction()
@@ -0,0 +1,37 @@
+/**
+    @file
+    embedded: stock lua modules linked into the externals as bytecode
+*/
+
+#include "embedded.h"
+
+#include <lauxlib.h>
+
+#include "embedded_modules.h"   // generated by embed_lua_modules()
+
+
+// package.preload loader: the module's index is the only upvalue
+static int embedded_loader(lua_State *L)
+{
+    const t_embedded_module *m = &embedded_modules[lua_tointeger(L, lua_upvalueindex(1))];
+
+    if (luaL_loadbuffer(L, (const char *)m->data, m->size, m->name) != 0) {
+        return lua_error(L);
+    }
+    lua_pushvalue(L, 1);    // module name
+    lua_call(L, 1, 1);
+    return 1;
+}
+
+
+void embedded_install(lua_State *L)
+{
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "preload");
+    for (int i = 0; embedded_modules[i].name != NULL; i++) {
+        lua_pushinteger(L, i);
+        lua_pushcclosure(L, embedded_loader, 1);
+        lua_setfield(L, -2, embedded_modules[i].name);
+    }
+    lua_pop(L, 2);
+}
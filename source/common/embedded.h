@@ -0,0 +1,33 @@
+/**
+    @file
+    embedded: stock lua modules linked into the externals as bytecode
+
+    The modules listed in each external's CMakeLists.txt are compiled with
+    `luajit -b` at build time (see embed_lua.cmake) and registered in
+    package.preload, so requiring them needs no filesystem search.
+*/
+
+#ifndef EMBEDDED_H
+#define EMBEDDED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lua.h>
+#include <stddef.h>
+
+typedef struct _embedded_module {
+    const char *name;
+    const unsigned char *data;
+    size_t size;
+} t_embedded_module;
+
+// register every embedded module in package.preload
+void embedded_install(lua_State *L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBEDDED_H
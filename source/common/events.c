@@ -0,0 +1,220 @@
+/**
+    @file
+    events: timestamped control events handed from Max's threads to perform
+*/
+
+#include "events.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define events_load(p) (MemoryBarrier(), *(volatile long *)(p))
+#define events_store(p, v) (MemoryBarrier(), *(volatile long *)(p) = (v), MemoryBarrier())
+#define events_cas(p, expected, v) \
+    (InterlockedCompareExchange((volatile long *)(p), (v), (expected)) == (expected))
+#define events_fence_release() MemoryBarrier()
+#define events_fence_acquire() MemoryBarrier()
+#else
+#define events_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define events_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define events_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define events_fence_acquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+#if !defined(_MSC_VER)
+static int events_cas(long *p, long expected, long v)
+{
+    return __atomic_compare_exchange_n(p, &expected, v, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+#endif
+
+
+// clock published by perform, read by producers (seqlock: odd while writing)
+typedef struct _events_clock {
+    long seq;
+    int64_t sample;
+    double ms;
+    double samplerate;
+    long vectorsize;
+} t_events_clock;
+
+// a slot is free for the producer claiming position pos while seq == pos,
+// and holds the event of pos for the consumer once seq == pos + 1
+typedef struct _events_slot {
+    long seq;
+    t_event ev;
+} t_events_slot;
+
+struct _events {
+    t_events_slot *ring;
+    long mask;
+    long head;      // next position to claim (producers)
+    long tail;      // next position to read (consumer)
+    t_events_clock clock;
+    t_event *stage; // consumer: drained events sorted by time
+    long staged;    // events in stage
+    long read;      // next event in stage
+};
+
+
+t_events *events_new(long capacity)
+{
+    t_events *q = (t_events *)calloc(1, sizeof(t_events));
+    long size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (q) {
+        q->ring = (t_events_slot *)calloc(size, sizeof(t_events_slot));
+        q->stage = (t_event *)calloc(size, sizeof(t_event));
+        if (q->ring == NULL || q->stage == NULL) {
+            free(q->ring);
+            free(q->stage);
+            free(q);
+            return NULL;
+        }
+        for (long i = 0; i < size; i++) {
+            q->ring[i].seq = i;
+        }
+        q->mask = size - 1;
+        q->clock.samplerate = 44100.0;
+        q->clock.vectorsize = 64;
+    }
+    return q;
+}
+
+
+void events_free(t_events *q)
+{
+    if (q) {
+        free(q->ring);
+        free(q->stage);
+        free(q);
+    }
+}
+
+
+static void events_drain(t_events *q);
+
+void events_clock(t_events *q, int64_t sample, double ms, double samplerate, long vectorsize)
+{
+    long seq = q->clock.seq;
+
+    events_store(&q->clock.seq, seq + 1);
+    events_fence_release();     // the fields below can't be written before the odd seq
+    q->clock.sample = sample;
+    q->clock.ms = ms;
+    q->clock.samplerate = samplerate;
+    q->clock.vectorsize = vectorsize;
+    events_store(&q->clock.seq, seq + 2);
+
+    events_drain(q);
+}
+
+
+int64_t events_time(t_events *q, double ms)
+{
+    t_events_clock c;
+    long seq;
+
+    do {
+        seq = events_load(&q->clock.seq);
+        c = q->clock;
+        events_fence_acquire();     // the copy above is read before seq is again
+    } while ((seq & 1) || seq != events_load(&q->clock.seq));
+
+    // one vector later than the stamp: the vector containing it may already run
+    double offset = (ms - c.ms) * 0.001 * c.samplerate;
+    return c.sample + c.vectorsize + (int64_t)(offset > 0.0 ? offset + 0.5 : 0.0);
+}
+
+
+// bounded multi-producer queue after Dmitry Vyukov: producers claim a
+// position by advancing head, then publish the slot through its seq
+int events_push(t_events *q, const t_event *ev)
+{
+    for (;;) {
+        long head = events_load(&q->head);
+        t_events_slot *slot = &q->ring[head & q->mask];
+        long seq = events_load(&slot->seq);
+
+        if (seq == head) {
+            if (events_cas(&q->head, head, head + 1)) {
+                slot->ev = *ev;
+                events_store(&slot->seq, head + 1);
+                return 0;
+            }
+        } else if (seq - head < 0) {
+            return -1;  // the consumer hasn't read the slot of a lap ago
+        }
+        // else another producer claimed head first: try the next position
+    }
+}
+
+
+// the event at tail if a producer has published it, else NULL
+static const t_event *events_front(t_events *q)
+{
+    const t_events_slot *slot = &q->ring[q->tail & q->mask];
+
+    return events_load(&slot->seq) == q->tail + 1 ? &slot->ev : NULL;
+}
+
+
+// moves everything published so far from the ring into stage, in time order:
+// producers on different threads publish in the order they win the ring, not
+// in the order they were stamped. Ties keep the ring's order.
+static void events_drain(t_events *q)
+{
+    const t_event *next;
+
+    if (q->read > 0) {
+        memmove(q->stage, q->stage + q->read, (q->staged - q->read) * sizeof(t_event));
+        q->staged -= q->read;
+        q->read = 0;
+    }
+    while (q->staged <= q->mask && (next = events_front(q)) != NULL) {
+        long i = q->staged;
+        long tail = q->tail;
+
+        // nearly always in order already: the scan stops at the first step
+        while (i > 0 && q->stage[i - 1].time > next->time) {
+            q->stage[i] = q->stage[i - 1];
+            i--;
+        }
+        q->stage[i] = *next;
+        q->staged++;
+        // free for the producer claiming this slot one lap later
+        events_store(&q->ring[tail & q->mask].seq, tail + q->mask + 1);
+        q->tail = tail + 1;
+    }
+}
+
+
+int events_due(t_events *q, int64_t before)
+{
+    return q->read < q->staged && q->stage[q->read].time < before;
+}
+
+
+int events_peek(t_events *q, int64_t *time)
+{
+    if (q->read == q->staged) {
+        return 0;
+    }
+    *time = q->stage[q->read].time;
+    return 1;
+}
+
+
+int events_next(t_events *q, int64_t before, t_event *ev)
+{
+    if (!events_due(q, before)) {
+        return 0;
+    }
+    *ev = q->stage[q->read++];
+    return 1;
+}
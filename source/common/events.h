@@ -0,0 +1,71 @@
+/**
+    @file
+    events: timestamped control events handed from Max's threads to perform
+
+    Messages are stamped with the scheduler time they arrive at and
+    converted to an absolute sample time using the clock that perform
+    publishes every vector. They are scheduled one vector later than the
+    stamp, so every event falls into a vector that hasn't started yet and
+    gets a fixed latency instead of up to a vector of jitter. Perform then
+    splits its vector at the events' sample offsets.
+
+    The queue is lock-free, with any number of producers (messages arrive
+    on the main thread and, with overdrive, on the scheduler thread) and a
+    single consumer (perform). Producers publish in the order they get
+    into the ring, which isn't the order they were stamped in, so
+    events_clock moves everything published into a staging buffer sorted
+    by time and the consumer calls below read from there. Events pushed
+    during a vector are seen from the next one on, which their stamp
+    already guarantees.
+*/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define EVENTS_MAX_ARGS 8
+
+typedef struct _event {
+    int64_t time;           // absolute sample time
+    const char *name;       // handler name, must outlive the event (e.g. a t_symbol's)
+    int argc;
+    double argv[EVENTS_MAX_ARGS];
+} t_event;
+
+typedef struct _events t_events;
+
+// capacity is rounded up to a power of two
+t_events *events_new(long capacity);
+void events_free(t_events *q);
+
+// perform: publish the sample time of the vector about to start and the
+// scheduler time in ms it corresponds to, and stage the published events
+void events_clock(t_events *q, int64_t sample, double ms, double samplerate, long vectorsize);
+
+// producer: sample time for an event stamped with scheduler time ms
+int64_t events_time(t_events *q, double ms);
+
+// producer, from any thread: returns 0, or -1 if the queue is full (the
+// event is dropped)
+int events_push(t_events *q, const t_event *ev);
+
+// consumer: pops the next event into ev if it is due before sample time
+// `before`, returns 1 if it did and 0 otherwise
+int events_next(t_events *q, int64_t before, t_event *ev);
+
+// consumer: 1 if an event is due before sample time `before`
+int events_due(t_events *q, int64_t before);
+
+// consumer: 1 and the time of the next event if there is one
+int events_peek(t_events *q, int64_t *time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENTS_H
@@ -0,0 +1,83 @@
+/**
+    @file
+    idle: opt-in sleep for effects whose input has gone silent
+*/
+
+#include "idle.h"
+#include "blockops.h"
+
+#include <math.h>
+
+
+void idle_init(t_idle *s)
+{
+    s->threshold = 0.0;
+    s->hold_ms = 0.0;
+    s->hold = 0;
+    s->silent = 0;
+    s->asleep = 0;
+}
+
+
+void idle_configure(t_idle *s, double hold_ms, double threshold_db, double samplerate)
+{
+    s->threshold = pow(10.0, threshold_db / 20.0);
+    s->hold_ms = hold_ms > 0.0 ? hold_ms : 0.0;
+    s->silent = 0;
+    s->asleep = 0;
+    idle_samplerate(s, samplerate);
+}
+
+
+void idle_samplerate(t_idle *s, double samplerate)
+{
+    s->hold = (long)(s->hold_ms * 0.001 * samplerate);
+    if (s->hold_ms > 0.0 && s->hold < 1) {
+        s->hold = 1;
+    }
+}
+
+
+// peak: of the vector's input(s)
+static int idle_peak(t_idle *s, double peak, long frames)
+{
+    if (peak > s->threshold) {
+        s->silent = 0;
+        s->asleep = 0;
+        return 0;
+    }
+    if (s->silent < s->hold) {
+        s->silent += frames;
+    }
+    return s->asleep;
+}
+
+
+int idle_before(t_idle *s, const double *in, long frames)
+{
+    if (s->hold == 0) {
+        return 0;
+    }
+    return idle_peak(s, blockops_peak(in, frames), frames);
+}
+
+
+int idle_before_sidechain(t_idle *s, const double *in, const double *sc, long frames)
+{
+    double peak, sc_peak;
+
+    if (s->hold == 0) {
+        return 0;
+    }
+    peak = blockops_peak(in, frames);
+    sc_peak = blockops_peak(sc, frames);
+    return idle_peak(s, peak > sc_peak ? peak : sc_peak, frames);
+}
+
+
+void idle_after(t_idle *s, const double *out, long frames)
+{
+    if (s->hold && s->silent >= s->hold && blockops_peak(out, frames) <= s->threshold) {
+        s->asleep = 1;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+    @file
+    idle: opt-in sleep for effects whose input has gone silent
+
+    Once the input has stayed below the threshold for the hold time and the
+    output tail has decayed below it too, the perform routine can output
+    zeros instead of running lua. The first vector with input above the
+    threshold wakes it up again.
+*/
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _idle {
+    double threshold;   // linear amplitude
+    double hold_ms;     // silent input time before sleeping (0: never sleep)
+    long hold;          // hold_ms in samples at the current sample rate
+    long silent;        // samples of silent input so far
+    long asleep;
+} t_idle;
+
+void idle_init(t_idle *s);
+
+// hold time in ms (0 turns sleeping off) and threshold in dBFS
+void idle_configure(t_idle *s, double hold_ms, double threshold_db, double samplerate);
+
+// to be called from dsp64
+void idle_samplerate(t_idle *s, double samplerate);
+
+// call before processing a vector: returns 1 if the vector can be skipped
+// (output zeros), 0 if it must be processed
+int idle_before(t_idle *s, const double *in, long frames);
+
+// idle_before for effects with a sidechain: sleeps only while both are silent
+int idle_before_sidechain(t_idle *s, const double *in, const double *sc, long frames);
+
+// call after processing a vector with its output
+void idle_after(t_idle *s, const double *out, long frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IDLE_H
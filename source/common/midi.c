@@ -0,0 +1,216 @@
+/**
+    @file
+    midi: raw midi bytes queued to perform and handed to lua once per vector
+*/
+
+#include "midi.h"
+
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define midi_load(p) (MemoryBarrier(), *(volatile long *)(p))
+#define midi_store(p, v) (MemoryBarrier(), *(volatile long *)(p) = (v), MemoryBarrier())
+#define midi_cas(p, expected, v) \
+    (InterlockedCompareExchange((volatile long *)(p), (v), (expected)) == (expected))
+#else
+#define midi_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define midi_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static int midi_cas(long *p, long expected, long v)
+{
+    return __atomic_compare_exchange_n(p, &expected, v, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+#endif
+
+
+// as in events.c: free for the producer claiming position pos while
+// seq == pos, holds the message of pos once seq == pos + 1
+typedef struct _midi_slot {
+    long seq;
+    int64_t time;
+    t_midi_event msg;
+} t_midi_slot;
+
+struct _midi {
+    t_midi_slot *ring;
+    long mask;
+    long head;      // next position to claim (producers)
+    long tail;      // next position to read (consumer)
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// parser
+
+// data bytes following a status byte
+static int midi_data_size(uint8_t status)
+{
+    switch (status & 0xF0) {
+        case 0xC0:  // program change
+        case 0xD0:  // channel pressure
+            return 1;
+        case 0xF0:
+            switch (status) {
+                case 0xF1:  // time code quarter frame
+                case 0xF3:  // song select
+                    return 1;
+                case 0xF2:  // song position
+                    return 2;
+                default:
+                    return 0;
+            }
+        default:
+            return 2;
+    }
+}
+
+
+static void midi_message(t_midi_event *msg, uint8_t status, const uint8_t *data, int count)
+{
+    msg->offset = 0;
+    msg->status = status;
+    msg->data1 = count > 0 ? data[0] : 0;
+    msg->data2 = count > 1 ? data[1] : 0;
+    msg->size = (uint8_t)(1 + count);
+}
+
+
+void midi_parser_init(t_midi_parser *p)
+{
+    p->status = 0;
+    p->count = 0;
+    p->sysex = 0;
+}
+
+
+int midi_parse(t_midi_parser *p, uint8_t byte, t_midi_event *msg)
+{
+    if (byte >= 0xF8) {         // realtime: may appear anywhere, no running status
+        midi_message(msg, byte, NULL, 0);
+        return 1;
+    }
+    if (byte & 0x80) {          // status
+        p->sysex = byte == 0xF0;
+        p->count = 0;
+        if (byte >= 0xF0) {
+            p->status = 0;      // system common cancels running status
+            if (!p->sysex && byte != 0xF7 && midi_data_size(byte) == 0) {
+                midi_message(msg, byte, NULL, 0);
+                return 1;
+            }
+            if (!p->sysex && byte != 0xF7) {
+                p->status = byte;
+            }
+            return 0;
+        }
+        p->status = byte;
+        return 0;
+    }
+    if (p->sysex || p->status == 0) {
+        return 0;               // sysex payload or data without status
+    }
+
+    p->data[p->count++] = byte;
+    if (p->count < midi_data_size(p->status)) {
+        return 0;
+    }
+    midi_message(msg, p->status, p->data, p->count);
+    p->count = 0;
+    if (p->status >= 0xF0) {
+        p->status = 0;
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// queue
+
+t_midi *midi_new(long capacity)
+{
+    t_midi *q = (t_midi *)calloc(1, sizeof(t_midi));
+    long size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (q) {
+        q->ring = (t_midi_slot *)calloc(size, sizeof(t_midi_slot));
+        if (q->ring == NULL) {
+            free(q);
+            return NULL;
+        }
+        for (long i = 0; i < size; i++) {
+            q->ring[i].seq = i;
+        }
+        q->mask = size - 1;
+    }
+    return q;
+}
+
+
+void midi_free(t_midi *q)
+{
+    if (q) {
+        free(q->ring);
+        free(q);
+    }
+}
+
+
+int midi_push(t_midi *q, int64_t time, const t_midi_event *msg)
+{
+    for (;;) {
+        long head = midi_load(&q->head);
+        t_midi_slot *slot = &q->ring[head & q->mask];
+        long seq = midi_load(&slot->seq);
+
+        if (seq == head) {
+            if (midi_cas(&q->head, head, head + 1)) {
+                slot->time = time;
+                slot->msg = *msg;
+                midi_store(&slot->seq, head + 1);
+                return 0;
+            }
+        } else if (seq - head < 0) {
+            return -1;  // full
+        }
+    }
+}
+
+
+// the slot at tail if a producer has published it, else NULL
+static const t_midi_slot *midi_front(t_midi *q)
+{
+    const t_midi_slot *slot = &q->ring[q->tail & q->mask];
+
+    return midi_load(&slot->seq) == q->tail + 1 ? slot : NULL;
+}
+
+
+long midi_collect(t_midi *q, int64_t start, long frames, t_midi_event *batch)
+{
+    const t_midi_slot *slot;
+    long count = 0;
+
+    while (count < MIDI_BATCH_MAX && (slot = midi_front(q)) != NULL) {
+        if (slot->time >= start + frames) {
+            break;
+        }
+        batch[count] = slot->msg;
+        batch[count].offset = slot->time > start ? (int32_t)(slot->time - start) : 0;
+        count++;
+        midi_store(&q->ring[q->tail & q->mask].seq, q->tail + q->mask + 1);
+        q->tail++;
+    }
+    return count;
+}
+
+
+int midi_due(t_midi *q, int64_t before)
+{
+    const t_midi_slot *slot = midi_front(q);
+
+    return slot && slot->time < before;
+}
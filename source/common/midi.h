@@ -0,0 +1,68 @@
+/**
+    @file
+    midi: raw midi bytes queued to perform and handed to lua once per vector
+
+    Bytes (one at a time from midiin, or whole messages as lists) go
+    through a running-status parser on the thread delivering them; each
+    thread needs its own parser, as midiin delivers on the scheduler thread
+    and messages typed into a patch arrive on the main thread. Complete
+    messages are stamped with their sample time and queued in a lock-free
+    multi-producer / single consumer ring. Perform collects the messages
+    due in a vector into an array of t_midi_event, which lua reads through
+    the ffi (see examples/dsp_midi.lua).
+*/
+
+#ifndef MIDI_H
+#define MIDI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define MIDI_BATCH_MAX 256
+
+// one message as seen by lua, keep in sync with dsp_midi.lua
+typedef struct _midi_event {
+    int32_t offset;     // sample offset in the vector
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+    uint8_t size;       // bytes in the message (1-3)
+} t_midi_event;
+
+typedef struct _midi_parser {
+    uint8_t status;     // running status (0: none)
+    uint8_t data[2];
+    uint8_t count;      // data bytes collected
+    uint8_t sysex;      // inside a sysex message (ignored)
+} t_midi_parser;
+
+typedef struct _midi t_midi;
+
+void midi_parser_init(t_midi_parser *p);
+
+// feed one byte, returns 1 and fills msg (offset 0) when a message is complete
+int midi_parse(t_midi_parser *p, uint8_t byte, t_midi_event *msg);
+
+// capacity is rounded up to a power of two
+t_midi *midi_new(long capacity);
+void midi_free(t_midi *q);
+
+// producer, from any thread: returns 0, or -1 if the queue is full (the
+// message is dropped)
+int midi_push(t_midi *q, int64_t time, const t_midi_event *msg);
+
+// consumer: move the messages due before `start + frames` into batch (at most
+// MIDI_BATCH_MAX) with offsets relative to start, returns how many
+long midi_collect(t_midi *q, int64_t start, long frames, t_midi_event *batch);
+
+// consumer: 1 if a message is due before sample time `before`
+int midi_due(t_midi *q, int64_t before);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MIDI_H
@@ -0,0 +1,274 @@
+/**
+    @file
+    oversample: 2x, 4x and 8x resampling around nonlinear dsp functions
+*/
+
+#include "oversample.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVERSAMPLE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define OVERSAMPLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define OVERSAMPLE_STAGES 3
+
+// odd phase taps per side of each stage, steepest first
+static const long oversample_half[OVERSAMPLE_STAGES] = { 16, 8, 4 };
+
+typedef struct _oversample_filter {
+    long half;          // K: the odd phase has 2K taps
+    long taps;
+    double *coef;       // odd phase of the half-band, gain 2 (symmetric)
+} t_oversample_filter;
+
+// state of one stage for one channel; stage s runs from 2^s to 2^(s+1)
+typedef struct _oversample_state {
+    double *up;         // taps - 1 history + input
+    double *even;       // half - 1 history + even input samples of the downsampler
+    double *odd;        // taps - 1 history + odd input samples
+    double *high;       // output of the upsampler, 2 * frames
+} t_oversample_state;
+
+struct _oversample {
+    long factor;
+    long stages;
+    long maxframes;
+    long channels;
+    t_oversample_filter filter[OVERSAMPLE_STAGES];
+    t_oversample_state *state;  // channels * stages
+};
+
+
+//-----------------------------------------------------------------------------------------------
+
+static double oversample_dot(const double *a, const double *b, long n)
+{
+    double sum = 0.0;
+    long i = 0;
+
+#if defined(OVERSAMPLE_SSE2)
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    sum = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+#elif defined(OVERSAMPLE_NEON)
+    float64x2_t s0 = vdupq_n_f64(0.0);
+    float64x2_t s1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        s0 = vfmaq_f64(s0, vld1q_f64(a + i), vld1q_f64(b + i));
+        s1 = vfmaq_f64(s1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+    }
+    sum = vaddvq_f64(vaddq_f64(s0, s1));
+#endif
+
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static double oversample_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// kaiser windowed half-band, 80 dB stopband; the odd phase sums to 1 so
+// that the upsampler has unity gain at dc
+static int oversample_design(t_oversample_filter *f, long half)
+{
+    const double beta = 7.86;
+    double sum = 0.0;
+
+    f->half = half;
+    f->taps = 2 * half;
+    f->coef = (double *)malloc(f->taps * sizeof(double));
+    if (f->coef == NULL) {
+        return -1;
+    }
+    for (long i = 0; i < f->taps; i++) {
+        double n = 2.0 * i - f->taps + 1;    // odd, -(2K - 1) .. 2K - 1
+        double r = n / f->taps;
+        double w = oversample_bessel_i0(beta * sqrt(1.0 - r * r)) / oversample_bessel_i0(beta);
+        f->coef[i] = sin(M_PI * n / 2.0) / (M_PI * n / 2.0) * w;
+        sum += f->coef[i];
+    }
+    for (long i = 0; i < f->taps; i++) {
+        f->coef[i] /= sum;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+// frames -> 2 * frames into s->high
+static void oversample_stage_up(const t_oversample_filter *f, t_oversample_state *s, const double *in, long frames)
+{
+    long keep = f->taps - 1;
+    double *x = s->up;
+
+    memcpy(x + keep, in, frames * sizeof(double));
+    for (long m = 0; m < frames; m++) {
+        s->high[2 * m] = x[m + f->half - 1];
+        s->high[2 * m + 1] = oversample_dot(f->coef, x + m, f->taps);
+    }
+    memmove(x, x + frames, keep * sizeof(double));
+}
+
+// 2 * frames -> frames
+static void oversample_stage_down(const t_oversample_filter *f, t_oversample_state *s, const double *in, double *out, long frames)
+{
+    long keep_even = f->half - 1;
+    long keep_odd = f->taps - 1;
+    double *e = s->even;
+    double *o = s->odd;
+
+    for (long m = 0; m < frames; m++) {
+        e[keep_even + m] = in[2 * m];
+        o[keep_odd + m] = in[2 * m + 1];
+    }
+    for (long m = 0; m < frames; m++) {
+        out[m] = 0.5 * (e[m] + oversample_dot(f->coef, o + m, f->taps));
+    }
+    memmove(e, e + frames, keep_even * sizeof(double));
+    memmove(o, o + frames, keep_odd * sizeof(double));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+t_oversample *oversample_new(long factor, long maxframes, long channels)
+{
+    t_oversample *o;
+    long stages = factor == 8 ? 3 : factor == 4 ? 2 : factor == 2 ? 1 : 0;
+
+    if (stages == 0 || maxframes < 1 || channels < 1) {
+        return NULL;
+    }
+    o = (t_oversample *)calloc(1, sizeof(t_oversample));
+    if (o == NULL) {
+        return NULL;
+    }
+    o->factor = factor;
+    o->stages = stages;
+    o->maxframes = maxframes;
+    o->channels = channels;
+    o->state = (t_oversample_state *)calloc(channels * stages, sizeof(t_oversample_state));
+    if (o->state == NULL) {
+        oversample_free(o);
+        return NULL;
+    }
+    for (long st = 0; st < stages; st++) {
+        t_oversample_filter *f = &o->filter[st];
+        long frames = maxframes << st;      // input of the upsampler of this stage
+
+        if (oversample_design(f, oversample_half[st]) != 0) {
+            oversample_free(o);
+            return NULL;
+        }
+        for (long ch = 0; ch < channels; ch++) {
+            t_oversample_state *s = &o->state[ch * stages + st];
+            s->up = (double *)calloc(f->taps - 1 + frames, sizeof(double));
+            s->even = (double *)calloc(f->half - 1 + frames, sizeof(double));
+            s->odd = (double *)calloc(f->taps - 1 + frames, sizeof(double));
+            s->high = (double *)calloc(2 * frames, sizeof(double));
+            if (!s->up || !s->even || !s->odd || !s->high) {
+                oversample_free(o);
+                return NULL;
+            }
+        }
+    }
+    return o;
+}
+
+
+void oversample_free(t_oversample *o)
+{
+    if (o == NULL) {
+        return;
+    }
+    if (o->state) {
+        for (long i = 0; i < o->channels * o->stages; i++) {
+            free(o->state[i].up);
+            free(o->state[i].even);
+            free(o->state[i].odd);
+            free(o->state[i].high);
+        }
+        free(o->state);
+    }
+    for (long st = 0; st < OVERSAMPLE_STAGES; st++) {
+        free(o->filter[st].coef);
+    }
+    free(o);
+}
+
+
+long oversample_factor(const t_oversample *o)
+{
+    return o->factor;
+}
+
+
+double *oversample_up(t_oversample *o, long channel, const double *in, long frames)
+{
+    t_oversample_state *s = &o->state[channel * o->stages];
+
+    if (frames > o->maxframes) {
+        frames = o->maxframes;
+    }
+    for (long st = 0; st < o->stages; st++) {
+        oversample_stage_up(&o->filter[st], &s[st], in, frames << st);
+        in = s[st].high;
+    }
+    return s[o->stages - 1].high;
+}
+
+
+void oversample_down(t_oversample *o, long channel, const double *high, double *out, long frames)
+{
+    t_oversample_state *s = &o->state[channel * o->stages];
+
+    if (frames > o->maxframes) {
+        frames = o->maxframes;
+    }
+    // the upsampler's buffers below the top rate are free again: each stage
+    // writes into the one of the stage before it
+    for (long st = o->stages - 1; st > 0; st--) {
+        oversample_stage_down(&o->filter[st], &s[st], high, s[st - 1].high, frames << st);
+        high = s[st - 1].high;
+    }
+    oversample_stage_down(&o->filter[0], &s[0], high, out, frames);
+}
+
+
+double oversample_latency(const t_oversample *o)
+{
+    double latency = 0.0;
+
+    // upsampler K, downsampler K - 1 samples at the input rate of the stage
+    for (long st = 0; st < o->stages; st++) {
+        latency += (2.0 * o->filter[st].half - 1.0) / (double)(1L << st);
+    }
+    return latency;
+}
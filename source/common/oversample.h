@@ -0,0 +1,46 @@
+/**
+    @file
+    oversample: 2x, 4x and 8x resampling around nonlinear dsp functions
+
+    A cascade of polyphase half-band FIR stages, one per doubling: the
+    upsampler computes only the odd phase (the even phase of a half-band is
+    a delay), and so does the downsampler on the odd input samples. The
+    first stage is the steepest (flat to 0.8 of the base nyquist, images
+    and aliases of that band below -70 dB); the later ones only have to
+    reject what is above the base band and are shorter. The dot products
+    use SSE2 or NEON where the compiler targets them.
+*/
+
+#ifndef OVERSAMPLE_H
+#define OVERSAMPLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OVERSAMPLE_MAX 8
+
+typedef struct _oversample t_oversample;
+
+// factor 2, 4 or 8, for vectors of up to maxframes base rate frames and
+// `channels` independent signals. Not for the audio thread.
+t_oversample *oversample_new(long factor, long maxframes, long channels);
+void oversample_free(t_oversample *o);
+
+long oversample_factor(const t_oversample *o);
+
+// upsample frames samples of `channel`, returns frames * factor samples the
+// caller may change in place and pass to oversample_down
+double *oversample_up(t_oversample *o, long channel, const double *in, long frames);
+
+// filter frames * factor samples of `channel` back down to `out`
+void oversample_down(t_oversample *o, long channel, const double *high, double *out, long frames);
+
+// delay of an up and down round trip, in base rate samples
+double oversample_latency(const t_oversample *o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OVERSAMPLE_H
@@ -0,0 +1,233 @@
+/**
+    @file
+    params: named parameters declared by a script and read by lua through the ffi
+*/
+
+#include "params.h"
+
+#include <lauxlib.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static double params_field(lua_State *L, int index, const char *key, double fallback)
+{
+    double result = fallback;
+
+    lua_getfield(L, index, key);
+    if (lua_isnumber(L, -1)) {
+        result = lua_tonumber(L, -1);
+    }
+    lua_pop(L, 1);
+    return result;
+}
+
+
+static double params_clamp(const t_params_set *p, long i, double value)
+{
+    if (value < p->min[i]) {
+        return p->min[i];
+    }
+    if (value > p->max[i]) {
+        return p->max[i];
+    }
+    return value;
+}
+
+
+static long params_find(const t_params_set *p, const char *name)
+{
+    if (p == NULL) {
+        return -1;
+    }
+    for (long i = 0; i < p->count; i++) {
+        if (strcmp(p->name[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+static void params_update_coeff(const t_params *p, t_params_set *set, long i)
+{
+    double samples = set->smooth_ms[i] * 0.001 * p->samplerate;
+
+    set->coeff[i] = samples > 0.0 ? 1.0 - exp(-(double)p->vectorsize / samples) : 1.0;
+}
+
+
+static void params_release(void *ctx, void *ptr)
+{
+    free(ptr);
+}
+
+
+// perform reads p->set once per vector in params_tick, lua reads the values
+// through P until the vector ends
+static void params_publish(t_params *p, t_params_set *set)
+{
+    t_params_set *old = p->set;
+
+    p->set = set;
+    if (old) {
+        retire_push(&p->retire, params_release, NULL, old);
+    }
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+void params_init(t_params *p)
+{
+    p->set = NULL;
+    retire_init(&p->retire);
+    p->samplerate = 44100.0;
+    p->vectorsize = 64;
+}
+
+
+void params_free(t_params *p)
+{
+    retire_flush(&p->retire);
+    free(p->set);
+    p->set = NULL;
+}
+
+
+int params_declare(t_params *p, lua_State *L)
+{
+    const t_params_set *prev_set = p->set;
+    t_params_set *next;     // only replaces p->set once the declaration is valid
+    long count = 0;
+
+    lua_getglobal(L, "PARAMS");
+    if (!lua_istable(L, -1)) {
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        lua_setglobal(L, "P");
+        params_publish(p, NULL);
+        return 0;
+    }
+    next = (t_params_set *)calloc(1, sizeof(t_params_set));
+    if (next == NULL) {
+        lua_pop(L, 1);
+        lua_pushliteral(L, "PARAMS: out of memory");
+        return -1;
+    }
+
+    for (int i = 1; ; i++) {
+        const char *name = NULL;
+
+        lua_rawgeti(L, -1, i);
+        if (lua_isnil(L, -1)) {
+            lua_pop(L, 1);
+            break;
+        }
+        if (lua_istable(L, -1)) {
+            lua_getfield(L, -1, "name");
+            name = lua_tostring(L, -1);
+        } else {
+            lua_pushnil(L);     // as if the name was missing
+        }
+        if (name == NULL || strlen(name) >= PARAMS_NAME_CHARS) {
+            lua_pop(L, 3);
+            lua_pushfstring(L, "PARAMS[%d]: needs a name of less than %d characters", i, PARAMS_NAME_CHARS);
+            free(next);
+            return -1;
+        }
+        if (count == PARAMS_MAX) {
+            lua_pop(L, 3);
+            lua_pushfstring(L, "PARAMS: more than %d parameters", PARAMS_MAX);
+            free(next);
+            return -1;
+        }
+        strcpy(next->name[count], name);
+        lua_pop(L, 1);
+
+        double def = params_field(L, -1, "default", 0.0);
+        next->min[count] = params_field(L, -1, "min", -HUGE_VAL);
+        next->max[count] = params_field(L, -1, "max", HUGE_VAL);
+        next->smooth_ms[count] = params_field(L, -1, "smooth", 0.0);
+
+        long prev = params_find(prev_set, next->name[count]);
+        next->target[count] = params_clamp(next, count, prev >= 0 ? prev_set->target[prev] : def);
+        next->value[count] = prev >= 0 ? params_clamp(next, count, prev_set->value[prev]) : next->target[count];
+        lua_pop(L, 1);
+        count++;
+    }
+    lua_pop(L, 1);
+
+    next->count = count;
+    for (long i = 0; i < count; i++) {
+        params_update_coeff(p, next, i);
+    }
+
+    // P = require('dsp_params').bind(PARAMS, values), which also checks the names
+    lua_getglobal(L, "require");
+    lua_pushliteral(L, "dsp_params");
+    if (lua_pcall(L, 1, 1, 0) != 0) {
+        free(next);
+        return -1;
+    }
+    lua_getfield(L, -1, "bind");
+    lua_remove(L, -2);
+    lua_getglobal(L, "PARAMS");
+    lua_pushlightuserdata(L, next->value);
+    if (lua_pcall(L, 2, 1, 0) != 0) {
+        free(next);
+        return -1;
+    }
+    lua_setglobal(L, "P");
+    params_publish(p, next);
+    return 0;
+}
+
+
+int params_set(t_params *p, const char *name, double value)
+{
+    t_params_set *set = p->set;
+    long i = params_find(set, name);
+
+    if (i < 0) {
+        return -1;
+    }
+    set->target[i] = params_clamp(set, i, value);
+    return 0;
+}
+
+
+void params_prepare(t_params *p, double samplerate, long vectorsize)
+{
+    t_params_set *set = p->set;
+
+    p->samplerate = samplerate;
+    p->vectorsize = vectorsize > 0 ? vectorsize : 1;
+    for (long i = 0; set && i < set->count; i++) {
+        params_update_coeff(p, set, i);
+    }
+}
+
+
+void params_tick(t_params *p)
+{
+    t_params_set *set;
+
+    // counting the vector before loading the set: a set replaced after this
+    // load is only freed once the next vector starts
+    retire_vector(&p->retire);
+    set = p->set;
+    if (set == NULL) {
+        return;
+    }
+    for (long i = 0; i < set->count; i++) {
+        double d = set->target[i] - set->value[i];
+        if (d != 0.0) {
+            set->value[i] = fabs(d) > 1e-9 * (fabs(set->target[i]) + 1e-9)
+                          ? set->value[i] + set->coeff[i] * d
+                          : set->target[i];
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+    @file
+    params: named parameters declared by a script and read by lua through the ffi
+
+    A script declares its parameters in a global PARAMS table:
+
+        PARAMS = {
+            { name = "cutoff", default = 1000, min = 20, max = 20000, smooth = 20 },
+            { name = "q", default = 0.7, min = 0.1, max = 10 },
+        }
+
+    The object stores the values in a native array and binds the global P
+    to it as an ffi struct pointer (P.cutoff, P.q), so dsp functions read
+    them without anything being pushed per call. `set <name> <value>`
+    changes a target value, which the current value follows with a
+    one-pole smoother of `smooth` ms (updated once per vector).
+
+    A declaration builds a new set of values and publishes it with a single
+    pointer store, perform picks it up at the start of the next vector. The
+    replaced set is freed once no vector can still be reading it.
+*/
+
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lua.h>
+
+#include "retire.h"
+
+#define PARAMS_MAX 64
+#define PARAMS_NAME_CHARS 32
+
+typedef struct _params_set {
+    double value[PARAMS_MAX];       // current values: bound to P in lua, keep first
+    double target[PARAMS_MAX];
+    double min[PARAMS_MAX];
+    double max[PARAMS_MAX];
+    double smooth_ms[PARAMS_MAX];   // 0: jump to the target
+    double coeff[PARAMS_MAX];       // per vector smoothing coefficient
+    char name[PARAMS_MAX][PARAMS_NAME_CHARS];
+    long count;
+} t_params_set;
+
+typedef struct _params {
+    t_params_set *set;      // declared parameters (or NULL), swapped by params_declare
+    t_retire retire;        // replaced sets perform may still read
+    double samplerate;
+    long vectorsize;
+} t_params;
+
+void params_init(t_params *p);
+
+// after dsp_free
+void params_free(t_params *p);
+
+// read the PARAMS declaration of the script in L and bind P to the values.
+// Parameters which keep their name keep their value. Returns 0, or -1 and
+// pushes an error message.
+int params_declare(t_params *p, lua_State *L);
+
+// set the target of a parameter (clamped to its range), returns -1 if unknown
+int params_set(t_params *p, const char *name, double value);
+
+// to be called from dsp64
+void params_prepare(t_params *p, double samplerate, long vectorsize);
+
+// advance the smoothers by one vector, call before processing it
+void params_tick(t_params *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PARAMS_H
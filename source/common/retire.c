@@ -0,0 +1,93 @@
+/**
+    @file
+    retire: releases what perform may still be using once it no longer can
+*/
+
+#include "retire.h"
+
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define retire_load(p) (MemoryBarrier(), *(volatile long *)(p))
+#define retire_increment(p) InterlockedIncrement((volatile long *)(p))
+#define retire_fence() MemoryBarrier()
+#else
+#define retire_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define retire_increment(p) __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define retire_fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+
+struct _retire_entry {
+    t_retire_fn fn;
+    void *ctx;
+    void *ptr;
+    long vectors;       // perform's count at the push
+    t_retire_entry *next;
+};
+
+
+void retire_init(t_retire *r)
+{
+    r->vectors = 0;
+    r->pending = NULL;
+}
+
+
+int retire_push(t_retire *r, t_retire_fn fn, void *ctx, void *ptr)
+{
+    t_retire_entry *e = (t_retire_entry *)malloc(sizeof(t_retire_entry));
+
+    // orders the caller's store before reading the count; with the fence in
+    // retire_vector, a vector which loaded the old value is counted later
+    retire_fence();
+    if (e) {
+        e->fn = fn;
+        e->ctx = ctx;
+        e->ptr = ptr;
+        e->vectors = retire_load(&r->vectors);
+        e->next = r->pending;
+        r->pending = e;
+    }
+    retire_collect(r);
+    return e ? 0 : -1;
+}
+
+
+void retire_collect(t_retire *r)
+{
+    long vectors = retire_load(&r->vectors);
+    t_retire_entry **link = &r->pending;
+
+    while (*link) {
+        t_retire_entry *e = *link;
+        if (vectors - e->vectors > 0) {
+            *link = e->next;
+            e->fn(e->ctx, e->ptr);
+            free(e);
+        } else {
+            link = &e->next;
+        }
+    }
+}
+
+
+void retire_flush(t_retire *r)
+{
+    while (r->pending) {
+        t_retire_entry *e = r->pending;
+        r->pending = e->next;
+        e->fn(e->ctx, e->ptr);
+        free(e);
+    }
+}
+
+
+void retire_vector(t_retire *r)
+{
+    // everything this vector loaded is done with before the count moves on,
+    // and the next vector's loads can't move ahead of it
+    retire_increment(&r->vectors);
+    retire_fence();
+}
@@ -0,0 +1,56 @@
+/**
+    @file
+    retire: releases what perform may still be using once it no longer can
+
+    The main thread replaces something perform reads once per vector (a
+    resampler, the registry ref of a block function) with a single store,
+    then hands the old one to retire_push. Perform counts the vectors it has
+    finished; a retired entry is released on the main thread once a vector
+    has finished after the push, because only the vector running at the
+    push can still hold the old value. Any number of replacements may be
+    pending, so several swaps within one vector are safe.
+
+    While the dsp is off nothing counts vectors and entries wait until it
+    runs again, or until retire_flush when the object is freed.
+*/
+
+#ifndef RETIRE_H
+#define RETIRE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// releases ptr, ctx is what was passed to retire_push
+typedef void (*t_retire_fn)(void *ctx, void *ptr);
+
+typedef struct _retire_entry t_retire_entry;
+
+typedef struct _retire {
+    long vectors;               // vectors finished by perform
+    t_retire_entry *pending;    // main thread only
+} t_retire;
+
+void retire_init(t_retire *r);
+
+// main thread, right after the store replacing ptr: fn(ctx, ptr) once
+// perform can't be using it anymore. Also releases older entries which are
+// done. Returns 0, or -1 if out of memory: ptr then leaks rather than
+// being released under a running vector
+int retire_push(t_retire *r, t_retire_fn fn, void *ctx, void *ptr);
+
+// main thread: release the entries perform is done with
+void retire_collect(t_retire *r);
+
+// main thread, after dsp_free: release all entries
+void retire_flush(t_retire *r);
+
+// perform: once per vector, at its end, or at the start of the next one
+// before anything is loaded
+void retire_vector(t_retire *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RETIRE_H
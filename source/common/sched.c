@@ -0,0 +1,333 @@
+/**
+    @file
+    sched: sample-accurate coroutine scheduler driven by perform
+*/
+
+#include "sched.h"
+
+#include <lauxlib.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define sched_load(p) (MemoryBarrier(), *(volatile long *)(p))
+#define sched_increment(p) InterlockedIncrement((volatile long *)(p))
+#define sched_load_ptr(p) (MemoryBarrier(), *(void *volatile *)(p))
+#define sched_exchange_ptr(p, v) InterlockedExchangePointer((void *volatile *)(p), (v))
+#define sched_cas_ptr(p, expected, v) \
+    (InterlockedCompareExchangePointer((void *volatile *)(p), (v), (expected)) == (expected))
+#else
+#define sched_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define sched_increment(p) __atomic_add_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define sched_load_ptr(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define sched_exchange_ptr(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+
+static int sched_cas_ptr(void **p, void *expected, void *v)
+{
+    return __atomic_compare_exchange_n(p, &expected, v, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+#endif
+
+#define SCHED_INITIAL 64
+
+
+typedef struct _sched_entry {
+    int64_t time;       // wake-up sample time
+    uint64_t order;     // spawn/wait order: equal times resume first come first served
+    int ref;            // registry ref of the coroutine
+    long clears;        // sched_clear calls before it was spawned
+} t_sched_entry;
+
+// spawned coroutine on its way to the heap
+typedef struct _sched_spawn {
+    int ref;
+    long clears;
+    struct _sched_spawn *next;
+} t_sched_spawn;
+
+// The heap belongs to perform. Coroutines spawned on any thread go onto a
+// lock-free stack which sched_run moves into the heap, and sched_clear only
+// counts a request which sched_run carries out.
+struct _sched {
+    t_sched_entry *heap;
+    long count;
+    long size;
+    uint64_t order;
+    int64_t now;        // sample time of the running (or last) resume
+    void *spawned;      // t_sched_spawn stack, newest first
+    long clears;        // sched_clear calls
+    long cleared;       // clears carried out by sched_run
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// heap
+
+static int sched_before(const t_sched_entry *a, const t_sched_entry *b)
+{
+    return a->time < b->time || (a->time == b->time && a->order < b->order);
+}
+
+
+// heap has room for e
+static void sched_insert(t_sched *s, t_sched_entry e)
+{
+    long i = s->count++;
+
+    while (i > 0) {
+        long parent = (i - 1) / 2;
+        if (!sched_before(&e, &s->heap[parent])) {
+            break;
+        }
+        s->heap[i] = s->heap[parent];
+        i = parent;
+    }
+    s->heap[i] = e;
+}
+
+
+static int sched_push(t_sched *s, int64_t time, int ref, long clears)
+{
+    if (s->count == s->size) {
+        long size = s->size ? s->size * 2 : SCHED_INITIAL;
+        t_sched_entry *heap = (t_sched_entry *)realloc(s->heap, size * sizeof(t_sched_entry));
+        if (heap == NULL) {
+            return -1;
+        }
+        s->heap = heap;
+        s->size = size;
+    }
+
+    t_sched_entry e = { time, s->order++, ref, clears };
+    sched_insert(s, e);
+    return 0;
+}
+
+
+static t_sched_entry sched_pop(t_sched *s)
+{
+    t_sched_entry top = s->heap[0];
+    t_sched_entry last = s->heap[--s->count];
+    long i = 0;
+
+    for (;;) {
+        long child = 2 * i + 1;
+        if (child >= s->count) {
+            break;
+        }
+        if (child + 1 < s->count && sched_before(&s->heap[child + 1], &s->heap[child])) {
+            child++;
+        }
+        if (!sched_before(&s->heap[child], &last)) {
+            break;
+        }
+        s->heap[i] = s->heap[child];
+        i = child;
+    }
+    if (s->count > 0) {
+        s->heap[i] = last;
+    }
+    return top;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// lua api
+
+// spawn(fn, ...): run fn(...) as a coroutine starting at the current sample
+// (at the next vector when called outside of perform)
+static int sched_lua_spawn(lua_State *L)
+{
+    t_sched *s = (t_sched *)lua_touserdata(L, lua_upvalueindex(1));
+    t_sched_spawn *spawn;
+    int n = lua_gettop(L);
+
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    spawn = (t_sched_spawn *)malloc(sizeof(t_sched_spawn));
+    if (spawn == NULL) {
+        return luaL_error(L, "spawn: out of memory");
+    }
+    lua_State *co = lua_newthread(L);
+    lua_insert(L, 1);
+    lua_xmove(L, co, n);    // function and arguments wait on the coroutine's stack
+    spawn->ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    spawn->clears = sched_load(&s->clears);
+
+    do {
+        spawn->next = (t_sched_spawn *)sched_load_ptr(&s->spawned);
+    } while (!sched_cas_ptr(&s->spawned, spawn->next, spawn));
+    return 0;
+}
+
+
+// wait(samples): suspend the calling coroutine
+static int sched_lua_wait(lua_State *L)
+{
+    lua_Number samples = luaL_checknumber(L, 1);
+
+    if (!isfinite(samples)) {
+        return luaL_argerror(L, 1, "expected a finite number of samples");
+    }
+    lua_settop(L, 1);
+    return lua_yield(L, 1);
+}
+
+
+// now(): sample time of the running coroutine (or of the last vector)
+static int sched_lua_now(lua_State *L)
+{
+    t_sched *s = (t_sched *)lua_touserdata(L, lua_upvalueindex(1));
+
+    lua_pushnumber(L, (lua_Number)s->now);
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+t_sched *sched_new(void)
+{
+    return (t_sched *)calloc(1, sizeof(t_sched));
+}
+
+
+void sched_free(t_sched *s)
+{
+    if (s) {
+        t_sched_spawn *spawn = (t_sched_spawn *)s->spawned;
+        while (spawn) {
+            t_sched_spawn *next = spawn->next;
+            free(spawn);
+            spawn = next;
+        }
+        free(s->heap);
+        free(s);
+    }
+}
+
+
+void sched_install(t_sched *s, lua_State *L)
+{
+    lua_pushlightuserdata(L, s);
+    lua_pushcclosure(L, sched_lua_spawn, 1);
+    lua_setglobal(L, "spawn");
+
+    lua_pushcfunction(L, sched_lua_wait);
+    lua_setglobal(L, "wait");
+
+    lua_pushlightuserdata(L, s);
+    lua_pushcclosure(L, sched_lua_now, 1);
+    lua_setglobal(L, "now");
+}
+
+
+void sched_clear(t_sched *s)
+{
+    sched_increment(&s->clears);
+}
+
+
+int64_t sched_next(const t_sched *s)
+{
+    if (sched_load_ptr(&s->spawned)) {
+        return s->now;  // spawned since the last sched_run: due at once
+    }
+    return s->count ? s->heap[0].time : INT64_MAX;
+}
+
+
+// perform: carry out sched_clear and move spawned coroutines into the heap
+static void sched_adopt(t_sched *s, lua_State *L)
+{
+    long clears = sched_load(&s->clears);
+    t_sched_spawn *spawn, *fifo = NULL;
+
+    if (clears != s->cleared) {     // drop what was spawned before the clear
+        long kept = 0;
+        for (long i = 0; i < s->count; i++) {
+            if (s->heap[i].clears - clears < 0) {
+                luaL_unref(L, LUA_REGISTRYINDEX, s->heap[i].ref);
+            } else {
+                s->heap[kept++] = s->heap[i];
+            }
+        }
+        s->count = 0;
+        for (long i = 0; i < kept; i++) {
+            sched_insert(s, s->heap[i]);    // only writes entries up to i
+        }
+        s->cleared = clears;
+    }
+
+    if (sched_load_ptr(&s->spawned) == NULL) {
+        return;
+    }
+    spawn = (t_sched_spawn *)sched_exchange_ptr(&s->spawned, NULL);
+    while (spawn) {     // oldest first
+        t_sched_spawn *next = spawn->next;
+        spawn->next = fifo;
+        fifo = spawn;
+        spawn = next;
+    }
+    while (fifo) {
+        t_sched_spawn *next = fifo->next;
+        if (fifo->clears - clears < 0 || sched_push(s, s->now, fifo->ref, fifo->clears) != 0) {
+            luaL_unref(L, LUA_REGISTRYINDEX, fifo->ref);
+        }
+        free(fifo);
+        fifo = next;
+    }
+}
+
+
+// now + samples, at least one sample so a sequence can't stall the vector,
+// saturating at INT64_MAX (never)
+static int64_t sched_wake(int64_t now, double samples)
+{
+    double room = (double)(INT64_MAX - now);    // may round up
+
+    if (!(samples >= 1.0)) {
+        return now + 1;
+    }
+    if (samples >= room) {
+        return INT64_MAX;
+    }
+    int64_t n = (int64_t)samples;   // below room, so below 2^63
+    return n > INT64_MAX - now ? INT64_MAX : now + n;
+}
+
+
+void sched_run(t_sched *s, lua_State *L, int64_t now, t_sched_report report, void *ctx)
+{
+    s->now = now;
+
+    for (;;) {
+        sched_adopt(s, L);     // also what the last resume spawned, due now
+        if (s->count == 0 || s->heap[0].time > now) {
+            break;
+        }
+        t_sched_entry e = sched_pop(s);
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, e.ref);
+        lua_State *co = lua_tothread(L, -1);
+        lua_pop(L, 1);  // still referenced from the registry
+
+        // the first resume finds the function and its arguments on the stack
+        int nargs = lua_status(co) == LUA_YIELD ? 0 : lua_gettop(co) - 1;
+        int status = lua_resume(co, nargs);
+
+        if (status == LUA_YIELD) {
+            int64_t wake = sched_wake(now, lua_tonumber(co, -1));
+            lua_settop(co, 0);
+            if (sched_push(s, wake, e.ref, e.clears) != 0) {
+                luaL_unref(L, LUA_REGISTRYINDEX, e.ref);
+            }
+        } else {
+            if (status != 0 && report) {
+                report(ctx, lua_tostring(co, -1));
+            }
+            luaL_unref(L, LUA_REGISTRYINDEX, e.ref);
+        }
+    }
+}
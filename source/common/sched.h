@@ -0,0 +1,50 @@
+/**
+    @file
+    sched: sample-accurate coroutine scheduler driven by perform
+
+    Scripts start sequences with spawn(fn, ...). Inside them wait(samples)
+    suspends the coroutine, and now() is the sample time it was resumed
+    at. Suspended coroutines sit in a binary heap keyed by their wake-up
+    time, so waiting costs nothing per sample. Perform splits its vector
+    at the wake-up times and resumes each coroutine at its exact sample.
+
+    Only perform touches the heap. spawn() from the main thread (a script
+    being run) and sched_clear hand their work to the next sched_run.
+*/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lua.h>
+#include <stdint.h>
+
+typedef struct _sched t_sched;
+
+// receives error messages of failing coroutines
+typedef void (*t_sched_report)(void *ctx, const char *msg);
+
+t_sched *sched_new(void);
+void sched_free(t_sched *s);
+
+// register spawn, wait and now as globals of L
+void sched_install(t_sched *s, lua_State *L);
+
+// any thread: drop every coroutine spawned so far (e.g. before a script is
+// rerun), carried out by the next sched_run
+void sched_clear(t_sched *s);
+
+// perform: wake-up time of the earliest coroutine, INT64_MAX if there is none
+int64_t sched_next(const t_sched *s);
+
+// resume every coroutine due at or before sample time `now`
+void sched_run(t_sched *s, lua_State *L, int64_t now, t_sched_report report, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHED_H
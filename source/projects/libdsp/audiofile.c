@@ -0,0 +1,325 @@
+/**
+    @file
+    audiofile: WAV/AIFF files mapped into memory and decoded to float
+
+    Supported: WAV (PCM 8/16/24/32, float 32/64, extensible) and AIFF/AIFC
+    (PCM 8/16/24/32, 'sowt', 'fl32', 'fl64').
+*/
+
+#include "audiofile.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// platform
+
+#ifdef _WIN32
+
+static int audiofile_map(t_audiofile *f, const char *path)
+{
+    LARGE_INTEGER size;
+
+    f->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (f->file == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    if (!GetFileSizeEx(f->file, &size) || size.QuadPart == 0) {
+        CloseHandle(f->file);
+        return -1;
+    }
+    f->mapping = CreateFileMappingA(f->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    f->map = f->mapping ? MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (f->map == NULL) {
+        if (f->mapping) {
+            CloseHandle(f->mapping);
+        }
+        CloseHandle(f->file);
+        return -1;
+    }
+    f->map_bytes = (size_t)size.QuadPart;
+    return 0;
+}
+
+void audiofile_close(t_audiofile *f)
+{
+    UnmapViewOfFile(f->map);
+    CloseHandle(f->mapping);
+    CloseHandle(f->file);
+}
+
+#else
+
+static int audiofile_map(t_audiofile *f, const char *path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+    f->map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps the file open
+    if (f->map == MAP_FAILED) {
+        f->map = NULL;
+        return -1;
+    }
+    f->map_bytes = (size_t)st.st_size;
+    madvise(f->map, f->map_bytes, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void audiofile_close(t_audiofile *f)
+{
+    munmap(f->map, f->map_bytes);
+}
+
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// headers
+
+static uint32_t audiofile_le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t audiofile_le16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t audiofile_be32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint16_t audiofile_be16(const unsigned char *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// 80 bit ieee extended (aiff sample rate)
+static double audiofile_extended(const unsigned char *p)
+{
+    int exponent = ((p[0] & 0x7F) << 8) | p[1];
+    uint64_t mantissa = 0;
+    double value;
+
+    for (int i = 0; i < 8; i++) {
+        mantissa = (mantissa << 8) | p[2 + i];
+    }
+    if (exponent == 0 && mantissa == 0) {
+        return 0.0;
+    }
+    value = (double)mantissa;
+    exponent -= 16383 + 63;
+    while (exponent > 0) {
+        value *= 2.0;
+        exponent--;
+    }
+    while (exponent < 0) {
+        value *= 0.5;
+        exponent++;
+    }
+    return (p[0] & 0x80) ? -value : value;
+}
+
+// the data chunk divides by channels * bytes: check before getting there
+static int audiofile_valid_format(const t_audiofile *f)
+{
+    return f->channels >= 1 && f->bytes >= 1 && f->bytes <= 8;
+}
+
+static int audiofile_parse_wav(t_audiofile *f)
+{
+    const unsigned char *p = (const unsigned char *)f->map;
+    const unsigned char *end = p + f->map_bytes;
+    const unsigned char *chunk = p + 12;
+    int have_fmt = 0;
+
+    while (chunk + 8 <= end) {
+        uint32_t size = audiofile_le32(chunk + 4);
+        const unsigned char *body = chunk + 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16 && body + 16 <= end) {
+            int tag = audiofile_le16(body);
+            int bits = audiofile_le16(body + 14);
+            if (tag == 0xFFFE && size >= 26 && body + 26 <= end) {
+                tag = audiofile_le16(body + 24);   // subformat guid
+            }
+            f->channels = audiofile_le16(body + 2);
+            f->samplerate = audiofile_le32(body + 4);
+            f->bytes = bits / 8;
+            if (tag == 1) {
+                f->format = bits == 8 ? AUDIOFILE_PCM_U8 : AUDIOFILE_PCM;
+            } else if (tag == 3 && (bits == 32 || bits == 64)) {
+                f->format = AUDIOFILE_FLOAT;
+            } else {
+                return -1;
+            }
+            if (!audiofile_valid_format(f)) {
+                return -1;
+            }
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_fmt) {
+            size_t avail = (size_t)(end - body);
+            f->data = body;
+            f->frames = (size < avail ? size : avail) / (size_t)(f->bytes * f->channels);
+            return 0;
+        }
+        if ((size_t)(end - body) < size) {
+            break;
+        }
+        chunk = body + size + (size & 1);
+    }
+    return -1;
+}
+
+static int audiofile_parse_aiff(t_audiofile *f, int aifc)
+{
+    const unsigned char *p = (const unsigned char *)f->map;
+    const unsigned char *end = p + f->map_bytes;
+    const unsigned char *chunk = p + 12;
+    int have_comm = 0;
+
+    f->big_endian = 1;
+    while (chunk + 8 <= end) {
+        uint32_t size = audiofile_be32(chunk + 4);
+        const unsigned char *body = chunk + 8;
+
+        if (memcmp(chunk, "COMM", 4) == 0 && size >= 18 && body + 18 <= end) {
+            int bits = audiofile_be16(body + 6);
+            f->channels = audiofile_be16(body);
+            f->samplerate = audiofile_extended(body + 8);
+            f->bytes = (bits + 7) / 8;
+            f->format = AUDIOFILE_PCM;
+            if (aifc && size >= 22) {
+                const unsigned char *type = body + 18;
+                if (memcmp(type, "sowt", 4) == 0) {
+                    f->big_endian = 0;
+                } else if (memcmp(type, "fl32", 4) == 0 || memcmp(type, "FL32", 4) == 0) {
+                    f->format = AUDIOFILE_FLOAT;
+                    f->bytes = 4;
+                } else if (memcmp(type, "fl64", 4) == 0 || memcmp(type, "FL64", 4) == 0) {
+                    f->format = AUDIOFILE_FLOAT;
+                    f->bytes = 8;
+                } else if (memcmp(type, "NONE", 4) != 0) {
+                    return -1;
+                }
+            }
+            if (!audiofile_valid_format(f)) {
+                return -1;
+            }
+            have_comm = 1;
+        } else if (memcmp(chunk, "SSND", 4) == 0 && have_comm && size >= 8) {
+            const unsigned char *data = body + 8 + audiofile_be32(body);
+            size_t avail = data < end ? (size_t)(end - data) : 0;
+            size_t bytes = size - 8 < avail ? size - 8 : avail;
+            f->data = data;
+            f->frames = bytes / (size_t)(f->bytes * f->channels);
+            return 0;
+        }
+        if ((size_t)(end - body) < size) {
+            break;
+        }
+        chunk = body + size + (size & 1);
+    }
+    return -1;
+}
+
+static int audiofile_parse(t_audiofile *f)
+{
+    const unsigned char *p = (const unsigned char *)f->map;
+    int result = -1;
+
+    if (f->map_bytes < 12) {
+        return -1;
+    }
+    if (memcmp(p, "RIFF", 4) == 0 && memcmp(p + 8, "WAVE", 4) == 0) {
+        result = audiofile_parse_wav(f);
+    } else if (memcmp(p, "FORM", 4) == 0 && memcmp(p + 8, "AIFF", 4) == 0) {
+        result = audiofile_parse_aiff(f, 0);
+    } else if (memcmp(p, "FORM", 4) == 0 && memcmp(p + 8, "AIFC", 4) == 0) {
+        result = audiofile_parse_aiff(f, 1);
+    }
+    return result;
+}
+
+
+
+int audiofile_open(t_audiofile *f, const char *path)
+{
+    memset(f, 0, sizeof(t_audiofile));
+    if (audiofile_map(f, path) != 0) {
+        return -1;
+    }
+    if (audiofile_parse(f) != 0) {
+        audiofile_close(f);
+        return -1;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// decoding
+
+static float audiofile_sample(const t_audiofile *f, const unsigned char *p)
+{
+    unsigned char b[8];
+
+    if (f->format == AUDIOFILE_PCM_U8) {
+        return (p[0] - 128) * (1.0f / 128.0f);
+    }
+    // to little endian
+    for (int i = 0; i < f->bytes; i++) {
+        b[i] = f->big_endian ? p[f->bytes - 1 - i] : p[i];
+    }
+    if (f->format == AUDIOFILE_FLOAT) {
+        if (f->bytes == 4) {
+            float f;
+            memcpy(&f, b, 4);
+            return f;
+        } else {
+            double d;
+            memcpy(&d, b, 8);
+            return (float)d;
+        }
+    }
+    switch (f->bytes) {
+        case 1: return (int8_t)b[0] * (1.0f / 128.0f);
+        case 2: return (int16_t)(b[0] | (b[1] << 8)) * (1.0f / 32768.0f);
+        case 3: return (int32_t)(((uint32_t)b[0] << 8) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 24))
+                       * (1.0f / 2147483648.0f);
+        case 4: return (int32_t)audiofile_le32(b) * (1.0f / 2147483648.0f);
+        default: return 0.0f;
+    }
+}
+
+void audiofile_decode(const t_audiofile *f, size_t from, size_t frames, float *out)
+{
+    size_t stride = (size_t)f->bytes;
+    const unsigned char *p = f->data + from * stride * f->channels;
+    size_t n = frames * f->channels;
+
+    for (size_t i = 0; i < n; i++, p += stride) {
+        out[i] = audiofile_sample(f, p);
+    }
+}
@@ -0,0 +1,41 @@
+/**
+    @file
+    audiofile: WAV/AIFF files mapped into memory and decoded to float
+    (internal to libdsp, shared by stream.c and cache.c)
+*/
+
+#ifndef AUDIOFILE_H
+#define AUDIOFILE_H
+
+#include <stddef.h>
+
+enum {
+    AUDIOFILE_PCM_U8 = 0,   // wav 8 bit is unsigned
+    AUDIOFILE_PCM,
+    AUDIOFILE_FLOAT,
+};
+
+typedef struct _audiofile {
+    void *map;                  // the whole file, read-only
+    size_t map_bytes;
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+    const unsigned char *data;  // first frame
+    int format;
+    int big_endian;
+    int bytes;                  // per sample
+    int channels;
+    size_t frames;
+    double samplerate;
+} t_audiofile;
+
+// map and parse a file, 0 on success
+int audiofile_open(t_audiofile *f, const char *path);
+void audiofile_close(t_audiofile *f);
+
+// `frames` interleaved frames starting at `from` into out
+void audiofile_decode(const t_audiofile *f, size_t from, size_t frames, float *out);
+
+#endif // AUDIOFILE_H
@@ -0,0 +1,116 @@
+// bench_math.c
+//
+// Accuracy and speed of the libdsp fastmath tiers against libm.
+//
+//     ./bench_math [values=1000000]
+//
+// For every function and tier: the largest error over a typical argument
+// range (relative, or absolute for sin/cos/tan/tanh) and the time per value
+// of the array version, next to a plain loop over the libm function. Times
+// are taken over a block of BLOCK values that stays in cache, repeated
+// until `values` have been computed, so they show the arithmetic rather
+// than memory bandwidth.
+
+#include "libdsp.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BLOCK 4096
+
+typedef void (*array_fn)(double *out, const double *in, size_t n, int tier);
+
+typedef struct {
+    const char *name;
+    double (*libm)(double);
+    array_fn fast;
+    double lo, hi;      // argument range
+    int relative;
+} t_case;
+
+static double db_to_lin(double db) { return pow(10.0, db / 20.0); }
+static double lin_to_db(double x) { return 20.0 * log10(x); }
+
+static const t_case cases[] = {
+    { "sin", sin, dsp_math_sin_n, -100.0, 100.0, 0 },
+    { "cos", cos, dsp_math_cos_n, -100.0, 100.0, 0 },
+    { "tan", tan, dsp_math_tan_n, -1.5, 1.5, 0 },
+    { "exp2", exp2, dsp_math_exp2_n, -60.0, 60.0, 1 },
+    { "log2", log2, dsp_math_log2_n, 1e-6, 1e6, 1 },
+    { "tanh", tanh, dsp_math_tanh_n, -8.0, 8.0, 0 },
+    { "db_to_lin", db_to_lin, dsp_math_db_to_lin_n, -120.0, 24.0, 1 },
+    { "lin_to_db", lin_to_db, dsp_math_lin_to_db_n, 1e-6, 16.0, 0 },
+};
+
+static const char *tiers[] = { "fast", "medium", "precise" };
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 && atol(argv[1]) > BLOCK ? (size_t)atol(argv[1]) : 1000000;
+    size_t rounds = n / BLOCK;
+    double *in = malloc(n * sizeof(double));
+    double *ref = malloc(n * sizeof(double));
+    double *out = malloc(n * sizeof(double));
+    double block[BLOCK];
+    volatile double sink = 0.0;
+
+    printf("%-10s %-8s %12s %10s %10s\n", "function", "tier", "max error", "ns/value", "libm ns");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const t_case *k = &cases[c];
+        double t0, t_libm;
+
+        srand(1);
+        for (size_t i = 0; i < n; i++) {
+            double u = rand() / (double)RAND_MAX;
+            // log ranges for log2/lin_to_db, so small values are tested too
+            in[i] = k->lo > 0 ? k->lo * pow(k->hi / k->lo, u) : k->lo + u * (k->hi - k->lo);
+        }
+        for (size_t i = 0; i < n; i++) {
+            ref[i] = k->libm(in[i]);
+        }
+        t0 = now_ns();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < BLOCK; i++) {
+                block[i] = k->libm(in[i]);
+            }
+            sink += block[r % BLOCK];
+        }
+        t_libm = (now_ns() - t0) / (rounds * BLOCK);
+
+        for (int tier = DSP_MATH_FAST; tier <= DSP_MATH_PRECISE; tier++) {
+            double err = 0.0, t;
+            t0 = now_ns();
+            for (size_t r = 0; r < rounds; r++) {
+                k->fast(block, in, BLOCK, tier);
+                sink += block[r % BLOCK];
+            }
+            t = (now_ns() - t0) / (rounds * BLOCK);
+            k->fast(out, in, n, tier);
+            for (size_t i = 0; i < n; i++) {
+                double e = fabs(out[i] - ref[i]);
+                if (k->relative) {
+                    e /= fabs(ref[i]);
+                }
+                if (e > err) {
+                    err = e;
+                }
+            }
+            sink += out[n / 2];
+            printf("%-10s %-8s %12.2e %10.2f %10.2f\n", k->name, tiers[tier], err, t, t_libm);
+        }
+    }
+    free(in);
+    free(ref);
+    free(out);
+    return sink == 12345.0;
+}
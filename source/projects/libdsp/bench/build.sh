@@ -0,0 +1,8 @@
+cc -O3 -fno-trapping-math \
+	-I.. \
+	-o bench_math \
+	bench_math.c \
+	../fastmath.c \
+	-lm
+
+./bench_math 1000000
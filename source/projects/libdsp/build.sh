@@ -1,3 +0,0 @@
-gcc -shared -fPIC -o libdsp.dylib libdsp.c
-
-
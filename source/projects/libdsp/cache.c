@@ -0,0 +1,469 @@
+/**
+    @file
+    cache: process-wide, refcounted cache of decoded audio
+
+    Sample files and generated tables are decoded once per process and
+    shared read-only by every lua state of every instance. Entries are
+    keyed by name (the path for files), and deduplicated by a hash of their
+    contents, so two paths to the same file share one copy.
+
+    Lookups (dsp_cache_get) and releases never lock: the key table is an
+    open-addressed array of atomic pointers and references are taken with
+    a compare-and-swap that fails on evicted entries. Loading, publishing
+    and eviction are serialized by a mutex. Entries nobody holds stay
+    cached until the total size exceeds the limit, then the least recently
+    used go first. Evicted memory is freed once no lookup is in flight.
+*/
+
+#include "libdsp.h"
+#include "audiofile.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+#define cache_load(p) (MemoryBarrier(), *(p))
+#define cache_store(p, v) (MemoryBarrier(), *(p) = (v), MemoryBarrier())
+#define cache_add(p, v) InterlockedExchangeAdd64((volatile LONG64 *)(p), (v))
+#define cache_cas(p, expected, desired) \
+    (InterlockedCompareExchange64((volatile LONG64 *)(p), (desired), (expected)) == (expected))
+#else
+#define cache_load(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define cache_store(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define cache_add(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define cache_cas(p, expected, desired) \
+    __atomic_compare_exchange_n((p), &(int64_t){ (expected) }, (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#endif
+
+#define CACHE_SLOTS 4096                        // keys, power of two
+#define CACHE_LIMIT_DEFAULT (256 * 1024 * 1024) // bytes
+
+typedef struct _cache_entry {
+    int64_t refs;               // -1 once evicted
+    int64_t last_use;           // cache clock at the last lookup or release
+    uint64_t hash;              // of the contents
+    size_t bytes;
+    size_t frames;
+    int channels;
+    double samplerate;
+    struct _cache_entry *next;  // all live entries (under the mutex)
+    struct _cache_entry *retired;
+    float samples[];            // what is handed out
+} t_cache_entry;
+
+typedef struct _cache_link {
+    char *key;
+    t_cache_entry *entry;
+    int64_t file_size;          // of the file at key when it was loaded (-1: published)
+    int64_t file_mtime;
+    struct _cache_link *retired;
+} t_cache_link;
+
+#define CACHE_TOMBSTONE ((t_cache_link *)1)
+
+static t_cache_link *cache_slots[CACHE_SLOTS];
+static t_cache_entry *cache_entries = NULL;
+static t_cache_entry *cache_retired_entries = NULL;
+static t_cache_link *cache_retired_links = NULL;
+static int64_t cache_readers = 0;   // lookups in flight
+static int64_t cache_clock = 0;
+static size_t cache_usage = 0;
+static size_t cache_limit = CACHE_LIMIT_DEFAULT;
+
+
+//-----------------------------------------------------------------------------------------------
+// platform
+
+#ifdef _WIN32
+
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+#define cache_enter() AcquireSRWLockExclusive(&cache_lock)
+#define cache_exit() ReleaseSRWLockExclusive(&cache_lock)
+
+static int cache_stat(const char *path, int64_t *size, int64_t *mtime)
+{
+    struct __stat64 st;
+    if (_stat64(path, &st) != 0) {
+        return -1;
+    }
+    *size = st.st_size;
+    *mtime = st.st_mtime;
+    return 0;
+}
+
+#else
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define cache_enter() pthread_mutex_lock(&cache_lock)
+#define cache_exit() pthread_mutex_unlock(&cache_lock)
+
+static int cache_stat(const char *path, int64_t *size, int64_t *mtime)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    *size = st.st_size;
+    *mtime = st.st_mtime;
+    return 0;
+}
+
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+
+static uint64_t cache_hash(const void *data, size_t bytes)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t h = 0xcbf29ce484222325ull ^ bytes;
+    uint64_t w;
+
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    while (bytes--) {
+        h = (h ^ *p++) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+static uint64_t cache_key_hash(const char *key)
+{
+    return cache_hash(key, strlen(key));
+}
+
+static t_cache_entry *cache_entry_of(const float *samples)
+{
+    return (t_cache_entry *)((char *)samples - offsetof(t_cache_entry, samples));
+}
+
+// +1 ref unless the entry was evicted
+static int cache_ref(t_cache_entry *e)
+{
+    int64_t refs = cache_load(&e->refs);
+
+    while (refs >= 0) {
+        if (cache_cas(&e->refs, refs, refs + 1)) {
+            cache_store(&e->last_use, cache_add(&cache_clock, 1));
+            return 1;
+        }
+        refs = cache_load(&e->refs);
+    }
+    return 0;
+}
+
+static t_cache_link *cache_find(const char *key)
+{
+    size_t i = (size_t)cache_key_hash(key) & (CACHE_SLOTS - 1);
+
+    for (size_t n = 0; n < CACHE_SLOTS; n++, i = (i + 1) & (CACHE_SLOTS - 1)) {
+        t_cache_link *link = cache_load(&cache_slots[i]);
+        if (link == NULL) {
+            break;
+        }
+        if (link != CACHE_TOMBSTONE && strcmp(link->key, key) == 0) {
+            return link;
+        }
+    }
+    return NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// under the mutex
+
+static void cache_retire_link(t_cache_link *link)
+{
+    link->retired = cache_retired_links;
+    cache_retired_links = link;
+}
+
+// point key at entry, replacing an older link of the same key. Files
+// record their size and time per path: several paths may share one entry
+static void cache_link(const char *key, t_cache_entry *e, int64_t file_size, int64_t file_mtime)
+{
+    size_t i = (size_t)cache_key_hash(key) & (CACHE_SLOTS - 1);
+    size_t free_slot = CACHE_SLOTS;
+    t_cache_link *link = (t_cache_link *)calloc(1, sizeof(t_cache_link));
+
+    if (link == NULL || (link->key = (char *)malloc(strlen(key) + 1)) == NULL) {
+        free(link);
+        return;     // still usable, just not found by name
+    }
+    strcpy(link->key, key);
+    link->entry = e;
+    link->file_size = file_size;
+    link->file_mtime = file_mtime;
+
+    for (size_t n = 0; n < CACHE_SLOTS; n++, i = (i + 1) & (CACHE_SLOTS - 1)) {
+        t_cache_link *old = cache_slots[i];
+        if (old == NULL) {
+            if (free_slot == CACHE_SLOTS) {
+                free_slot = i;
+            }
+            break;
+        }
+        if (old == CACHE_TOMBSTONE) {
+            if (free_slot == CACHE_SLOTS) {
+                free_slot = i;
+            }
+        } else if (strcmp(old->key, key) == 0) {
+            cache_store(&cache_slots[i], link);
+            cache_retire_link(old);
+            return;
+        }
+    }
+    if (free_slot == CACHE_SLOTS) {
+        free(link->key);
+        free(link);
+        return;
+    }
+    cache_store(&cache_slots[free_slot], link);
+}
+
+static void cache_evict(void)
+{
+    while (cache_usage > cache_limit) {
+        t_cache_entry *oldest = NULL;
+
+        for (t_cache_entry *e = cache_entries; e; e = e->next) {
+            if (cache_load(&e->refs) == 0
+                && (oldest == NULL || cache_load(&e->last_use) < cache_load(&oldest->last_use))) {
+                oldest = e;
+            }
+        }
+        if (oldest == NULL) {
+            return;     // everything left is in use
+        }
+        if (!cache_cas(&oldest->refs, 0, -1)) {
+            continue;   // just taken by a lookup
+        }
+
+        for (size_t i = 0; i < CACHE_SLOTS; i++) {
+            t_cache_link *link = cache_slots[i];
+            if (link != NULL && link != CACHE_TOMBSTONE && link->entry == oldest) {
+                cache_store(&cache_slots[i], CACHE_TOMBSTONE);
+                cache_retire_link(link);
+            }
+        }
+        for (t_cache_entry **p = &cache_entries; *p; p = &(*p)->next) {
+            if (*p == oldest) {
+                *p = oldest->next;
+                break;
+            }
+        }
+        cache_usage -= oldest->bytes;
+        oldest->retired = cache_retired_entries;
+        cache_retired_entries = oldest;
+    }
+}
+
+// free what was evicted or replaced once no lookup can still see it
+static void cache_reclaim(void)
+{
+    if (cache_load(&cache_readers) != 0) {
+        return;
+    }
+    while (cache_retired_links) {
+        t_cache_link *link = cache_retired_links;
+        cache_retired_links = link->retired;
+        free(link->key);
+        free(link);
+    }
+    while (cache_retired_entries) {
+        t_cache_entry *e = cache_retired_entries;
+        cache_retired_entries = e->retired;
+        free(e);
+    }
+}
+
+// an entry with exactly these samples (the hash only narrows the search)
+static t_cache_entry *cache_find_contents(uint64_t hash, const float *samples, size_t frames, int channels)
+{
+    for (t_cache_entry *e = cache_entries; e; e = e->next) {
+        if (e->hash == hash && e->frames == frames && e->channels == channels
+            && memcmp(e->samples, samples, frames * channels * sizeof(float)) == 0 && cache_ref(e)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static t_cache_entry *cache_new_entry(uint64_t hash, size_t frames, int channels, double samplerate)
+{
+    size_t bytes = sizeof(t_cache_entry) + frames * channels * sizeof(float);
+    t_cache_entry *e = (t_cache_entry *)malloc(bytes);
+
+    if (e) {
+        e->refs = 1;
+        e->last_use = cache_add(&cache_clock, 1);
+        e->hash = hash;
+        e->bytes = bytes;
+        e->frames = frames;
+        e->channels = channels;
+        e->samplerate = samplerate;
+        e->retired = NULL;
+    }
+    return e;
+}
+
+static void cache_add_entry(t_cache_entry *e)
+{
+    e->next = cache_entries;
+    cache_entries = e;
+    cache_usage += e->bytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+const float *dsp_cache_load(const char *path)
+{
+    t_cache_entry *e = NULL;
+    t_cache_link *link;
+    t_audiofile file;
+    int64_t size, mtime;
+
+    if (cache_stat(path, &size, &mtime) != 0) {
+        return NULL;
+    }
+
+    cache_enter();
+
+    // unchanged since it was loaded under this path
+    link = cache_find(path);
+    if (link && link->file_size == size && link->file_mtime == mtime && cache_ref(link->entry)) {
+        cache_exit();
+        return link->entry->samples;
+    }
+
+    if (audiofile_open(&file, path) == 0) {
+        // decoded first, so that a file only shares an entry whose samples
+        // are identical to its own
+        t_cache_entry *decoded = cache_new_entry(0, file.frames, file.channels, file.samplerate);
+        if (decoded) {
+            audiofile_decode(&file, 0, file.frames, decoded->samples);
+            decoded->hash = cache_hash(decoded->samples, file.frames * file.channels * sizeof(float));
+            e = cache_find_contents(decoded->hash, decoded->samples, file.frames, file.channels);
+            if (e) {
+                free(decoded);
+            } else {
+                e = decoded;
+                cache_add_entry(e);
+            }
+        }
+        audiofile_close(&file);
+        if (e) {
+            cache_link(path, e, size, mtime);
+            cache_evict();
+        }
+    }
+    cache_reclaim();
+
+    cache_exit();
+    return e ? e->samples : NULL;
+}
+
+
+const float *dsp_cache_publish(const char *key, const float *samples, size_t frames, int channels, double samplerate)
+{
+    size_t count = frames * channels;
+    uint64_t hash = cache_hash(samples, count * sizeof(float));
+    t_cache_entry *e;
+
+    cache_enter();
+
+    e = cache_find_contents(hash, samples, frames, channels);
+    if (e == NULL) {
+        e = cache_new_entry(hash, frames, channels, samplerate);
+        if (e) {
+            memcpy(e->samples, samples, count * sizeof(float));
+            cache_add_entry(e);
+        }
+    }
+    if (e) {
+        cache_link(key, e, -1, 0);
+        cache_evict();
+    }
+    cache_reclaim();
+
+    cache_exit();
+    return e ? e->samples : NULL;
+}
+
+
+const float *dsp_cache_get(const char *key)
+{
+    const float *result = NULL;
+    t_cache_link *link;
+
+    cache_add(&cache_readers, 1);
+    link = cache_find(key);
+    if (link && cache_ref(link->entry)) {
+        result = link->entry->samples;
+    }
+    cache_add(&cache_readers, -1);
+    return result;
+}
+
+
+void dsp_cache_release(const float *samples)
+{
+    t_cache_entry *e = cache_entry_of(samples);
+
+    // stamped first: once refs reaches 0 the entry may be evicted
+    cache_add(&cache_readers, 1);
+    cache_store(&e->last_use, cache_add(&cache_clock, 1));
+    cache_add(&e->refs, -1);
+    cache_add(&cache_readers, -1);
+}
+
+
+size_t dsp_cache_frames(const float *samples)
+{
+    return cache_entry_of(samples)->frames;
+}
+
+
+int dsp_cache_channels(const float *samples)
+{
+    return cache_entry_of(samples)->channels;
+}
+
+
+double dsp_cache_samplerate(const float *samples)
+{
+    return cache_entry_of(samples)->samplerate;
+}
+
+
+void dsp_cache_set_limit(size_t bytes)
+{
+    cache_enter();
+    cache_limit = bytes;
+    cache_evict();
+    cache_reclaim();
+    cache_exit();
+}
+
+
+size_t dsp_cache_usage(void)
+{
+    size_t usage;
+
+    cache_enter();
+    usage = cache_usage;
+    cache_exit();
+    return usage;
+}
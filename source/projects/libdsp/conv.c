@@ -0,0 +1,454 @@
+/**
+    @file
+    conv: uniformly partitioned fft convolution (overlap-save)
+
+    The impulse response is cut into partitions of `block` samples whose
+    spectra (fft size 2 * block) are computed once, when the convolver is
+    created. Each block of input is transformed once into a frequency
+    domain delay line; the output spectrum is the sum over partitions of
+    delayed input spectra times partition spectra, so the cost per block
+    is two ffts plus one complex multiply-add per partition.
+
+    With a tail thread the audio thread only handles the first `head`
+    partitions. The others only need input at least `head` blocks old, so a
+    background thread computes their sum for block k + head as soon as
+    block k was transformed, leaving it head - 1 blocks to finish. A tail
+    that isn't ready in time is skipped (and counted) instead of waited
+    for. The audio thread's cost then no longer depends on the IR length.
+
+    One tail thread per process serves every threaded convolver. It is
+    started with the first and stopped with the last, both on the thread
+    creating or freeing them, and sleeps on a semaphore the audio thread
+    posts once per block, which never blocks the poster.
+*/
+
+#include "libdsp.h"
+#include "fft.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <limits.h>
+typedef SRWLOCK t_conv_lock;
+#define CONV_LOCK_INIT SRWLOCK_INIT
+#define conv_enter(l) AcquireSRWLockExclusive(l)
+#define conv_exit(l) ReleaseSRWLockExclusive(l)
+typedef HANDLE t_conv_sem;
+#define conv_sem_init(s) ((*(s) = CreateSemaphore(NULL, 0, LONG_MAX, NULL)) != NULL ? 0 : -1)
+#define conv_sem_post(s) ReleaseSemaphore(*(s), 1, NULL)
+#define conv_sem_wait(s) WaitForSingleObject(*(s), INFINITE)
+#define conv_sem_destroy(s) CloseHandle(*(s))
+#else
+#include <pthread.h>
+typedef pthread_mutex_t t_conv_lock;
+#define CONV_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define conv_enter(l) pthread_mutex_lock(l)
+#define conv_exit(l) pthread_mutex_unlock(l)
+#ifdef __APPLE__
+#include <dispatch/dispatch.h>  // unnamed posix semaphores aren't implemented on macOS
+typedef dispatch_semaphore_t t_conv_sem;
+#define conv_sem_init(s) ((*(s) = dispatch_semaphore_create(0)) != NULL ? 0 : -1)
+#define conv_sem_post(s) dispatch_semaphore_signal(*(s))
+#define conv_sem_wait(s) dispatch_semaphore_wait(*(s), DISPATCH_TIME_FOREVER)
+#define conv_sem_destroy(s) dispatch_release(*(s))
+#else
+#include <semaphore.h>
+typedef sem_t t_conv_sem;
+#define conv_sem_init(s) sem_init((s), 0, 0)
+#define conv_sem_post(s) sem_post(s)
+#define conv_sem_wait(s) sem_wait(s)   // EINTR only means an early sweep
+#define conv_sem_destroy(s) sem_destroy(s)
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define conv_load(p) (MemoryBarrier(), *(volatile int64_t *)(p))
+#define conv_store(p, v) (MemoryBarrier(), *(volatile int64_t *)(p) = (v), MemoryBarrier())
+#else
+#define conv_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define conv_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#define CONV_HEAD_DEFAULT 4     // partitions on the audio thread with a tail thread
+
+struct dsp_conv {
+    size_t block;           // partition size
+    size_t bins;            // block + 1
+    size_t parts;           // partitions of the IR
+    size_t head;            // partitions done on the audio thread
+    t_fft fft;
+
+    float *ir_re;           // parts * bins, scaled by 1 / fft size
+    float *ir_im;
+    float *fdl_re;          // slots * bins, input spectra by block
+    float *fdl_im;
+    size_t slots;
+    int64_t count;          // blocks transformed
+
+    float *acc_re;          // bins
+    float *acc_im;
+    float *window;          // 2 * block: previous and current input block
+    float *time;            // 2 * block
+    float *output;          // block: output of the current block
+    size_t pos;             // in the current block when buffering
+
+    // tail thread: results for block k in slot k % head, valid if seq == k
+    float *tail_re;         // head * bins
+    float *tail_im;
+    int64_t *tail_seq;
+    int64_t published;      // last block whose spectrum is in the delay line
+    int64_t tail_next;      // next input block to compute a tail for (tail thread)
+    int64_t misses;
+    int threaded;
+    struct dsp_conv *next;  // in the pool (under pool_list_lock)
+};
+
+// the tail thread shared by all threaded convolvers
+static t_conv_lock pool_users_lock = CONV_LOCK_INIT;    // serializes starting and stopping it
+static t_conv_lock pool_list_lock = CONV_LOCK_INIT;     // guards the list, held during a sweep
+static struct {
+    long users;
+    dsp_conv *list;
+    int64_t stop;
+    t_conv_sem wake;            // posted for every published block and on stop
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+} pool;
+
+
+//-----------------------------------------------------------------------------------------------
+
+// acc += x * h over all bins
+static void conv_mac(float *restrict acc_re, float *restrict acc_im,
+                     const float *restrict x_re, const float *restrict x_im,
+                     const float *restrict h_re, const float *restrict h_im, size_t bins)
+{
+    for (size_t k = 0; k < bins; k++) {
+        acc_re[k] += x_re[k] * h_re[k] - x_im[k] * h_im[k];
+        acc_im[k] += x_re[k] * h_im[k] + x_im[k] * h_re[k];
+    }
+}
+
+// sum of partitions [from, to) for output block k
+static void conv_sum(const dsp_conv *c, int64_t k, size_t from, size_t to, float *acc_re, float *acc_im)
+{
+    for (size_t p = from; p < to && (int64_t)p <= k; p++) {
+        size_t slot = (size_t)((k - (int64_t)p) % (int64_t)c->slots);
+        conv_mac(acc_re, acc_im,
+                 c->fdl_re + slot * c->bins, c->fdl_im + slot * c->bins,
+                 c->ir_re + p * c->bins, c->ir_im + p * c->bins, c->bins);
+    }
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// tail thread
+
+// compute the next tail of c if its input is there, returns 1 if it did
+static int conv_tail(dsp_conv *c)
+{
+    int64_t ready = conv_load(&c->published);
+
+    if (c->tail_next > ready) {
+        return 0;
+    }
+    // too late for targets the audio thread has passed
+    if (c->tail_next < ready + 1 - (int64_t)c->head) {
+        c->tail_next = ready + 1 - (int64_t)c->head;
+    }
+
+    int64_t target = c->tail_next + (int64_t)c->head;
+    size_t slot = (size_t)(target % (int64_t)c->head);
+    float *re = c->tail_re + slot * c->bins;
+    float *im = c->tail_im + slot * c->bins;
+
+    conv_store(&c->tail_seq[slot], -1);
+    memset(re, 0, c->bins * sizeof(float));
+    memset(im, 0, c->bins * sizeof(float));
+    conv_sum(c, target, c->head, c->parts, re, im);
+    conv_store(&c->tail_seq[slot], target);
+    c->tail_next++;
+    return 1;
+}
+
+// one tail per convolver and sweep, so a long IR can't starve the others
+static void conv_run(void)
+{
+    while (!conv_load(&pool.stop)) {
+        int busy = 0;
+
+        conv_enter(&pool_list_lock);
+        for (dsp_conv *c = pool.list; c; c = c->next) {
+            busy |= conv_tail(c);
+        }
+        conv_exit(&pool_list_lock);
+        if (!busy) {
+            conv_sem_wait(&pool.wake);
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI conv_thread(LPVOID arg)
+{
+    (void)arg;
+    conv_run();
+    return 0;
+}
+#else
+static void *conv_thread(void *arg)
+{
+    (void)arg;
+    conv_run();
+    return NULL;
+}
+#endif
+
+
+// add c to the pool, starting the thread for the first one; returns 0 or -1
+static int conv_join(dsp_conv *c)
+{
+    int err = 0;
+
+    conv_enter(&pool_users_lock);
+    if (pool.users == 0) {
+        pool.stop = 0;
+        err = conv_sem_init(&pool.wake);
+#ifdef _WIN32
+        if (err == 0 && (pool.thread = CreateThread(NULL, 0, conv_thread, NULL, 0, NULL)) == NULL) {
+#else
+        if (err == 0 && pthread_create(&pool.thread, NULL, conv_thread, NULL) != 0) {
+#endif
+            conv_sem_destroy(&pool.wake);
+            err = -1;
+        }
+    }
+    if (err == 0) {
+        pool.users++;
+        conv_enter(&pool_list_lock);
+        c->next = pool.list;
+        pool.list = c;
+        conv_exit(&pool_list_lock);
+    }
+    conv_exit(&pool_users_lock);
+    return err;
+}
+
+// remove c from the pool, stopping the thread with the last one
+static void conv_leave(dsp_conv *c)
+{
+    conv_enter(&pool_users_lock);
+    conv_enter(&pool_list_lock);   // waits for a sweep which may be using c
+    for (dsp_conv **link = &pool.list; *link; link = &(*link)->next) {
+        if (*link == c) {
+            *link = c->next;
+            break;
+        }
+    }
+    conv_exit(&pool_list_lock);
+    if (--pool.users == 0) {
+        conv_store(&pool.stop, 1);
+        conv_sem_post(&pool.wake);
+#ifdef _WIN32
+        WaitForSingleObject(pool.thread, INFINITE);
+        CloseHandle(pool.thread);
+#else
+        pthread_join(pool.thread, NULL);
+#endif
+        conv_sem_destroy(&pool.wake);
+    }
+    conv_exit(&pool_users_lock);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// audio thread
+
+// convolve the block in window[block, 2 * block) into c->output
+static void conv_block(dsp_conv *c)
+{
+    int64_t k = c->count;
+    size_t slot = (size_t)(k % (int64_t)c->slots);
+    size_t b = c->block;
+
+    fft_forward(&c->fft, c->window, c->fdl_re + slot * c->bins, c->fdl_im + slot * c->bins);
+
+    memset(c->acc_re, 0, c->bins * sizeof(float));
+    memset(c->acc_im, 0, c->bins * sizeof(float));
+    conv_sum(c, k, 0, c->head, c->acc_re, c->acc_im);
+
+    if (c->threaded && k >= (int64_t)c->head) {
+        size_t t = (size_t)(k % (int64_t)c->head);
+        if (conv_load(&c->tail_seq[t]) == k) {
+            const float *re = c->tail_re + t * c->bins;
+            const float *im = c->tail_im + t * c->bins;
+            for (size_t i = 0; i < c->bins; i++) {
+                c->acc_re[i] += re[i];
+                c->acc_im[i] += im[i];
+            }
+        } else {
+            c->misses++;
+        }
+    }
+    conv_store(&c->published, k);
+    c->count = k + 1;
+    if (c->threaded) {
+        conv_sem_post(&pool.wake);
+    }
+
+    fft_inverse(&c->fft, c->acc_re, c->acc_im, c->time);
+    memcpy(c->output, c->time + b, b * sizeof(float));  // the valid half
+
+    memmove(c->window, c->window + b, b * sizeof(float));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+dsp_conv *dsp_conv_new(const float *ir, size_t frames, size_t stride, size_t block, int threaded)
+{
+    dsp_conv *c;
+    float *padded;
+    size_t b = 1;
+
+    while (b < (block ? block : 256)) {
+        b <<= 1;
+    }
+    c = (dsp_conv *)calloc(1, sizeof(dsp_conv));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->block = b;
+    c->bins = b + 1;
+    c->parts = frames ? (frames + b - 1) / b : 1;
+    c->threaded = threaded && c->parts > CONV_HEAD_DEFAULT;
+    c->head = c->threaded ? CONV_HEAD_DEFAULT : c->parts;
+    c->slots = c->parts + (c->threaded ? c->head : 0);
+    c->published = -1;
+
+    if (fft_init(&c->fft, 2 * b) != 0) {
+        free(c);
+        return NULL;
+    }
+    c->ir_re = (float *)calloc(c->parts * c->bins, sizeof(float));
+    c->ir_im = (float *)calloc(c->parts * c->bins, sizeof(float));
+    c->fdl_re = (float *)calloc(c->slots * c->bins, sizeof(float));
+    c->fdl_im = (float *)calloc(c->slots * c->bins, sizeof(float));
+    c->acc_re = (float *)calloc(c->bins, sizeof(float));
+    c->acc_im = (float *)calloc(c->bins, sizeof(float));
+    c->window = (float *)calloc(2 * b, sizeof(float));
+    c->time = (float *)calloc(2 * b, sizeof(float));
+    c->output = (float *)calloc(b, sizeof(float));
+    c->tail_re = (float *)calloc(c->head * c->bins, sizeof(float));
+    c->tail_im = (float *)calloc(c->head * c->bins, sizeof(float));
+    c->tail_seq = (int64_t *)calloc(c->head, sizeof(int64_t));
+    padded = (float *)calloc(2 * b, sizeof(float));
+    if (!c->ir_re || !c->ir_im || !c->fdl_re || !c->fdl_im || !c->acc_re || !c->acc_im || !c->window
+        || !c->time || !c->output || !c->tail_re || !c->tail_im || !c->tail_seq || !padded) {
+        free(padded);
+        c->threaded = 0;
+        dsp_conv_free(c);
+        return NULL;
+    }
+
+    // partition spectra, with the inverse fft's scaling folded in
+    for (size_t p = 0; p < c->parts; p++) {
+        float scale = 1.0f / (float)(2 * b);
+        for (size_t i = 0; i < b; i++) {
+            size_t j = p * b + i;
+            padded[i] = j < frames ? ir[j * (stride ? stride : 1)] * scale : 0.0f;
+        }
+        fft_forward(&c->fft, padded, c->ir_re + p * c->bins, c->ir_im + p * c->bins);
+    }
+    free(padded);
+
+    for (size_t i = 0; i < c->head; i++) {
+        c->tail_seq[i] = -1;
+    }
+    if (c->threaded && conv_join(c) != 0) {
+        // no thread: everything on the caller's thread
+        c->threaded = 0;
+        c->head = c->parts;
+    }
+    return c;
+}
+
+
+void dsp_conv_free(dsp_conv *c)
+{
+    if (c == NULL) {
+        return;
+    }
+    if (c->threaded) {
+        conv_leave(c);
+    }
+    fft_free(&c->fft);
+    free(c->ir_re);
+    free(c->ir_im);
+    free(c->fdl_re);
+    free(c->fdl_im);
+    free(c->acc_re);
+    free(c->acc_im);
+    free(c->window);
+    free(c->time);
+    free(c->output);
+    free(c->tail_re);
+    free(c->tail_im);
+    free(c->tail_seq);
+    free(c);
+}
+
+
+void dsp_conv_process(dsp_conv *c, const double *in, double *out, size_t frames)
+{
+    size_t b = c->block;
+    size_t done = 0;
+
+    // whole blocks at a block boundary: no latency
+    while (c->pos == 0 && frames - done >= b) {
+        for (size_t i = 0; i < b; i++) {
+            c->window[b + i] = (float)in[done + i];
+        }
+        conv_block(c);
+        for (size_t i = 0; i < b; i++) {
+            out[done + i] = c->output[i];
+        }
+        done += b;
+    }
+
+    // shorter calls: collect a block, output the previous one (latency: block)
+    while (done < frames) {
+        size_t n = b - c->pos;
+        if (n > frames - done) {
+            n = frames - done;
+        }
+        for (size_t i = 0; i < n; i++) {
+            c->window[b + c->pos + i] = (float)in[done + i];
+            out[done + i] = c->output[c->pos + i];
+        }
+        c->pos += n;
+        done += n;
+        if (c->pos == b) {
+            conv_block(c);
+            c->pos = 0;
+        }
+    }
+}
+
+
+size_t dsp_conv_block(const dsp_conv *c)
+{
+    return c->block;
+}
+
+
+long dsp_conv_misses(const dsp_conv *c)
+{
+    return (long)c->misses;
+}
@@ -0,0 +1,292 @@
+/**
+    @file
+    fastmath: polynomial approximations of libm functions in accuracy tiers
+
+    Every function takes a tier: DSP_MATH_FAST (about 1e-4, for control
+    rates and modulation), DSP_MATH_MEDIUM (about 1e-7, float precision)
+    or DSP_MATH_PRECISE (about 1e-13, close to libm in double). The tier
+    only changes the polynomial degree, so all of them share the same
+    argument reduction:
+
+    - sin/cos/tan: reduced to an eighth of a cycle, sin and cos series
+    - exp2: 2^round(x) by exponent bits, times e^(f ln 2) for |f| <= 1/2;
+      0 below 2^-1021 and inf above 2^1023
+    - log2: exponent bits, plus 2 atanh((m - 1) / (m + 1)) / ln 2 for the
+      mantissa in [sqrt(1/2), sqrt(2))
+    - pow, tanh and the dB conversions are built from exp2 and log2
+
+    Errors are relative, except sin/cos/tan/tanh (absolute). The array
+    versions switch on the tier once and run a loop without calls or
+    branches, which the compiler vectorizes (gcc needs -fno-trapping-math
+    to turn the selects into masks, see CMakeLists.txt).
+    bench/bench_math.c measures speed and error against libm.
+*/
+
+#include "libdsp.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FM_PI 3.14159265358979323846
+#define FM_LN2 0.69314718055994530942
+#define FM_LOG2_10 3.32192809488736234787
+
+// taylor coefficients
+#define FM_F3 (1.0 / 6)
+#define FM_F5 (1.0 / 120)
+#define FM_F7 (1.0 / 5040)
+#define FM_F9 (1.0 / 362880)
+#define FM_F11 (1.0 / 39916800)
+#define FM_F13 (1.0 / 6227020800.0)
+#define FM_F2 (1.0 / 2)
+#define FM_F4 (1.0 / 24)
+#define FM_F6 (1.0 / 720)
+#define FM_F8 (1.0 / 40320)
+#define FM_F10 (1.0 / 3628800)
+#define FM_F12 (1.0 / 479001600)
+#define FM_F14 (1.0 / 87178291200.0)
+
+
+//-----------------------------------------------------------------------------------------------
+// kernels
+
+// sin and cos of z, |z| <= pi / 4
+static inline double fm_sin_poly(double z, int tier)
+{
+    double z2 = z * z;
+    switch (tier) {
+        case DSP_MATH_FAST:
+            return z * (1 - z2 * (FM_F3 - z2 * FM_F5));
+        case DSP_MATH_MEDIUM:
+            return z * (1 - z2 * (FM_F3 - z2 * (FM_F5 - z2 * FM_F7)));
+        default:
+            return z * (1 - z2 * (FM_F3 - z2 * (FM_F5 - z2 * (FM_F7 - z2 * (FM_F9 - z2 * (FM_F11 - z2 * FM_F13))))));
+    }
+}
+
+static inline double fm_cos_poly(double z, int tier)
+{
+    double z2 = z * z;
+    switch (tier) {
+        case DSP_MATH_FAST:
+            return 1 - z2 * (FM_F2 - z2 * (FM_F4 - z2 * FM_F6));
+        case DSP_MATH_MEDIUM:
+            return 1 - z2 * (FM_F2 - z2 * (FM_F4 - z2 * (FM_F6 - z2 * FM_F8)));
+        default:
+            return 1 - z2 * (FM_F2 - z2 * (FM_F4 - z2 * (FM_F6 - z2 * (FM_F8 - z2 * (FM_F10 - z2 * (FM_F12 - z2 * FM_F14))))));
+    }
+}
+
+static inline uint64_t fm_bits(double x)
+{
+    uint64_t u;
+    memcpy(&u, &x, sizeof(double));
+    return u;
+}
+
+static inline double fm_double(uint64_t u)
+{
+    double x;
+    memcpy(&x, &u, sizeof(double));
+    return x;
+}
+
+// a where the mask is all ones, b where it is 0
+static inline double fm_select(uint64_t mask, double a, double b)
+{
+    return fm_double((fm_bits(a) & mask) | (fm_bits(b) & ~mask));
+}
+
+// adding 1.5 * 2^52 rounds to an integer (to nearest even), which is then
+// in the low bits of the sum: no conversions or branches, so the loops
+// over these kernels vectorize
+#define FM_ROUND 6755399441055744.0
+
+// x = (q + f) pi / 2, |f| <= 1/2; `shift` quarter cycles added to q
+static inline double fm_sincos(double x, uint64_t shift, int tier)
+{
+    double t = x * (2.0 / FM_PI);
+    double big = t + FM_ROUND;
+    double z = (t - (big - FM_ROUND)) * (FM_PI / 2);
+    uint64_t q = fm_bits(big) + shift;
+    double s = fm_sin_poly(z, tier);
+    double c = fm_cos_poly(z, tier);
+    // odd quadrants take cos, the upper half cycle flips the sign bit
+    double v = fm_select(0 - (q & 1), c, s);
+    return fm_double(fm_bits(v) ^ ((q & 2) << 62));
+}
+
+static inline double fm_sin(double x, int tier) { return fm_sincos(x, 0, tier); }
+static inline double fm_cos(double x, int tier) { return fm_sincos(x, 1, tier); }
+
+static inline double fm_tan(double x, int tier)
+{
+    double t = x * (2.0 / FM_PI);
+    double big = t + FM_ROUND;
+    double z = (t - (big - FM_ROUND)) * (FM_PI / 2);
+    uint64_t q = fm_bits(big);
+    double s = fm_sin_poly(z, tier);
+    double c = fm_cos_poly(z, tier);
+    uint64_t odd = 0 - (q & 1);
+    double num = fm_select(odd, -c, s);
+    double den = fm_select(odd, s, c);
+    return num / den;
+}
+
+static inline double fm_exp2(double x, int tier)
+{
+    double c, big, y, p, r;
+
+    // results stay normal numbers, 2^i times p in [0.7, 1.42], and flush to
+    // 0 or inf outside that range
+    c = x < -1021.0 ? -1021.0 : x;
+    c = c > 1023.0 ? 1023.0 : c;
+    big = c + FM_ROUND;
+    y = (c - (big - FM_ROUND)) * FM_LN2;    // |y| <= ln 2 / 2
+    switch (tier) {
+        case DSP_MATH_FAST:
+            p = 1 + y * (1 + y * (FM_F2 + y * (FM_F3 + y * FM_F4)));
+            break;
+        case DSP_MATH_MEDIUM:
+            p = 1 + y * (1 + y * (FM_F2 + y * (FM_F3 + y * (FM_F4 + y * (FM_F5 + y * (FM_F6 + y * FM_F7))))));
+            break;
+        default:
+            p = 1 + y * (1 + y * (FM_F2 + y * (FM_F3 + y * (FM_F4 + y * (FM_F5 + y * (FM_F6 + y * (FM_F7
+                  + y * (FM_F8 + y * (FM_F9 + y * (FM_F10 + y * (FM_F11 + y * FM_F12)))))))))));
+            break;
+    }
+    // times 2^i: i added to the exponent bits
+    r = fm_double(fm_bits(p) + ((fm_bits(big) - fm_bits(FM_ROUND)) << 52));
+    r = x < -1021.0 ? 0.0 : r;
+    return x > 1023.0 ? HUGE_VAL : r;
+}
+
+static inline double fm_log2(double x, int tier)
+{
+    int sub = x < 2.2250738585072014e-308;      // subnormal (or <= 0, fixed below)
+    double xs = sub ? x * 4503599627370496.0 : x;   // 2^52
+    uint64_t bits = fm_bits(xs);
+    // the exponent field as a double: or-ed into the mantissa of 2^52
+    double e = fm_double((bits >> 52) | 0x4330000000000000ull) - 4503599627370496.0
+               - (sub ? 1023.0 + 52.0 : 1023.0);
+    double m = fm_double((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);  // [1, 2)
+    int high = m > 1.41421356237309504880;
+    double t, t2, s, r;
+
+    m = high ? m * 0.5 : m;
+    e = high ? e + 1.0 : e;
+    t = (m - 1) / (m + 1);     // |t| <= 0.172
+    t2 = t * t;
+    switch (tier) {
+        case DSP_MATH_FAST:
+            s = t * (1 + t2 * (1.0 / 3));
+            break;
+        case DSP_MATH_MEDIUM:
+            s = t * (1 + t2 * (1.0 / 3 + t2 * (1.0 / 5 + t2 * (1.0 / 7))));
+            break;
+        default:
+            s = t * (1 + t2 * (1.0 / 3 + t2 * (1.0 / 5 + t2 * (1.0 / 7 + t2 * (1.0 / 9 + t2 * (1.0 / 11
+                  + t2 * (1.0 / 13 + t2 * (1.0 / 15))))))));
+            break;
+    }
+    r = e + s * (2.0 / FM_LN2);
+    // as libm: log2(0) = -inf, log2(inf) = inf, NaN below 0
+    r = x == 0.0 ? -HUGE_VAL : r;
+    r = x == HUGE_VAL ? HUGE_VAL : r;
+    return x < 0.0 || x != x ? NAN : r;
+}
+
+static inline double fm_pow(double x, double y, int tier)
+{
+    double r = fm_exp2(y * fm_log2(x, tier), tier);
+    double zero = y > 0.0 ? 0.0 : y == 0.0 ? 1.0 : HUGE_VAL;
+    return x == 0.0 ? zero : r;
+}
+
+static inline double fm_tanh(double x, int tier)
+{
+    double e;
+
+    x = x < -20.0 ? -20.0 : x;     // +-1 in double precision there
+    x = x > 20.0 ? 20.0 : x;
+    e = fm_exp2(x * (2.0 / FM_LN2), tier);    // e^2x
+    return 1.0 - 2.0 / (e + 1.0);
+}
+
+static inline double fm_db_to_lin(double db, int tier)
+{
+    return fm_exp2(db * (FM_LOG2_10 / 20.0), tier);
+}
+
+static inline double fm_lin_to_db(double x, int tier)
+{
+    return fm_log2(x, tier) * (20.0 / FM_LOG2_10);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// scalar and array entry points
+
+#define FM_SCALAR(name) \
+    double dsp_math_##name(double x, int tier) \
+    { \
+        return fm_##name(x, tier); \
+    }
+
+// the tier is a constant inside each loop, so every loop inlines one kernel
+#define FM_ARRAY(name) \
+    void dsp_math_##name##_n(double *out, const double *in, size_t n, int tier) \
+    { \
+        switch (tier) { \
+            case DSP_MATH_FAST: \
+                for (size_t i = 0; i < n; i++) out[i] = fm_##name(in[i], DSP_MATH_FAST); \
+                break; \
+            case DSP_MATH_MEDIUM: \
+                for (size_t i = 0; i < n; i++) out[i] = fm_##name(in[i], DSP_MATH_MEDIUM); \
+                break; \
+            default: \
+                for (size_t i = 0; i < n; i++) out[i] = fm_##name(in[i], DSP_MATH_PRECISE); \
+                break; \
+        } \
+    }
+
+FM_SCALAR(sin)
+FM_SCALAR(cos)
+FM_SCALAR(tan)
+FM_SCALAR(exp2)
+FM_SCALAR(log2)
+FM_SCALAR(tanh)
+FM_SCALAR(db_to_lin)
+FM_SCALAR(lin_to_db)
+
+FM_ARRAY(sin)
+FM_ARRAY(cos)
+FM_ARRAY(tan)
+FM_ARRAY(exp2)
+FM_ARRAY(log2)
+FM_ARRAY(tanh)
+FM_ARRAY(db_to_lin)
+FM_ARRAY(lin_to_db)
+
+
+double dsp_math_pow(double x, double y, int tier)
+{
+    return fm_pow(x, y, tier);
+}
+
+
+void dsp_math_pow_n(double *out, const double *x, const double *y, size_t n, int tier)
+{
+    switch (tier) {
+        case DSP_MATH_FAST:
+            for (size_t i = 0; i < n; i++) out[i] = fm_pow(x[i], y[i], DSP_MATH_FAST);
+            break;
+        case DSP_MATH_MEDIUM:
+            for (size_t i = 0; i < n; i++) out[i] = fm_pow(x[i], y[i], DSP_MATH_MEDIUM);
+            break;
+        default:
+            for (size_t i = 0; i < n; i++) out[i] = fm_pow(x[i], y[i], DSP_MATH_PRECISE);
+            break;
+    }
+}
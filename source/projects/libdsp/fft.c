@@ -0,0 +1,198 @@
+/**
+    @file
+    fft: real fft of power-of-two sizes with split re/im spectra
+
+    A real transform of size n is done as a complex transform of size n / 2
+    (even samples as real, odd as imaginary parts) and a split pass. The
+    complex transform is an iterative radix-2 with per-size twiddle tables.
+    Spectra are kept as separate re and im arrays so the loops working on
+    them (multiply-accumulate, magnitudes) vectorize.
+*/
+
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+int fft_init(t_fft *f, size_t n)
+{
+    size_t half = n / 2;
+    size_t bits = 0;
+
+    if (n < 4 || (n & (n - 1)) != 0) {
+        return -1;
+    }
+    while (((size_t)1 << bits) < half) {
+        bits++;
+    }
+
+    f->n = n;
+    f->half = half;
+    f->stages = bits;
+    f->cos = (float *)malloc(half / 2 * sizeof(float) + sizeof(float));
+    f->sin = (float *)malloc(half / 2 * sizeof(float) + sizeof(float));
+    f->rcos = (float *)malloc((half + 1) * sizeof(float));
+    f->rsin = (float *)malloc((half + 1) * sizeof(float));
+    f->rev = (size_t *)malloc(half * sizeof(size_t));
+    f->wre = (float *)malloc(half * sizeof(float));
+    f->wim = (float *)malloc(half * sizeof(float));
+    if (!f->cos || !f->sin || !f->rcos || !f->rsin || !f->rev || !f->wre || !f->wim) {
+        fft_free(f);
+        return -1;
+    }
+
+    for (size_t k = 0; k < half / 2; k++) {
+        f->cos[k] = (float)cos(2.0 * M_PI * k / half);
+        f->sin[k] = (float)-sin(2.0 * M_PI * k / half);
+    }
+    for (size_t k = 0; k <= half; k++) {
+        f->rcos[k] = (float)cos(2.0 * M_PI * k / n);
+        f->rsin[k] = (float)-sin(2.0 * M_PI * k / n);
+    }
+    for (size_t i = 0; i < half; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        f->rev[i] = r;
+    }
+    return 0;
+}
+
+
+void fft_free(t_fft *f)
+{
+    free(f->cos);
+    free(f->sin);
+    free(f->rcos);
+    free(f->rsin);
+    free(f->rev);
+    free(f->wre);
+    free(f->wim);
+    f->cos = f->sin = f->rcos = f->rsin = f->wre = f->wim = NULL;
+    f->rev = NULL;
+}
+
+
+// one pass of the complex transform, in place on bit reversed input:
+// butterflies of `size` points; sign -1 forward, +1 inverse
+static void fft_pass(const t_fft *f, float *re, float *im, float sign, size_t size)
+{
+    size_t half = f->half;
+    size_t step = half / size;
+    size_t mid = size / 2;
+
+    for (size_t start = 0; start < half; start += size) {
+        float *ar = re + start;
+        float *ai = im + start;
+        float *br = ar + mid;
+        float *bi = ai + mid;
+        for (size_t k = 0; k < mid; k++) {
+            float wr = f->cos[k * step];
+            float wi = -sign * f->sin[k * step];
+            float tr = br[k] * wr - bi[k] * wi;
+            float ti = br[k] * wi + bi[k] * wr;
+            br[k] = ar[k] - tr;
+            bi[k] = ai[k] - ti;
+            ar[k] += tr;
+            ai[k] += ti;
+        }
+    }
+}
+
+
+// step 0 packs the input, 1 .. stages are the passes, the last splits
+size_t fft_steps(const t_fft *f)
+{
+    return f->stages + 2;
+}
+
+
+void fft_forward(const t_fft *f, const float *in, float *re, float *im)
+{
+    for (size_t step = 0; step < fft_steps(f); step++) {
+        fft_forward_step(f, in, re, im, step);
+    }
+}
+
+
+void fft_inverse(const t_fft *f, const float *re, const float *im, float *out)
+{
+    for (size_t step = 0; step < fft_steps(f); step++) {
+        fft_inverse_step(f, re, im, out, step);
+    }
+}
+
+
+void fft_forward_step(const t_fft *f, const float *in, float *re, float *im, size_t step)
+{
+    size_t half = f->half;
+    float *zr = f->wre;
+    float *zi = f->wim;
+
+    if (step == 0) {
+        for (size_t i = 0; i < half; i++) {
+            size_t r = f->rev[i];
+            zr[r] = in[2 * i];
+            zi[r] = in[2 * i + 1];
+        }
+        return;
+    }
+    if (step <= f->stages) {
+        fft_pass(f, zr, zi, -1.0f, (size_t)2 << (step - 1));
+        return;
+    }
+
+    // X[k] = E[k] + W^k O[k], with E/O the spectra of even/odd samples
+    re[0] = zr[0] + zi[0];
+    im[0] = 0.0f;
+    re[half] = zr[0] - zi[0];
+    im[half] = 0.0f;
+    for (size_t k = 1; k < half; k++) {
+        float ar = zr[k], ai = zi[k];
+        float br = zr[half - k], bi = -zi[half - k];   // conj(Z[half - k])
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+        float wr = f->rcos[k], wi = f->rsin[k];
+        re[k] = er + or_ * wr - oi * wi;
+        im[k] = ei + or_ * wi + oi * wr;
+    }
+}
+
+
+void fft_inverse_step(const t_fft *f, const float *re, const float *im, float *out, size_t step)
+{
+    size_t half = f->half;
+    float *zr = f->wre;
+    float *zi = f->wim;
+
+    if (step > 0 && step <= f->stages) {
+        fft_pass(f, zr, zi, 1.0f, (size_t)2 << (step - 1));
+        return;
+    }
+    if (step > f->stages) {
+        for (size_t i = 0; i < half; i++) {
+            out[2 * i] = zr[i];
+            out[2 * i + 1] = zi[i];
+        }
+        return;
+    }
+
+    // Z[k] = E[k] + i O[k], recovered from X[k] and conj(X[half - k])
+    for (size_t k = 0; k < half; k++) {
+        float ar = re[k], ai = im[k];
+        float br = re[half - k], bi = -im[half - k];
+        float er = ar + br, ei = ai + bi;
+        float dr = ar - br, di = ai - bi;
+        float wr = f->rcos[k], wi = -f->rsin[k];       // W^-k
+        float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+        size_t r = f->rev[k];
+        zr[r] = er - oi;
+        zi[r] = ei + or_;
+    }
+}
@@ -0,0 +1,41 @@
+/**
+    @file
+    fft: real fft of power-of-two sizes with split re/im spectra
+    (internal to libdsp, used by conv.c and stft.c)
+*/
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stddef.h>
+
+typedef struct _fft {
+    size_t n;           // real size
+    size_t half;        // complex size, n / 2
+    size_t stages;      // log2(half)
+    float *cos;         // twiddles of the half size complex fft
+    float *sin;
+    float *rcos;        // twiddles splitting the real spectrum
+    float *rsin;
+    size_t *rev;        // bit reversal of the half size
+    float *wre;         // scratch, half
+    float *wim;
+} t_fft;
+
+// 0 on success, n a power of two >= 4
+int fft_init(t_fft *f, size_t n);
+void fft_free(t_fft *f);
+
+// n real samples -> n / 2 + 1 bins
+void fft_forward(const t_fft *f, const float *in, float *re, float *im);
+
+// n / 2 + 1 bins -> n real samples, scaled by n (not normalized)
+void fft_inverse(const t_fft *f, const float *re, const float *im, float *out);
+
+// the same transforms in fft_steps() slices of similar cost, run in order
+// from 0, for spreading one over several calls (the scratch is f's)
+size_t fft_steps(const t_fft *f);
+void fft_forward_step(const t_fft *f, const float *in, float *re, float *im, size_t step);
+void fft_inverse_step(const t_fft *f, const float *re, const float *im, float *out, size_t step);
+
+#endif // FFT_H
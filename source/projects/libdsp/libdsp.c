@@ -1,6 +1,12 @@
 
+#include "libdsp.h"
+
 #include <math.h>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 // from: https://www.desmos.com/calculator/ewnq4hyrbz
 
 double scale_linear(double x, double i_min, double i_max, double o_min, double o_max)
@@ -21,23 +27,28 @@ double scale_sine2(double x, double i_min, double i_max, double o_min, double o_
 }
 
 
+// the exp and log curves use fastmath: float precision for pow (as powf
+// before), and log2 for a ratio of logs
+
 double scale_exp1(double x, double s, double i_min, double i_max, double o_min, double o_max)
 {
-    return -s * powf(fabs(o_min - o_max - s), (x - i_max) / (i_min  - i_max)) + o_max + s;
+    return -s * dsp_math_pow(fabs(o_min - o_max - s), (x - i_max) / (i_min  - i_max), DSP_MATH_MEDIUM) + o_max + s;
 }
 
 double scale_exp2(double x, double s, double i_min, double i_max, double o_min, double o_max)
 {
-    return s * powf(fabs(o_max - o_min + s), (x - i_min) / (i_max  - i_min)) + o_min - s;
+    return s * dsp_math_pow(fabs(o_max - o_min + s), (x - i_min) / (i_max  - i_min), DSP_MATH_MEDIUM) + o_min - s;
 }
 
 
 double scale_log1(double x, double p, double i_min, double i_max, double o_min, double o_max)
 {
-    return ((o_max - o_min) * log(fabs(x - i_min + p))) / log(fabs(i_max - i_min + p)) + o_min;
+    return ((o_max - o_min) * dsp_math_log2(fabs(x - i_min + p), DSP_MATH_PRECISE))
+           / dsp_math_log2(fabs(i_max - i_min + p), DSP_MATH_PRECISE) + o_min;
 }
 
 double scale_log2(double x, double p, double i_min, double i_max, double o_min, double o_max)
 {
-    return ((o_min - o_max) * log(fabs(x - i_max - p))) / log(fabs(i_min - i_max - p)) + o_max;
+    return ((o_min - o_max) * dsp_math_log2(fabs(x - i_max - p), DSP_MATH_PRECISE))
+           / dsp_math_log2(fabs(i_min - i_max - p), DSP_MATH_PRECISE) + o_max;
 }
@@ -0,0 +1,297 @@
+/**
+    @file
+    libdsp: native dsp kernels for luajit~ and luajit.stk~
+
+    Everything declared here is also declared (via ffi.cdef) in
+    `examples/libdsp.lua`, so keep the two in sync.
+*/
+
+#ifndef LIBDSP_H
+#define LIBDSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#  ifdef LIBDSP_BUILD
+#    define LIBDSP_API __declspec(dllexport)
+#  else
+#    define LIBDSP_API __declspec(dllimport)
+#  endif
+#else
+#  define LIBDSP_API __attribute__((visibility("default")))
+#endif
+
+// filename of the shared library in the package's `support` folder
+#if defined(__APPLE__)
+#  define LIBDSP_FILENAME "libdsp.dylib"
+#elif defined(_WIN32)
+#  define LIBDSP_FILENAME "libdsp.dll"
+#else
+#  define LIBDSP_FILENAME "libdsp.so"
+#endif
+
+//-----------------------------------------------------------------------------------------------
+// scaling functions
+
+LIBDSP_API double scale_linear(double x, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_sine1(double x, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_sine2(double x, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_exp1(double x, double s, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_exp2(double x, double s, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_log1(double x, double p, double i_min, double i_max, double o_min, double o_max);
+LIBDSP_API double scale_log2(double x, double p, double i_min, double i_max, double o_min, double o_max);
+
+//-----------------------------------------------------------------------------------------------
+// store: process-wide, refcounted, read-only data shared by all instances
+
+// publish a copy of `count` doubles under `name` (+1 ref). Republishing a name
+// with different contents creates a new version; old views stay valid.
+LIBDSP_API const double* dsp_store_publish(const char* name, const double* data, size_t count);
+
+// look up the current version of `name` (+1 ref), NULL if not published
+LIBDSP_API const double* dsp_store_lookup(const char* name, size_t* count);
+
+// drop a reference; the data is unmapped when the last one is released
+LIBDSP_API void dsp_store_release(const double* data);
+
+// number of doubles in a published array
+LIBDSP_API size_t dsp_store_size(const double* data);
+
+//-----------------------------------------------------------------------------------------------
+// stream: WAV/AIFF files mapped into memory and decoded ahead of the reader
+// by a background thread. One reader per stream; reads never block and
+// return silence for frames not decoded yet.
+
+typedef struct dsp_stream dsp_stream;
+
+// NULL if the file can't be mapped or its format isn't supported.
+// ring_frames is how far to read ahead (0: default)
+LIBDSP_API dsp_stream* dsp_stream_open(const char* path, size_t ring_frames);
+LIBDSP_API void dsp_stream_close(dsp_stream* s);
+
+// interleaved frames into out, returns how many were available (the rest is
+// zeroed). The double version fills the layout of stk::StkFrames (&frames[0])
+LIBDSP_API size_t dsp_stream_read(dsp_stream* s, float* out, size_t frames);
+LIBDSP_API size_t dsp_stream_read_double(dsp_stream* s, double* out, size_t frames);
+
+// zero-copy: the readable frames in the ring up to its wrap point, then
+// dsp_stream_advance by the frames used
+LIBDSP_API const float* dsp_stream_peek(dsp_stream* s, size_t* frames);
+LIBDSP_API void dsp_stream_advance(dsp_stream* s, size_t frames);
+
+// continue from `frame` (silence until the thread caught up)
+LIBDSP_API void dsp_stream_seek(dsp_stream* s, size_t frame);
+LIBDSP_API void dsp_stream_loop(dsp_stream* s, int loop);
+
+// 1 once the end of the file was read (not looping)
+LIBDSP_API int dsp_stream_done(dsp_stream* s);
+
+LIBDSP_API size_t dsp_stream_frames(const dsp_stream* s);
+LIBDSP_API int dsp_stream_channels(const dsp_stream* s);
+LIBDSP_API double dsp_stream_samplerate(const dsp_stream* s);
+LIBDSP_API size_t dsp_stream_position(const dsp_stream* s);
+
+//-----------------------------------------------------------------------------------------------
+// cache: decoded audio (files or generated tables) shared by every instance.
+// Views are read-only, refcounted, and deduplicated by content; entries no
+// one holds are evicted least recently used first above the memory limit.
+
+// decode a WAV/AIFF file once per process (+1 ref), NULL on failure.
+// Reloads the file if it changed since. Not for the audio thread.
+LIBDSP_API const float* dsp_cache_load(const char* path);
+
+// a copy of interleaved samples under `key` (+1 ref). Not for the audio thread.
+LIBDSP_API const float* dsp_cache_publish(const char* key, const float* samples, size_t frames, int channels, double samplerate);
+
+// lock-free lookup of a loaded path or published key (+1 ref), NULL if not cached
+LIBDSP_API const float* dsp_cache_get(const char* key);
+
+// lock-free; the entry stays cached until it is evicted
+LIBDSP_API void dsp_cache_release(const float* samples);
+
+LIBDSP_API size_t dsp_cache_frames(const float* samples);
+LIBDSP_API int dsp_cache_channels(const float* samples);
+LIBDSP_API double dsp_cache_samplerate(const float* samples);
+
+// memory limit in bytes (default 256 MB) and current use
+LIBDSP_API void dsp_cache_set_limit(size_t bytes);
+LIBDSP_API size_t dsp_cache_usage(void);
+
+//-----------------------------------------------------------------------------------------------
+// conv: partitioned fft convolution with long impulse responses
+
+typedef struct dsp_conv dsp_conv;
+
+// partition and transform an IR of `frames` samples (every `stride`th float,
+// e.g. the channel count of an interleaved view). block is the partition
+// size, rounded up to a power of two (0: 256). threaded: convolve the tail
+// on the background thread all threaded convolvers share. Not for the
+// audio thread, nor is dsp_conv_free.
+LIBDSP_API dsp_conv* dsp_conv_new(const float* ir, size_t frames, size_t stride, size_t block, int threaded);
+LIBDSP_API void dsp_conv_free(dsp_conv* c);
+
+// convolve `frames` samples. Calls with a multiple of the block size have no
+// latency, others are delayed by one block; keep the size of calls constant.
+LIBDSP_API void dsp_conv_process(dsp_conv* c, const double* in, double* out, size_t frames);
+
+LIBDSP_API size_t dsp_conv_block(const dsp_conv* c);
+
+// blocks whose tail wasn't ready in time (threaded only)
+LIBDSP_API long dsp_conv_misses(const dsp_conv* c);
+
+//-----------------------------------------------------------------------------------------------
+// stft: windowed analysis, spectral modification and overlap-add resynthesis
+
+typedef struct dsp_stft dsp_stft;
+
+// size: fft size, a power of two >= 4; hop: samples between frames (at most
+// size / 4 for exact reconstruction). polar: bins as magnitude/phase instead
+// of re/im. spread: compute each frame in slices over the next hop instead
+// of at once, for an even cost per vector and `hop` more delay. Not for the
+// audio thread.
+LIBDSP_API dsp_stft* dsp_stft_new(size_t size, size_t hop, int polar, int spread);
+LIBDSP_API void dsp_stft_free(dsp_stft* s);
+
+// consume input and produce output up to the next hop boundary, returns the
+// frames done. At a boundary the bins of the last `size` inputs are ready
+// (with spread, somewhere in the hop after it) and feeding returns 0 until
+// they were synthesized.
+LIBDSP_API size_t dsp_stft_feed(dsp_stft* s, const double* in, double* out, size_t frames);
+LIBDSP_API int dsp_stft_ready(const dsp_stft* s);
+
+// size / 2 + 1 bins, which 0: re or magnitude, 1: im or phase; change in place
+LIBDSP_API float* dsp_stft_bins(dsp_stft* s, int which);
+
+// inverse transform of the (modified) bins, overlap-added to the output
+LIBDSP_API void dsp_stft_synthesize(dsp_stft* s);
+
+LIBDSP_API size_t dsp_stft_size(const dsp_stft* s);
+LIBDSP_API size_t dsp_stft_hop(const dsp_stft* s);
+
+// output delay in samples
+LIBDSP_API size_t dsp_stft_latency(const dsp_stft* s);
+
+//-----------------------------------------------------------------------------------------------
+// pvoc: phase-locked phase vocoder pitch shifter
+
+typedef struct dsp_pvoc dsp_pvoc;
+
+// size: fft size, a power of two (0: 2048); hop: 0 for size / 4; spread as
+// for dsp_stft_new. Not for the audio thread.
+LIBDSP_API dsp_pvoc* dsp_pvoc_new(size_t size, size_t hop, int spread);
+LIBDSP_API void dsp_pvoc_free(dsp_pvoc* p);
+
+// pitch ratio, 2 is an octave up; changes take effect at the next hop
+LIBDSP_API void dsp_pvoc_set_ratio(dsp_pvoc* p, double ratio);
+
+LIBDSP_API void dsp_pvoc_process(dsp_pvoc* p, const double* in, double* out, size_t frames);
+
+// output delay in samples (the fft size, plus hop with spread)
+LIBDSP_API size_t dsp_pvoc_latency(const dsp_pvoc* p);
+
+//-----------------------------------------------------------------------------------------------
+// osc: bank of band-limited oscillators (sine, PolyBLEP saw/square/triangle,
+// wavetable) summed a block at a time
+
+typedef struct dsp_oscbank dsp_oscbank;
+
+enum {
+    DSP_OSC_SINE = 0,
+    DSP_OSC_SAW,
+    DSP_OSC_SQUARE,
+    DSP_OSC_TRIANGLE,
+    DSP_OSC_TABLE
+};
+
+// `count` sine oscillators at amplitude 0. Not for the audio thread.
+LIBDSP_API dsp_oscbank* dsp_oscbank_new(int count, double samplerate);
+LIBDSP_API void dsp_oscbank_free(dsp_oscbank* b);
+LIBDSP_API int dsp_oscbank_count(const dsp_oscbank* b);
+
+// change the rate the frequencies are relative to; phases are kept
+LIBDSP_API void dsp_oscbank_set_samplerate(dsp_oscbank* b, double samplerate);
+
+// frequency (Hz) and amplitude of every oscillator, written directly by the
+// caller between renders. Amplitude changes are ramped over the next render.
+LIBDSP_API float* dsp_oscbank_freq(dsp_oscbank* b);
+LIBDSP_API float* dsp_oscbank_amp(dsp_oscbank* b);
+
+LIBDSP_API void dsp_oscbank_shape(dsp_oscbank* b, int i, int shape);
+
+// read `size` floats as one cycle (not copied, keep it alive), sets the
+// shape to DSP_OSC_TABLE
+LIBDSP_API void dsp_oscbank_table(dsp_oscbank* b, int i, const float* table, size_t size);
+
+// phase in cycles
+LIBDSP_API void dsp_oscbank_phase(dsp_oscbank* b, int i, double phase);
+
+// the sum of all oscillators into out (overwritten)
+LIBDSP_API void dsp_oscbank_render(dsp_oscbank* b, double* out, size_t frames);
+
+//-----------------------------------------------------------------------------------------------
+// fastmath: approximations of libm functions in accuracy tiers. Scalar
+// versions for lua (the ffi calls them directly), _n versions for blocks
+// (out may be in).
+
+enum {
+    DSP_MATH_FAST = 0,      // about 1e-4
+    DSP_MATH_MEDIUM,        // about 1e-7
+    DSP_MATH_PRECISE        // about 1e-13
+};
+
+LIBDSP_API double dsp_math_sin(double x, int tier);
+LIBDSP_API double dsp_math_cos(double x, int tier);
+LIBDSP_API double dsp_math_tan(double x, int tier);
+LIBDSP_API double dsp_math_exp2(double x, int tier);
+LIBDSP_API double dsp_math_log2(double x, int tier);
+LIBDSP_API double dsp_math_pow(double x, double y, int tier);     // x >= 0
+LIBDSP_API double dsp_math_tanh(double x, int tier);
+LIBDSP_API double dsp_math_db_to_lin(double db, int tier);
+LIBDSP_API double dsp_math_lin_to_db(double x, int tier);
+
+LIBDSP_API void dsp_math_sin_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_cos_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_tan_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_exp2_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_log2_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_pow_n(double* out, const double* x, const double* y, size_t n, int tier);
+LIBDSP_API void dsp_math_tanh_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_db_to_lin_n(double* out, const double* in, size_t n, int tier);
+LIBDSP_API void dsp_math_lin_to_db_n(double* out, const double* in, size_t n, int tier);
+
+//-----------------------------------------------------------------------------------------------
+// noise: a random number generator per instance (xoshiro256+, seeded with
+// splitmix64) and block fills of noise. The same seed gives the same
+// values whatever the block sizes; seed 0 picks one unique to the generator.
+
+typedef struct dsp_noise dsp_noise;
+
+enum {
+    DSP_NOISE_UNIFORM = 0,  // [-1, 1)
+    DSP_NOISE_GAUSSIAN,     // unit variance
+    DSP_NOISE_PINK,         // -3 dB per octave, about [-1, 1]
+    DSP_NOISE_BROWN         // -6 dB per octave, about [-1, 1]
+};
+
+LIBDSP_API dsp_noise* dsp_noise_new(uint64_t seed);
+LIBDSP_API void dsp_noise_free(dsp_noise* nz);
+
+// restarts the sequence (and the pink and brown filters)
+LIBDSP_API void dsp_noise_seed(dsp_noise* nz, uint64_t seed);
+
+// one uniform value in [-1, 1), from the same sequence as the fills
+LIBDSP_API double dsp_noise_next(dsp_noise* nz);
+
+// frames values of noise `kind` into out (overwritten)
+LIBDSP_API void dsp_noise_fill(dsp_noise* nz, int kind, double* out, size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBDSP_H
@@ -0,0 +1,242 @@
+/**
+    @file
+    noise: per-instance random numbers and block noise fills
+
+    Every generator owns NOISE_LANES xoshiro256+ states, stepped side by
+    side so that the refill loop vectorizes, and a buffer of NOISE_CHUNK
+    uniforms the fills take from. Outputs only depend on the seed and on
+    how many values have been taken, never on the block sizes, so offline
+    renders with the same seed are reproducible; instances with different
+    seeds are independent (the states are expanded from the seed by
+    splitmix64, as the xoshiro authors recommend). Seed 0 asks for a seed
+    unique to the generator: a process-wide counter, the clock and the
+    generator's address, so that instances running the same script (each
+    in its own lua state) never produce the same noise.
+
+    Uniform noise is in [-1, 1). Gaussian noise has unit variance and uses
+    the Box-Muller transform over whole blocks with the fastmath kernels.
+    Pink noise is Paul Kellet's refined filter over uniform white noise,
+    brown noise a leaky integrator; both are scaled to about [-1, 1]. Their
+    filters are recursive and run per sample, the white noise under them
+    is still generated a block at a time.
+*/
+
+#include "libdsp.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define noise_add(p, v) InterlockedExchangeAdd64((volatile LONG64 *)(p), (v))
+#else
+#define noise_add(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#endif
+
+#define NOISE_LANES 4
+#define NOISE_CHUNK 64
+
+struct dsp_noise {
+    uint64_t s[4][NOISE_LANES];     // xoshiro256+ state words of every lane
+    double buf[NOISE_CHUNK];        // uniforms in [0, 1)
+    int pos;                        // next unused value in buf
+    double pink[7];
+    double brown;
+};
+
+
+static int64_t noise_generators = 0;    // seeds handed out for seed 0
+
+
+//-----------------------------------------------------------------------------------------------
+
+static uint64_t noise_splitmix(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// the counter alone already differs between generators; clock and address
+// keep separate runs (and processes) apart
+static uint64_t noise_unique_seed(const dsp_noise *nz)
+{
+    uint64_t x = (uint64_t)noise_add(&noise_generators, 1);
+
+    x = noise_splitmix(&x) ^ ((uint64_t)time(NULL) << 20) ^ (uint64_t)clock();
+    x = noise_splitmix(&x) ^ (uint64_t)(uintptr_t)nz;
+    return noise_splitmix(&x);
+}
+
+// NOISE_CHUNK values, lane l writes every NOISE_LANES-th one
+static void noise_refill(dsp_noise *nz)
+{
+    uint64_t s0[NOISE_LANES], s1[NOISE_LANES], s2[NOISE_LANES], s3[NOISE_LANES];
+
+    memcpy(s0, nz->s[0], sizeof(s0));
+    memcpy(s1, nz->s[1], sizeof(s1));
+    memcpy(s2, nz->s[2], sizeof(s2));
+    memcpy(s3, nz->s[3], sizeof(s3));
+    for (int j = 0; j < NOISE_CHUNK; j += NOISE_LANES) {
+        for (int l = 0; l < NOISE_LANES; l++) {
+            uint64_t r = s0[l] + s3[l];
+            uint64_t t = s1[l] << 17;
+            // the top 52 bits as the mantissa of a double in [1, 2)
+            uint64_t bits = (r >> 12) | 0x3FF0000000000000ull;
+            double u;
+
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+
+            memcpy(&u, &bits, sizeof(double));
+            nz->buf[j + l] = u - 1.0;
+        }
+    }
+    memcpy(nz->s[0], s0, sizeof(s0));
+    memcpy(nz->s[1], s1, sizeof(s1));
+    memcpy(nz->s[2], s2, sizeof(s2));
+    memcpy(nz->s[3], s3, sizeof(s3));
+    nz->pos = 0;
+}
+
+// n uniforms in [0, 1)
+static void noise_take(dsp_noise *nz, double *out, size_t n)
+{
+    while (n > 0) {
+        size_t m;
+
+        if (nz->pos == NOISE_CHUNK) {
+            noise_refill(nz);
+        }
+        m = NOISE_CHUNK - nz->pos;
+        m = n < m ? n : m;
+        memcpy(out, nz->buf + nz->pos, m * sizeof(double));
+        nz->pos += (int)m;
+        out += m;
+        n -= m;
+    }
+}
+
+static void noise_uniform(dsp_noise *nz, double *out, size_t frames)
+{
+    noise_take(nz, out, frames);
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = 2.0 * out[i] - 1.0;
+    }
+}
+
+// one value from two uniforms: sqrt(-2 ln u1) cos(2 pi u2), u1 in (0, 1]
+static void noise_gaussian(dsp_noise *nz, double *out, size_t frames)
+{
+    double u[NOISE_CHUNK], r[NOISE_CHUNK / 2], c[NOISE_CHUNK / 2];
+
+    while (frames > 0) {
+        size_t m = frames < NOISE_CHUNK / 2 ? frames : NOISE_CHUNK / 2;
+
+        noise_take(nz, u, 2 * m);
+        for (size_t i = 0; i < m; i++) {
+            r[i] = 1.0 - u[2 * i];
+            c[i] = 6.28318530717958647692 * u[2 * i + 1];
+        }
+        dsp_math_log2_n(r, r, m, DSP_MATH_MEDIUM);
+        dsp_math_cos_n(c, c, m, DSP_MATH_MEDIUM);
+        for (size_t i = 0; i < m; i++) {
+            out[i] = sqrt(-1.38629436111989061883 * r[i]) * c[i];   // -2 ln 2 log2 u1
+        }
+        out += m;
+        frames -= m;
+    }
+}
+
+static void noise_pink(dsp_noise *nz, double *out, size_t frames)
+{
+    double *b = nz->pink;
+
+    noise_uniform(nz, out, frames);
+    for (size_t i = 0; i < frames; i++) {
+        double w = out[i];
+        b[0] = 0.99886 * b[0] + w * 0.0555179;
+        b[1] = 0.99332 * b[1] + w * 0.0750759;
+        b[2] = 0.96900 * b[2] + w * 0.1538520;
+        b[3] = 0.86650 * b[3] + w * 0.3104856;
+        b[4] = 0.55000 * b[4] + w * 0.5329522;
+        b[5] = -0.7616 * b[5] - w * 0.0168980;
+        out[i] = 0.11 * (b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + w * 0.5362);
+        b[6] = w * 0.115926;
+    }
+}
+
+static void noise_brown(dsp_noise *nz, double *out, size_t frames)
+{
+    double y = nz->brown;
+
+    noise_uniform(nz, out, frames);
+    for (size_t i = 0; i < frames; i++) {
+        y = (y + 0.02 * out[i]) * (1.0 / 1.02);
+        out[i] = 3.5 * y;
+    }
+    nz->brown = y;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+dsp_noise *dsp_noise_new(uint64_t seed)
+{
+    dsp_noise *nz = (dsp_noise *)calloc(1, sizeof(dsp_noise));
+
+    if (nz == NULL) {
+        return NULL;
+    }
+    dsp_noise_seed(nz, seed);
+    return nz;
+}
+
+
+void dsp_noise_free(dsp_noise *nz)
+{
+    free(nz);
+}
+
+
+void dsp_noise_seed(dsp_noise *nz, uint64_t seed)
+{
+    if (seed == 0) {
+        seed = noise_unique_seed(nz);
+    }
+    for (int k = 0; k < 4; k++) {
+        for (int l = 0; l < NOISE_LANES; l++) {
+            nz->s[k][l] = noise_splitmix(&seed);
+        }
+    }
+    memset(nz->pink, 0, sizeof(nz->pink));
+    nz->brown = 0.0;
+    nz->pos = NOISE_CHUNK;
+}
+
+
+double dsp_noise_next(dsp_noise *nz)
+{
+    if (nz->pos == NOISE_CHUNK) {
+        noise_refill(nz);
+    }
+    return 2.0 * nz->buf[nz->pos++] - 1.0;
+}
+
+
+void dsp_noise_fill(dsp_noise *nz, int kind, double *out, size_t frames)
+{
+    switch (kind) {
+        case DSP_NOISE_GAUSSIAN: noise_gaussian(nz, out, frames); break;
+        case DSP_NOISE_PINK: noise_pink(nz, out, frames); break;
+        case DSP_NOISE_BROWN: noise_brown(nz, out, frames); break;
+        default: noise_uniform(nz, out, frames); break;
+    }
+}
@@ -0,0 +1,304 @@
+/**
+    @file
+    osc: bank of band-limited oscillators rendered a block at a time
+
+    Every oscillator has a shape, a frequency and an amplitude; lua writes
+    the last two straight into the bank's float arrays through the ffi, so
+    setting hundreds of partials costs no calls. A render sums the whole
+    bank into the output, one oscillator at a time over chunks of
+    OSC_CHUNK samples. Within a chunk the phase of sample i is computed as
+    phase + i * inc instead of accumulated, so the loops carry no state
+    from sample to sample and the compiler vectorizes them.
+
+    Sine uses a polynomial (error below 1e-5 with the float phase), saw
+    and square are corrected with PolyBLEP residuals and triangle with
+    PolyBLAMP at its corners. Wavetables are read with linear interpolation
+    and are not band-limited by the bank.
+
+    Amplitude changes are ramped over the render, frequency changes are
+    phase-continuous.
+*/
+
+#include "libdsp.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OSC_CHUNK 64
+
+struct dsp_oscbank {
+    int count;
+    double samplerate;
+    float *freq;            // count, Hz, written by the caller
+    float *amp;             // count, written by the caller
+    float *last_amp;        // count, amplitude at the end of the last render
+    double *phase;          // count, [0, 1)
+    int *shape;             // count
+    const float **table;    // count, wavetables (not owned)
+    size_t *table_size;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// kernels: acc[i] += (a + i * da) * shape(p + i * inc), p in [0, 1)
+
+// 2 pi x for x in [-1/4, 1/4], odd taylor series up to x^11
+static inline float osc_sin_quarter(float x)
+{
+    float z = 6.28318530718f * x;
+    float z2 = z * z;
+    return z * (1.0f + z2 * (-1.0f / 6 + z2 * (1.0f / 120 + z2 * (-1.0f / 5040
+               + z2 * (1.0f / 362880 + z2 * (-1.0f / 39916800))))));
+}
+
+static inline float osc_wrap(float p)
+{
+    return p - (float)(int)p;   // p >= 0
+}
+
+static inline float osc_abs(float x)
+{
+    return x < 0.0f ? -x : x;
+}
+
+// max(x, 0), in a form gcc still vectorizes inside the residuals
+static inline float osc_pos(float x)
+{
+    return 0.5f * (x + osc_abs(x));
+}
+
+// 1 / phase increment for the residuals, finite at 0 Hz (where they then
+// only correct a phase exactly on the discontinuity)
+static inline float osc_idt(float inc)
+{
+    float dt = osc_abs(inc);
+    return 1.0f / (dt > 1e-7f ? dt : 1e-7f);
+}
+
+// the residuals below are written without branches so that the kernels
+// vectorize. a is nonzero within one sample after a discontinuity at
+// t = 0, b within one sample before it (idt: 1 / phase increment)
+
+// residual of a step of -2 (the wrap of a saw), two samples wide
+static inline float osc_blep(float t, float idt)
+{
+    float a = osc_pos(1.0f - t * idt);
+    float b = osc_pos(1.0f + (t - 1.0f) * idt);
+    return b * b - a * a;
+}
+
+// integral of osc_blep, for a change of slope at t = 0
+static inline float osc_blamp(float t, float idt)
+{
+    float a = osc_pos(1.0f - t * idt);
+    float b = osc_pos(1.0f + (t - 1.0f) * idt);
+    return (a * a * a + b * b * b) * (1.0f / 3.0f);
+}
+
+static void osc_sine(float *restrict acc, float p, float inc, float a, float da, int n)
+{
+    for (int i = 0; i < n; i++) {
+        float v = osc_wrap(p + i * inc) - 0.5f;     // sin(2 pi p) = -sin(2 pi v)
+        float q = 0.25f - osc_abs(osc_abs(v) - 0.25f);  // folded into [0, 1/4]
+        float s = osc_sin_quarter(q);
+        acc[i] += (a + i * da) * (v < 0.0f ? s : -s);
+    }
+}
+
+static void osc_saw(float *restrict acc, float p, float inc, float a, float da, int n)
+{
+    float idt = osc_idt(inc);
+    for (int i = 0; i < n; i++) {
+        float t = osc_wrap(p + i * inc);
+        acc[i] += (a + i * da) * (2.0f * t - 1.0f - osc_blep(t, idt));
+    }
+}
+
+static void osc_square(float *restrict acc, float p, float inc, float a, float da, int n)
+{
+    float idt = osc_idt(inc);
+    for (int i = 0; i < n; i++) {
+        float t = osc_wrap(p + i * inc);
+        float h = osc_wrap(t + 0.5f);
+        float y = (t < 0.5f ? 1.0f : -1.0f) + osc_blep(t, idt) - osc_blep(h, idt);
+        acc[i] += (a + i * da) * y;
+    }
+}
+
+// -1 at 0, 1 at 0.5: slope +4 / -4 per cycle, corners of 8 * dt per sample
+static void osc_triangle(float *restrict acc, float p, float inc, float a, float da, int n)
+{
+    float dt = osc_abs(inc);
+    float idt = osc_idt(inc);
+    for (int i = 0; i < n; i++) {
+        float t = osc_wrap(p + i * inc);
+        float h = osc_wrap(t + 0.5f);
+        float y = 1.0f - 4.0f * osc_abs(t - 0.5f);
+        y += 4.0f * dt * (osc_blamp(t, idt) - osc_blamp(h, idt));
+        acc[i] += (a + i * da) * y;
+    }
+}
+
+static void osc_table(float *restrict acc, float p, float inc, float a, float da, int n,
+                      const float *table, size_t size)
+{
+    if (table == NULL || size == 0) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        float x = osc_wrap(p + i * inc) * size;
+        size_t j = (size_t)x;
+        float frac = x - j;
+        float y0 = table[j < size ? j : size - 1];
+        float y1 = table[j + 1 < size ? j + 1 : 0];
+        acc[i] += (a + i * da) * (y0 + frac * (y1 - y0));
+    }
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+static double osc_fract(double p)
+{
+    p -= (double)(long long)p;
+    return p < 0.0 ? p + 1.0 : p;
+}
+
+
+dsp_oscbank *dsp_oscbank_new(int count, double samplerate)
+{
+    dsp_oscbank *b;
+
+    if (count < 1 || samplerate <= 0.0) {
+        return NULL;
+    }
+    b = (dsp_oscbank *)calloc(1, sizeof(dsp_oscbank));
+    if (b == NULL) {
+        return NULL;
+    }
+    b->count = count;
+    b->samplerate = samplerate;
+    b->freq = (float *)calloc(count, sizeof(float));
+    b->amp = (float *)calloc(count, sizeof(float));
+    b->last_amp = (float *)calloc(count, sizeof(float));
+    b->phase = (double *)calloc(count, sizeof(double));
+    b->shape = (int *)calloc(count, sizeof(int));
+    b->table = (const float **)calloc(count, sizeof(float *));
+    b->table_size = (size_t *)calloc(count, sizeof(size_t));
+    if (!b->freq || !b->amp || !b->last_amp || !b->phase || !b->shape || !b->table || !b->table_size) {
+        dsp_oscbank_free(b);
+        return NULL;
+    }
+    return b;
+}
+
+
+void dsp_oscbank_free(dsp_oscbank *b)
+{
+    if (b == NULL) {
+        return;
+    }
+    free(b->freq);
+    free(b->amp);
+    free(b->last_amp);
+    free(b->phase);
+    free(b->shape);
+    free(b->table);
+    free(b->table_size);
+    free(b);
+}
+
+
+int dsp_oscbank_count(const dsp_oscbank *b)
+{
+    return b->count;
+}
+
+
+void dsp_oscbank_set_samplerate(dsp_oscbank *b, double samplerate)
+{
+    if (samplerate > 0.0) {
+        b->samplerate = samplerate;
+    }
+}
+
+
+float *dsp_oscbank_freq(dsp_oscbank *b)
+{
+    return b->freq;
+}
+
+
+float *dsp_oscbank_amp(dsp_oscbank *b)
+{
+    return b->amp;
+}
+
+
+void dsp_oscbank_shape(dsp_oscbank *b, int i, int shape)
+{
+    if (i >= 0 && i < b->count && shape >= DSP_OSC_SINE && shape <= DSP_OSC_TABLE) {
+        b->shape[i] = shape;
+    }
+}
+
+
+void dsp_oscbank_table(dsp_oscbank *b, int i, const float *table, size_t size)
+{
+    if (i >= 0 && i < b->count) {
+        b->table[i] = table;
+        b->table_size[i] = table ? size : 0;
+        b->shape[i] = DSP_OSC_TABLE;
+    }
+}
+
+
+void dsp_oscbank_phase(dsp_oscbank *b, int i, double phase)
+{
+    if (i >= 0 && i < b->count) {
+        b->phase[i] = osc_fract(phase);
+    }
+}
+
+
+void dsp_oscbank_render(dsp_oscbank *b, double *out, size_t frames)
+{
+    float acc[OSC_CHUNK];
+    double nyquist = 0.5 * b->samplerate;
+    float ramp = frames ? 1.0f / (float)frames : 0.0f;
+
+    for (size_t start = 0; start < frames; start += OSC_CHUNK) {
+        int n = (int)(frames - start < OSC_CHUNK ? frames - start : OSC_CHUNK);
+
+        memset(acc, 0, sizeof(acc));
+        for (int k = 0; k < b->count; k++) {
+            double f = b->freq[k];
+            float inc, a, da;
+
+            f = f > nyquist ? nyquist : f < -nyquist ? -nyquist : f;
+            inc = (float)(f / b->samplerate);
+            da = (b->amp[k] - b->last_amp[k]) * ramp;
+            a = b->last_amp[k] + da * (float)(start + 1);
+
+            if (a != 0.0f || da != 0.0f) {
+                // kernels wrap non-negative phases: run negative frequencies
+                // down from a whole number of cycles above
+                float p0 = (float)b->phase[k] + (inc < 0.0f ? (float)((int)(-inc * n) + 1) : 0.0f);
+                switch (b->shape[k]) {
+                    case DSP_OSC_SAW: osc_saw(acc, p0, inc, a, da, n); break;
+                    case DSP_OSC_SQUARE: osc_square(acc, p0, inc, a, da, n); break;
+                    case DSP_OSC_TRIANGLE: osc_triangle(acc, p0, inc, a, da, n); break;
+                    case DSP_OSC_TABLE: osc_table(acc, p0, inc, a, da, n, b->table[k], b->table_size[k]); break;
+                    default: osc_sine(acc, p0, inc, a, da, n); break;
+                }
+            }
+            b->phase[k] = osc_fract(b->phase[k] + (double)inc * n);
+        }
+        for (int i = 0; i < n; i++) {
+            out[start + i] = acc[i];
+        }
+    }
+    for (int k = 0; k < b->count; k++) {
+        b->last_amp[k] = b->amp[k];
+    }
+}
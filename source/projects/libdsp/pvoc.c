@@ -0,0 +1,188 @@
+/**
+    @file
+    pvoc: phase-locked phase vocoder pitch shifter
+
+    Built on dsp_stft (magnitude/phase bins). Each frame, the true frequency
+    of every bin is estimated from its phase advance since the previous
+    frame, spectral peaks are found, and every peak moves with its region
+    of influence (the bins up to halfway to the neighbouring peaks) to the
+    bin nearest peak * ratio. The peak's phase advances at its shifted
+    frequency; the other bins of the region keep their phase offset to the
+    peak (identity phase locking, Laroche & Dolson), which avoids most of
+    the phasiness of per-bin vocoders.
+
+    The work per hop is one frame of fixed size whatever the input. It
+    lands in the vector where the hop ends, unless the stft spreads it over
+    the vectors of the next hop (see stft.c), which gives every vector the
+    same cost.
+*/
+
+#include "libdsp.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct dsp_pvoc {
+    dsp_stft *stft;
+    size_t size;
+    size_t hop;
+    size_t bins;
+    double ratio;
+    float *last;        // bins: analysis phase of the previous frame
+    float *synth;       // bins: output phase of the previous frame
+    float *freq;        // bins: estimated frequency, radians per sample
+    float *mag;         // bins: output
+    float *phase;
+    size_t *peaks;
+};
+
+
+static float pvoc_wrap(float x)
+{
+    return x - (float)(2.0 * M_PI) * floorf((x + (float)M_PI) * (float)(0.5 / M_PI));
+}
+
+static void pvoc_frame(dsp_pvoc *p)
+{
+    float *mag = dsp_stft_bins(p->stft, 0);
+    float *phase = dsp_stft_bins(p->stft, 1);
+    size_t bins = p->bins;
+    float hop = (float)p->hop;
+    float ratio = (float)p->ratio;
+    float bin_freq = (float)(2.0 * M_PI / p->size);
+    float floor_mag = 0.0f;
+    size_t npeaks = 0;
+
+    for (size_t k = 0; k < bins; k++) {
+        float expected = bin_freq * k;
+        float delta = pvoc_wrap(phase[k] - p->last[k] - expected * hop);
+        p->freq[k] = expected + delta / hop;
+        p->last[k] = phase[k];
+        if (mag[k] > floor_mag) {
+            floor_mag = mag[k];
+        }
+    }
+    if (p->ratio == 1.0) {
+        memcpy(p->synth, phase, bins * sizeof(float));
+        return;     // bins stay as they are: exact reconstruction
+    }
+
+    // peaks above -100 dB of the loudest bin
+    floor_mag *= 1e-5f;
+    for (size_t k = 1; k + 1 < bins; k++) {
+        if (mag[k] > floor_mag && mag[k] > mag[k - 1] && mag[k] >= mag[k + 1]) {
+            p->peaks[npeaks++] = k;
+        }
+    }
+
+    memset(p->mag, 0, bins * sizeof(float));
+    memset(p->phase, 0, bins * sizeof(float));
+    for (size_t i = 0; i < npeaks; i++) {
+        size_t peak = p->peaks[i];
+        size_t lo = i > 0 ? (p->peaks[i - 1] + peak + 1) / 2 : 0;
+        size_t hi = i + 1 < npeaks ? (peak + p->peaks[i + 1] + 1) / 2 : bins;
+        size_t dest = (size_t)(peak * ratio + 0.5f);
+        float advance, locked;
+
+        if (dest >= bins) {
+            break;      // above nyquist, and so is every later peak
+        }
+        advance = pvoc_wrap(p->synth[dest] + hop * p->freq[peak] * ratio);
+        for (size_t k = lo; k < hi; k++) {
+            size_t j = k + dest - peak;    // wraps for k < peak - dest, caught below
+            if (j >= bins) {
+                continue;
+            }
+            locked = advance + (phase[k] - phase[peak]);
+            if (mag[k] > p->mag[j]) {
+                p->phase[j] = locked;   // overlapping regions: the louder bin wins
+            }
+            p->mag[j] += mag[k];
+        }
+    }
+
+    memcpy(mag, p->mag, bins * sizeof(float));
+    memcpy(phase, p->phase, bins * sizeof(float));
+    for (size_t k = 0; k < bins; k++) {
+        p->synth[k] = pvoc_wrap(p->phase[k]);
+    }
+}
+
+
+dsp_pvoc *dsp_pvoc_new(size_t size, size_t hop, int spread)
+{
+    dsp_pvoc *p = (dsp_pvoc *)calloc(1, sizeof(dsp_pvoc));
+
+    if (p == NULL) {
+        return NULL;
+    }
+    size = size ? size : 2048;
+    hop = hop ? hop : size / 4;
+    p->stft = dsp_stft_new(size, hop, 1, spread);
+    if (p->stft == NULL) {
+        free(p);
+        return NULL;
+    }
+    p->size = size;
+    p->hop = hop;
+    p->bins = size / 2 + 1;
+    p->ratio = 1.0;
+    p->last = (float *)calloc(p->bins, sizeof(float));
+    p->synth = (float *)calloc(p->bins, sizeof(float));
+    p->freq = (float *)calloc(p->bins, sizeof(float));
+    p->mag = (float *)calloc(p->bins, sizeof(float));
+    p->phase = (float *)calloc(p->bins, sizeof(float));
+    p->peaks = (size_t *)calloc(p->bins, sizeof(size_t));
+    if (!p->last || !p->synth || !p->freq || !p->mag || !p->phase || !p->peaks) {
+        dsp_pvoc_free(p);
+        return NULL;
+    }
+    return p;
+}
+
+
+void dsp_pvoc_free(dsp_pvoc *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    dsp_stft_free(p->stft);
+    free(p->last);
+    free(p->synth);
+    free(p->freq);
+    free(p->mag);
+    free(p->phase);
+    free(p->peaks);
+    free(p);
+}
+
+
+void dsp_pvoc_set_ratio(dsp_pvoc *p, double ratio)
+{
+    p->ratio = ratio > 0.0 ? ratio : 1.0;
+}
+
+
+void dsp_pvoc_process(dsp_pvoc *p, const double *in, double *out, size_t frames)
+{
+    size_t done = 0;
+
+    while (done < frames) {
+        done += dsp_stft_feed(p->stft, in + done, out + done, frames - done);
+        if (dsp_stft_ready(p->stft)) {
+            pvoc_frame(p);
+            dsp_stft_synthesize(p->stft);
+        }
+    }
+}
+
+
+size_t dsp_pvoc_latency(const dsp_pvoc *p)
+{
+    return dsp_stft_latency(p->stft);
+}
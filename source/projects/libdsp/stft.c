@@ -0,0 +1,316 @@
+/**
+    @file
+    stft: short-time fourier analysis, modification and overlap-add
+
+    The caller streams audio through dsp_stft_feed, which stops at every
+    hop boundary with the bins of the last `size` input samples ready
+    (Hann windowed, as re/im or magnitude/phase). After the caller changed
+    them in place, dsp_stft_synthesize transforms them back, windows them
+    again and adds them to the output. Lua drives this loop itself (see
+    libdsp.lua), so the per-hop callback is a plain lua call.
+
+    Output is delayed by `size` samples. Unmodified bins reconstruct the
+    input exactly for hops up to size / 4.
+
+    Done at the hop boundary, a frame's work lands in one vector out of
+    every hop / vector size. With `spread`, the frame captured at a
+    boundary is instead computed in slices during the next hop, in step
+    with the samples fed, and overlap-added at the boundary after it. Every
+    vector then does about the same share of a frame, for one more hop of
+    delay.
+*/
+
+#include "libdsp.h"
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define STFT_POLAR_SLICES 16     // slices of each polar conversion with spread
+
+struct dsp_stft {
+    size_t size;
+    size_t hop;
+    size_t bins;        // size / 2 + 1
+    int polar;
+    t_fft fft;
+    float *window;      // size
+    float scale;        // overlap-add normalization and 1 / size
+    float *input;       // size, the last `size` input samples
+    float *frame;       // size
+    float *a;           // bins: re or magnitude
+    float *b;           // bins: im or phase
+    float *ola;         // size, overlap-add accumulator
+    size_t pos;         // samples into the current hop
+    int ready;
+
+    // spread: the frame in `frame` is computed in slices during the next hop
+    int spread;
+    int pending;        // a frame is being computed
+    int edited;         // its bins went through the caller
+    size_t step;        // slices done
+    size_t analysis;    // slices up to the bins being ready
+    size_t steps;       // slices per frame
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// slices of a frame: forward fft, to polar, (the caller), to re/im, inverse fft
+
+// bins [from, to) of polar conversion slice i
+static void stft_chunk(const dsp_stft *s, size_t i, size_t *from, size_t *to)
+{
+    *from = s->bins * i / STFT_POLAR_SLICES;
+    *to = s->bins * (i + 1) / STFT_POLAR_SLICES;
+}
+
+static void stft_slice(dsp_stft *s, size_t i)
+{
+    size_t fft = fft_steps(&s->fft);
+    size_t polar = s->polar ? STFT_POLAR_SLICES : 0;
+    size_t from, to;
+
+    if (i < fft) {
+        fft_forward_step(&s->fft, s->frame, s->a, s->b, i);
+    } else if (i < s->analysis) {
+        stft_chunk(s, i - fft, &from, &to);
+        for (size_t k = from; k < to; k++) {
+            float x = s->a[k], y = s->b[k];
+            s->a[k] = sqrtf(x * x + y * y);
+            s->b[k] = atan2f(y, x);
+        }
+    } else if (i < s->analysis + polar) {
+        stft_chunk(s, i - s->analysis, &from, &to);
+        for (size_t k = from; k < to; k++) {
+            float mag = s->a[k], phase = s->b[k];
+            s->a[k] = mag * cosf(phase);
+            s->b[k] = mag * sinf(phase);
+        }
+    } else {
+        fft_inverse_step(&s->fft, s->a, s->b, s->frame, i - s->analysis - polar);
+    }
+}
+
+// windowed copy of the last `size` inputs into `frame`, then slide by hop
+static void stft_capture(dsp_stft *s)
+{
+    for (size_t i = 0; i < s->size; i++) {
+        s->frame[i] = s->input[i] * s->window[i];
+    }
+    memmove(s->input, s->input + s->hop, (s->size - s->hop) * sizeof(float));
+}
+
+// shift out the hop that was just played, then add the synthesized frame
+static void stft_overlap(dsp_stft *s, int add)
+{
+    size_t size = s->size;
+    size_t hop = s->hop;
+
+    memmove(s->ola, s->ola + hop, (size - hop) * sizeof(float));
+    memset(s->ola + size - hop, 0, hop * sizeof(float));
+    for (size_t i = 0; add && i < size; i++) {
+        s->ola[i] += s->frame[i] * s->window[i] * s->scale;
+    }
+}
+
+// spread: run the pending frame's slices up to `target`, returns 0 when
+// stopping for the caller to edit the bins
+static int stft_advance(dsp_stft *s, size_t target)
+{
+    while (s->pending && s->step < target) {
+        if (s->step == s->analysis && !s->edited) {
+            s->ready = 1;
+            return 0;
+        }
+        stft_slice(s, s->step++);
+    }
+    return 1;
+}
+
+
+dsp_stft *dsp_stft_new(size_t size, size_t hop, int polar, int spread)
+{
+    dsp_stft *s = (dsp_stft *)calloc(1, sizeof(dsp_stft));
+    double sum = 0.0;
+
+    if (s == NULL) {
+        return NULL;
+    }
+    if (hop == 0 || hop > size || fft_init(&s->fft, size) != 0) {
+        free(s);
+        return NULL;
+    }
+    s->size = size;
+    s->hop = hop;
+    s->bins = size / 2 + 1;
+    s->polar = polar;
+    s->spread = spread;
+    s->window = (float *)calloc(size, sizeof(float));
+    s->input = (float *)calloc(size, sizeof(float));
+    s->frame = (float *)calloc(size, sizeof(float));
+    s->a = (float *)calloc(s->bins, sizeof(float));
+    s->b = (float *)calloc(s->bins, sizeof(float));
+    s->ola = (float *)calloc(size, sizeof(float));
+    if (!s->window || !s->input || !s->frame || !s->a || !s->b || !s->ola) {
+        dsp_stft_free(s);
+        return NULL;
+    }
+
+    // periodic Hann for analysis and synthesis; frames overlapping a sample
+    // sum to a constant weight, divided out here
+    for (size_t i = 0; i < size; i++) {
+        s->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / size));
+    }
+    for (size_t i = 0; i < size; i += hop) {
+        sum += (double)s->window[i] * s->window[i];
+    }
+    s->scale = (float)(1.0 / (sum * size));
+    s->analysis = fft_steps(&s->fft) + (polar ? STFT_POLAR_SLICES : 0);
+    s->steps = 2 * s->analysis;
+    return s;
+}
+
+
+void dsp_stft_free(dsp_stft *s)
+{
+    if (s == NULL) {
+        return;
+    }
+    fft_free(&s->fft);
+    free(s->window);
+    free(s->input);
+    free(s->frame);
+    free(s->a);
+    free(s->b);
+    free(s->ola);
+    free(s);
+}
+
+
+// spread: see stft_advance
+static size_t stft_feed_spread(dsp_stft *s, const double *in, double *out, size_t frames)
+{
+    size_t size = s->size;
+    size_t hop = s->hop;
+    size_t done = 0;
+
+    for (;;) {
+        if (s->pos == hop) {
+            if (!stft_advance(s, s->steps)) {
+                return done;
+            }
+            stft_overlap(s, s->pending);
+            stft_capture(s);
+            s->pending = 1;
+            s->edited = 0;
+            s->step = 0;
+            s->pos = 0;
+        }
+        if (done == frames) {
+            return done;
+        }
+
+        size_t n = hop - s->pos;
+        if (n > frames - done) {
+            n = frames - done;
+        }
+        for (size_t i = 0; i < n; i++) {
+            s->input[size - hop + s->pos + i] = (float)in[done + i];
+            out[done + i] = s->ola[s->pos + i];
+        }
+        s->pos += n;
+        done += n;
+
+        // the share of the frame's slices due after pos samples of the hop
+        if (!stft_advance(s, (s->steps * s->pos + hop - 1) / hop)) {
+            return done;
+        }
+    }
+}
+
+
+size_t dsp_stft_feed(dsp_stft *s, const double *in, double *out, size_t frames)
+{
+    size_t n = s->hop - s->pos;
+    size_t size = s->size;
+
+    if (s->ready) {
+        return 0;   // waiting for dsp_stft_synthesize
+    }
+    if (s->spread) {
+        return stft_feed_spread(s, in, out, frames);
+    }
+    if (n > frames) {
+        n = frames;
+    }
+
+    // the input window slides by hop at each boundary, so new samples are
+    // written at the end of what was kept
+    for (size_t i = 0; i < n; i++) {
+        s->input[size - s->hop + s->pos + i] = (float)in[i];
+        out[i] = s->ola[s->pos + i];
+    }
+    s->pos += n;
+
+    if (s->pos == s->hop) {
+        stft_capture(s);
+        for (size_t i = 0; i < s->analysis; i++) {
+            stft_slice(s, i);
+        }
+        s->ready = 1;
+    }
+    return n;
+}
+
+
+int dsp_stft_ready(const dsp_stft *s)
+{
+    return s->ready;
+}
+
+
+float *dsp_stft_bins(dsp_stft *s, int which)
+{
+    return which ? s->b : s->a;
+}
+
+
+void dsp_stft_synthesize(dsp_stft *s)
+{
+    if (!s->ready) {
+        return;
+    }
+    s->ready = 0;
+    if (s->spread) {
+        s->edited = 1;  // the next feeds carry on
+        return;
+    }
+    for (size_t i = s->analysis; i < s->steps; i++) {
+        stft_slice(s, i);
+    }
+    stft_overlap(s, 1);
+    s->pos = 0;
+}
+
+
+size_t dsp_stft_size(const dsp_stft *s)
+{
+    return s->size;
+}
+
+
+size_t dsp_stft_hop(const dsp_stft *s)
+{
+    return s->hop;
+}
+
+
+size_t dsp_stft_latency(const dsp_stft *s)
+{
+    return s->spread ? s->size + s->hop : s->size;
+}
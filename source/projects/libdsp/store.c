@@ -0,0 +1,223 @@
+/**
+    @file
+    store: process-wide, refcounted store of immutable sample data
+
+    libdsp is loaded once per process, so everything published here is
+    shared by every lua state of every luajit~ / luajit.stk~ instance.
+    Data is copied once into pages which are then made read-only.
+*/
+
+#include "libdsp.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+typedef struct _store_entry {
+    char *name;         // NULL once superseded by a newer publish of the name
+    double *data;       // read-only pages
+    size_t count;       // number of doubles
+    size_t bytes;       // size of the mapping
+    long refs;
+    struct _store_entry *next;
+} t_store_entry;
+
+static t_store_entry *store_entries = NULL;
+
+
+//-----------------------------------------------------------------------------------------------
+// platform
+
+#ifdef _WIN32
+
+static SRWLOCK store_lock = SRWLOCK_INIT;
+#define store_enter() AcquireSRWLockExclusive(&store_lock)
+#define store_exit() ReleaseSRWLockExclusive(&store_lock)
+
+static size_t store_pagesize(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+static void *store_map(size_t bytes)
+{
+    return VirtualAlloc(NULL, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+static void store_protect(void *p, size_t bytes)
+{
+    DWORD old;
+    VirtualProtect(p, bytes, PAGE_READONLY, &old);
+}
+
+static void store_unmap(void *p, size_t bytes)
+{
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+
+#else
+
+static pthread_mutex_t store_lock = PTHREAD_MUTEX_INITIALIZER;
+#define store_enter() pthread_mutex_lock(&store_lock)
+#define store_exit() pthread_mutex_unlock(&store_lock)
+
+static size_t store_pagesize(void)
+{
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static void *store_map(size_t bytes)
+{
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static void store_protect(void *p, size_t bytes)
+{
+    mprotect(p, bytes, PROT_READ);
+}
+
+static void store_unmap(void *p, size_t bytes)
+{
+    munmap(p, bytes);
+}
+
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+
+static t_store_entry *store_find(const char *name)
+{
+    for (t_store_entry *e = store_entries; e; e = e->next) {
+        if (e->name && strcmp(e->name, name) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+
+static void store_unlink(t_store_entry *entry)
+{
+    for (t_store_entry **e = &store_entries; *e; e = &(*e)->next) {
+        if (*e == entry) {
+            *e = entry->next;
+            break;
+        }
+    }
+    store_unmap(entry->data, entry->bytes);
+    free(entry->name);
+    free(entry);
+}
+
+
+const double *dsp_store_publish(const char *name, const double *data, size_t count)
+{
+    const double *result = NULL;
+    size_t page = store_pagesize();
+    size_t bytes = ((count ? count : 1) * sizeof(double) + page - 1) / page * page;
+
+    store_enter();
+
+    t_store_entry *old = store_find(name);
+    if (old && old->count == count && memcmp(old->data, data, count * sizeof(double)) == 0) {
+        // same contents: share the existing copy
+        old->refs++;
+        result = old->data;
+    } else {
+        t_store_entry *e = (t_store_entry *)calloc(1, sizeof(t_store_entry));
+        double *pages = (double *)store_map(bytes);
+        char *dup = (char *)malloc(strlen(name) + 1);
+
+        if (e && pages && dup) {
+            memcpy(pages, data, count * sizeof(double));
+            store_protect(pages, bytes);
+            strcpy(dup, name);
+
+            e->name = dup;
+            e->data = pages;
+            e->count = count;
+            e->bytes = bytes;
+            e->refs = 1;
+            e->next = store_entries;
+            store_entries = e;
+            result = pages;
+
+            // holders of the previous version keep it until they release it
+            if (old) {
+                free(old->name);
+                old->name = NULL;
+            }
+        } else {
+            free(e);
+            free(dup);
+            if (pages) {
+                store_unmap(pages, bytes);
+            }
+        }
+    }
+
+    store_exit();
+    return result;
+}
+
+
+const double *dsp_store_lookup(const char *name, size_t *count)
+{
+    const double *result = NULL;
+
+    store_enter();
+    t_store_entry *e = store_find(name);
+    if (e) {
+        e->refs++;
+        result = e->data;
+        if (count) {
+            *count = e->count;
+        }
+    }
+    store_exit();
+    return result;
+}
+
+
+void dsp_store_release(const double *data)
+{
+    store_enter();
+    for (t_store_entry *e = store_entries; e; e = e->next) {
+        if (e->data == data) {
+            if (--e->refs == 0) {
+                store_unlink(e);
+            }
+            break;
+        }
+    }
+    store_exit();
+}
+
+
+size_t dsp_store_size(const double *data)
+{
+    size_t count = 0;
+
+    store_enter();
+    for (t_store_entry *e = store_entries; e; e = e->next) {
+        if (e->data == data) {
+            count = e->count;
+            break;
+        }
+    }
+    store_exit();
+    return count;
+}
@@ -0,0 +1,391 @@
+/**
+    @file
+    stream: memory-mapped sample files read ahead by a background thread
+
+    The file is mapped, not loaded: a single prefetch thread shared by all
+    streams of the process decodes the frames ahead of the read position
+    into a float ring per stream, touching the mapped pages (and taking
+    their page faults) so the audio thread doesn't. The ring is single
+    producer (prefetch thread) / single consumer (the reader), so reads
+    never lock. Reads past what the thread has decoded return silence.
+*/
+
+#include "libdsp.h"
+#include "audiofile.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#define stream_load(p) (MemoryBarrier(), *(volatile size_t *)(p))
+#define stream_store(p, v) (MemoryBarrier(), *(volatile size_t *)(p) = (v), MemoryBarrier())
+#else
+#define stream_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define stream_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#define STREAM_RING_DEFAULT 32768   // frames read ahead
+#define STREAM_CHUNK 4096           // frames decoded per stream per pass
+
+struct dsp_stream {
+    t_audiofile file;
+    int channels;
+    size_t frames;
+
+    // ring of interleaved floats, counters in frames
+    float *ring;
+    size_t size;                // power of two
+    size_t head;                // written by the prefetch thread
+    size_t tail;                // written by the reader
+    size_t looping;
+    size_t ended;               // the thread reached the end (not looping)
+
+    // seek: the reader bumps seek_epoch, the thread answers with acked
+    // once it writes from seek_frame, at ring position ack_head
+    size_t seek_frame;
+    size_t seek_epoch;
+    size_t acked;
+    size_t ack_head;
+    size_t epoch;               // thread side
+
+    size_t pos;                 // next frame the thread decodes
+    size_t played;              // next frame the reader gets
+
+    struct dsp_stream *next;
+};
+
+static dsp_stream *stream_list = NULL;
+static int stream_running = 0;
+
+
+//-----------------------------------------------------------------------------------------------
+// platform
+
+#ifdef _WIN32
+
+static SRWLOCK stream_lock = SRWLOCK_INIT;
+#define stream_enter() AcquireSRWLockExclusive(&stream_lock)
+#define stream_exit() ReleaseSRWLockExclusive(&stream_lock)
+
+static void stream_sleep(void)
+{
+    Sleep(2);
+}
+
+static DWORD WINAPI stream_worker(LPVOID arg);
+
+static int stream_start(void)
+{
+    HANDLE thread = CreateThread(NULL, 0, stream_worker, NULL, 0, NULL);
+    if (thread == NULL) {
+        return -1;
+    }
+    CloseHandle(thread);
+    return 0;
+}
+
+#else
+
+static pthread_mutex_t stream_lock = PTHREAD_MUTEX_INITIALIZER;
+#define stream_enter() pthread_mutex_lock(&stream_lock)
+#define stream_exit() pthread_mutex_unlock(&stream_lock)
+
+static void stream_sleep(void)
+{
+    struct timespec ts = { 0, 2000000 };
+    nanosleep(&ts, NULL);
+}
+
+static void *stream_worker(void *arg);
+
+static int stream_start(void)
+{
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, stream_worker, NULL) != 0) {
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+#endif
+
+
+// decode up to STREAM_CHUNK frames into free ring space, returns frames written
+static size_t stream_fill(dsp_stream *s)
+{
+    size_t epoch = stream_load(&s->seek_epoch);
+    size_t head = s->head;
+    size_t written = 0;
+
+    if (epoch != s->epoch) {
+        s->epoch = epoch;
+        s->pos = s->seek_frame < s->frames ? s->seek_frame : s->frames;
+        stream_store(&s->ended, 0);
+        s->ack_head = head;
+        stream_store(&s->acked, epoch);
+    }
+
+    while (written < STREAM_CHUNK) {
+        size_t space = s->size - (head - stream_load(&s->tail));
+        size_t offset = head & (s->size - 1);
+        size_t n = STREAM_CHUNK - written;
+
+        if (s->pos >= s->frames) {
+            if (!stream_load(&s->looping)) {
+                stream_store(&s->ended, 1);
+                break;
+            }
+            s->pos = 0;
+        }
+        if (n > space) {
+            n = space;
+        }
+        if (n > s->size - offset) {
+            n = s->size - offset;   // up to the end of the ring
+        }
+        if (n > s->frames - s->pos) {
+            n = s->frames - s->pos;
+        }
+        if (n == 0) {
+            break;
+        }
+        audiofile_decode(&s->file, s->pos, n, s->ring + offset * s->channels);
+        s->pos += n;
+        head += n;
+        written += n;
+        stream_store(&s->head, head);
+    }
+    return written;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI stream_worker(LPVOID arg)
+#else
+static void *stream_worker(void *arg)
+#endif
+{
+    (void)arg;
+    for (;;) {
+        size_t written = 0;
+
+        stream_enter();
+        if (stream_list == NULL) {
+            stream_running = 0;
+            stream_exit();
+            break;
+        }
+        for (dsp_stream *s = stream_list; s; s = s->next) {
+            written += stream_fill(s);
+        }
+        stream_exit();
+
+        if (written == 0) {
+            stream_sleep();     // every ring is full
+        }
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// reader
+
+// frames readable at the tail, 0 while a seek is pending
+static size_t stream_ready(dsp_stream *s)
+{
+    size_t epoch = s->seek_epoch;
+
+    if (stream_load(&s->acked) != epoch) {
+        return 0;
+    }
+    if (s->tail < s->ack_head) {
+        // drop what was decoded before the seek
+        stream_store(&s->tail, s->ack_head);
+    }
+    return stream_load(&s->head) - s->tail;
+}
+
+static void stream_consume(dsp_stream *s, size_t frames)
+{
+    stream_store(&s->tail, s->tail + frames);
+    s->played += frames;
+    if (s->played >= s->frames) {
+        s->played = stream_load(&s->looping) && s->frames ? s->played % s->frames : s->frames;
+    }
+}
+
+
+dsp_stream *dsp_stream_open(const char *path, size_t ring_frames)
+{
+    dsp_stream *s = (dsp_stream *)calloc(1, sizeof(dsp_stream));
+    size_t size = 1;
+
+    if (s == NULL) {
+        return NULL;
+    }
+    if (audiofile_open(&s->file, path) != 0) {
+        free(s);
+        return NULL;
+    }
+    s->channels = s->file.channels;
+    s->frames = s->file.frames;
+
+    while (size < (ring_frames ? ring_frames : STREAM_RING_DEFAULT)) {
+        size <<= 1;
+    }
+    s->size = size;
+    s->ring = (float *)malloc(size * s->channels * sizeof(float));
+    if (s->ring == NULL) {
+        audiofile_close(&s->file);
+        free(s);
+        return NULL;
+    }
+
+    // the beginning is decoded here, so reading can start right away
+    stream_fill(s);
+
+    stream_enter();
+    s->next = stream_list;
+    stream_list = s;
+    if (!stream_running && stream_start() == 0) {
+        stream_running = 1;
+    }
+    stream_exit();
+    return s;
+}
+
+
+void dsp_stream_close(dsp_stream *s)
+{
+    if (s == NULL) {
+        return;
+    }
+    stream_enter();
+    for (dsp_stream **p = &stream_list; *p; p = &(*p)->next) {
+        if (*p == s) {
+            *p = s->next;
+            break;
+        }
+    }
+    stream_exit();
+
+    audiofile_close(&s->file);
+    free(s->ring);
+    free(s);
+}
+
+
+size_t dsp_stream_read(dsp_stream *s, float *out, size_t frames)
+{
+    size_t ready = stream_ready(s);
+    size_t n = frames < ready ? frames : ready;
+    size_t done = 0;
+
+    while (done < n) {
+        size_t offset = s->tail & (s->size - 1);
+        size_t part = n - done;
+        if (part > s->size - offset) {
+            part = s->size - offset;
+        }
+        memcpy(out + done * s->channels, s->ring + offset * s->channels, part * s->channels * sizeof(float));
+        stream_consume(s, part);
+        done += part;
+    }
+    memset(out + n * s->channels, 0, (frames - n) * s->channels * sizeof(float));
+    return n;
+}
+
+
+size_t dsp_stream_read_double(dsp_stream *s, double *out, size_t frames)
+{
+    size_t ready = stream_ready(s);
+    size_t n = frames < ready ? frames : ready;
+    size_t done = 0;
+
+    while (done < n) {
+        size_t offset = s->tail & (s->size - 1);
+        size_t part = n - done;
+        const float *src;
+        if (part > s->size - offset) {
+            part = s->size - offset;
+        }
+        src = s->ring + offset * s->channels;
+        for (size_t i = 0; i < part * s->channels; i++) {
+            out[done * s->channels + i] = src[i];
+        }
+        stream_consume(s, part);
+        done += part;
+    }
+    memset(out + n * s->channels, 0, (frames - n) * s->channels * sizeof(double));
+    return n;
+}
+
+
+const float *dsp_stream_peek(dsp_stream *s, size_t *frames)
+{
+    size_t ready = stream_ready(s);
+    size_t offset = s->tail & (s->size - 1);
+
+    *frames = ready < s->size - offset ? ready : s->size - offset;
+    return s->ring + offset * s->channels;
+}
+
+
+void dsp_stream_advance(dsp_stream *s, size_t frames)
+{
+    size_t ready = stream_ready(s);
+    stream_consume(s, frames < ready ? frames : ready);
+}
+
+
+void dsp_stream_seek(dsp_stream *s, size_t frame)
+{
+    s->seek_frame = frame;
+    s->played = frame < s->frames ? frame : s->frames;
+    stream_store(&s->seek_epoch, s->seek_epoch + 1);
+}
+
+
+void dsp_stream_loop(dsp_stream *s, int loop)
+{
+    stream_store(&s->looping, loop ? 1 : 0);
+}
+
+
+int dsp_stream_done(dsp_stream *s)
+{
+    return stream_load(&s->acked) == s->seek_epoch && stream_load(&s->ended) && stream_ready(s) == 0;
+}
+
+
+size_t dsp_stream_frames(const dsp_stream *s)
+{
+    return s->frames;
+}
+
+
+int dsp_stream_channels(const dsp_stream *s)
+{
+    return s->channels;
+}
+
+
+double dsp_stream_samplerate(const dsp_stream *s)
+{
+    return s->file.samplerate;
+}
+
+
+size_t dsp_stream_position(const dsp_stream *s)
+{
+    return s->played;
+}
@@ -1,16 +1,11 @@
 local ffi = require 'ffi'
 
-local dsp = ffi.load"./libdsp.dylib"
+-- resolve the module and the library built by cmake into the package
+local ext = (ffi.os == "OSX" and "dylib") or (ffi.os == "Windows" and "dll") or "so"
+LIBDSP_PATH = "../../../support/libdsp." .. ext
+package.path = package.path .. ";../../../examples/?.lua"
 
-ffi.cdef[[
-double scale_linear(double x, double in_min, double in_max, double out_min, double out_max);
-double scale_sine1(double x, double in_min, double in_max, double out_min, double out_max);
-double scale_sine2(double x, double in_min, double in_max, double out_min, double out_max);
-double scale_exp1(double x, double s, double in_min, double in_max, double out_min, double out_max);
-double scale_exp2(double x, double s, double in_min, double in_max, double out_min, double out_max);
-double scale_log1(double x, double p, double i_min, double i_max, double o_min, double o_max);
-double scale_log2(double x, double p, double i_min, double i_max, double o_min, double o_max);
-]]
+local dsp = require 'libdsp'
 
 
 
@@ -23,3 +18,276 @@ print(   dsp.scale_exp2(  	50,   2,   1,      127,    1,     100))
 print(   dsp.scale_log1(  	50,   2,   1,      127,    1,     100))
 print(   dsp.scale_log2(  	50,   2,   1,      127,    1,     100))
 
+
+-- store
+local view, n = dsp.store.publish("test.table", {1, 2, 3})
+assert(n == 3 and view[2] == 3)
+local same, m = dsp.store.lookup("test.table")
+assert(same == view and m == 3)
+assert(dsp.store.lookup("test.missing") == nil)
+print("store ok")
+
+
+-- stream
+local function u32(v) return string.char(v % 256, math.floor(v / 256) % 256, math.floor(v / 65536) % 256, math.floor(v / 16777216)) end
+local function u16(v) return string.char(v % 256, math.floor(v / 256)) end
+local function be32(v) return u32(v):reverse() end
+local function be16(v) return u16(v):reverse() end
+
+-- headers with no channels or no bytes per sample are rejected, not divided by,
+-- and so is an extensible fmt chunk cut off before its subformat
+local bad = {
+   { "RIFF", u32(44), "WAVE", "fmt ", u32(16), u16(1), u16(0), u32(48000), u32(0), u16(0), u16(16), "data", u32(8), ("\0"):rep(8) },
+   { "RIFF", u32(44), "WAVE", "fmt ", u32(16), u16(1), u16(1), u32(48000), u32(0), u16(0), u16(4), "data", u32(8), ("\0"):rep(8) },
+   { "FORM", be32(46), "AIFF", "COMM", be32(18), be16(0), be32(2), be16(16), ("\0"):rep(10),
+     "SSND", be32(12), be32(0), be32(0), ("\0"):rep(4) },
+   { "RIFF", u32(28), "WAVE", "fmt ", u32(40), u16(0xFFFE), u16(1), u32(48000), u32(96000), u16(2), u16(16) },
+}
+for _, parts in ipairs(bad) do
+   local path = os.tmpname()
+   local f = assert(io.open(path, "wb"))
+   f:write(table.concat(parts))
+   f:close()
+   assert(not pcall(dsp.stream.open, path))
+   assert(dsp.cache.load(path) == nil)
+   os.remove(path)
+end
+
+local wav = os.tmpname()
+do
+   local f = assert(io.open(wav, "wb"))
+   local frames = 1000
+   f:write("RIFF", u32(36 + frames * 2), "WAVE", "fmt ", u32(16), u16(1), u16(1), u32(48000), u32(96000), u16(2), u16(16))
+   f:write("data", u32(frames * 2))
+   for i = 0, frames - 1 do
+      f:write(u16(i))
+   end
+   f:close()
+end
+local s = dsp.stream.open(wav)
+assert(s.frames == 1000 and s.channels == 1 and s.samplerate == 48000)
+for i = 0, 999 do
+   assert(s:tick() == i / 32768)
+end
+s:seek(10)
+local y = 0
+while y == 0 do y = s:tick() end
+assert(y == 10 / 32768)
+s = nil
+collectgarbage()
+print("stream ok")
+
+-- cache
+local c, frames, channels, sr = dsp.cache.load(wav)
+assert(frames == 1000 and channels == 1 and sr == 48000 and c[5] == 5 / 32768)
+assert(dsp.cache.load(wav) == c)
+do
+   -- a copy shares the entry, a file differing in one sample does not
+   local data = assert(io.open(wav, "rb")):read("*a")
+   local copy, other = os.tmpname(), os.tmpname()
+   for path, contents in pairs{ [copy] = data, [other] = data:sub(1, -2) .. "\1" } do
+      local f = assert(io.open(path, "wb"))
+      f:write(contents)
+      f:close()
+   end
+   assert(dsp.cache.load(copy) == c and dsp.cache.load(copy) == c)
+   local o = dsp.cache.load(other)
+   assert(o ~= nil and o ~= c and o[999] ~= c[999])
+   o = nil
+   os.remove(copy)
+   os.remove(other)
+end
+local t, n = dsp.cache.publish("test.ramp", {0, 1, 2, 3})
+assert(n == 4 and t[3] == 3)
+local u = dsp.cache.get("test.ramp")
+assert(u == t and dsp.cache.get("test.missing") == nil)
+c, t, u = nil, nil, nil
+collectgarbage()
+dsp.cache.limit(0)
+assert(dsp.cache.usage() == 0 and dsp.cache.get("test.ramp") == nil)
+os.remove(wav)
+print("cache ok")
+
+
+-- conv
+local ffi = require 'ffi'
+local c = dsp.conv.new({ 1, 0.5, 0.25 }, nil, { block = 4 })
+local x, y = ffi.new("double[8]"), ffi.new("double[8]")
+x[0] = 1
+c:process(x, y, 8)
+assert(math.abs(y[0] - 1) < 1e-6 and math.abs(y[1] - 0.5) < 1e-6 and math.abs(y[2] - 0.25) < 1e-6 and math.abs(y[3]) < 1e-6)
+
+-- the tail thread sums the same partitions as the direct path, given time
+ffi.cdef "int usleep(unsigned int usec);"
+local ir, seed = {}, 7
+for i = 1, 4096 do
+   seed = (seed * 16807) % 2147483647
+   ir[i] = (seed / 2147483647 - 0.5) * math.exp(-4 * i / 4096)
+end
+-- (one thread serves them all, and is started again after the last is freed)
+local direct = dsp.conv.new(ir, nil, { block = 64 })
+local xin, yd, yt = ffi.new("double[64]"), ffi.new("double[64]"), ffi.new("double[64]")
+for round = 1, 2 do
+   local threaded = { dsp.conv.new(ir, nil, { block = 64, threaded = true }),
+                      dsp.conv.new(ir, nil, { block = 64, threaded = true }) }
+   local err = 0
+   for b = 1, 200 do
+      for i = 0, 63 do
+         seed = (seed * 16807) % 2147483647
+         xin[i] = seed / 2147483647 - 0.5
+      end
+      direct:process(xin, yd, 64)
+      for _, t in ipairs(threaded) do
+         t:process(xin, yt, 64)
+         for i = 0, 63 do
+            err = math.max(err, math.abs(yd[i] - yt[i]))
+         end
+      end
+      if b == 100 then    -- the other one keeps going
+         table.remove(threaded)
+         collectgarbage()
+      end
+      ffi.C.usleep(2000)  -- an audio vector's worth of time for the tail
+   end
+   local t = threaded[1]
+   assert(t:misses() == 0 and err < 1e-5, ("misses %d, error %g"):format(t:misses(), err))
+   direct = dsp.conv.new(ir, nil, { block = 64 })
+   threaded = nil
+   collectgarbage()
+end
+print("conv ok")
+
+-- stft
+for _, opts in ipairs({ {}, { polar = true }, { spread = true }, { polar = true, spread = true } }) do
+   local s = dsp.stft.new{ size = 256, hop = 64, polar = opts.polar, spread = opts.spread }
+   local n = 2048
+   local x, y = ffi.new("double[?]", n), ffi.new("double[?]", n)
+   for i = 0, n - 1 do x[i] = math.sin(i * 0.05) + 0.3 * math.sin(i * 0.71) end
+   local hops, done = 0, 0
+   while done < n do
+      local k = math.min(37, n - done)
+      s:process(x + done, y + done, k, function(a, b, bins) hops = hops + 1 end)
+      done = done + k
+   end
+   -- spread: the frame of the last boundary is still to be computed
+   assert(s.latency == (opts.spread and 320 or 256) and hops == n / 64 - (opts.spread and 1 or 0))
+   for i = s.latency, n - 1 do
+      assert(math.abs(y[i] - x[i - s.latency]) < 1e-4)
+   end
+end
+print("stft ok")
+
+-- pvoc
+for _, spread in ipairs({ false, true }) do
+   local p = dsp.pvoc.new{ size = 256, hop = 64, spread = spread }
+   local n = 2048
+   local x, y = ffi.new("double[?]", n), ffi.new("double[?]", n)
+   for i = 0, n - 1 do x[i] = math.sin(i * 0.1) end
+   for i = 0, n - 1, 16 do p:process(x + i, y + i, 16) end  -- 4 vectors per hop
+   assert(p.latency == (spread and 320 or 256))
+   for i = p.latency, n - 1 do
+      assert(math.abs(y[i] - x[i - p.latency]) < 1e-4)
+   end
+   p:ratio(2)
+   p:process(x, y, n)
+   local crossings = 0
+   for i = n / 2 + 1, n - 1 do
+      if y[i - 1] < 0 and y[i] >= 0 then crossings = crossings + 1 end
+   end
+   assert(math.abs(crossings - 2 * 0.1 * (n / 2) / (2 * math.pi)) <= 2)
+end
+print("pvoc ok")
+
+-- oscbank
+-- (the second bank follows SAMPLE_RATE, which the externals set)
+local y = ffi.new("double[256]")
+SAMPLE_RATE = 44100
+for _, b in ipairs{ dsp.oscbank.new(2, { samplerate = 48000 }), dsp.oscbank.new(2) } do
+   SAMPLE_RATE = 48000
+   b.freq[0], b.amp[0] = 1000, 1
+   b.freq[1], b.amp[1] = 3000, 0.5
+   b:render(y, 256)   -- amplitudes ramp up
+   b:render(y, 256)
+   for i = 0, 255 do
+      local t = (256 + i) / 48000
+      assert(math.abs(y[i] - math.sin(2 * math.pi * 1000 * t) - 0.5 * math.sin(2 * math.pi * 3000 * t)) < 1e-4)
+   end
+   SAMPLE_RATE = 44100
+end
+SAMPLE_RATE = nil
+local b = dsp.oscbank.new(2, { samplerate = 48000 })
+b:shape(0, "saw")
+b:table(1, { 0, 1, 0, -1 })
+b:render(y, 256)
+-- 0 Hz (the default of BLOCKS.saw and BLOCKS.square) stays finite
+for _, shape in ipairs{ "sine", "saw", "square", "triangle" } do
+   local z = dsp.oscbank.new(1, { shape = shape })
+   z.amp[0] = 1
+   z:render(y, 256)
+   z:phase(0, 0.25)
+   z:render(y + 128, 128)
+   for i = 0, 255 do
+      assert(y[i] == y[i] and math.abs(y[i]) <= 1)
+   end
+end
+print("oscbank ok")
+
+-- math
+local tol = { fast = 1e-3, medium = 1e-6, precise = 1e-12 }
+local x, y = ffi.new("double[100]"), ffi.new("double[100]")
+for i = 0, 99 do x[i] = (i - 50) * 0.13 end
+for tier, e in pairs(tol) do
+   local fm = dsp.math[tier]
+   fm.sin_n(y, x, 100)
+   for i = 0, 99 do
+      assert(math.abs(y[i] - math.sin(x[i])) < e and math.abs(fm.sin(x[i]) - y[i]) < 1e-15)
+   end
+   fm.tanh_n(y, x, 100)
+   for i = 0, 99 do
+      local t = (math.exp(2 * x[i]) - 1) / (math.exp(2 * x[i]) + 1)
+      assert(math.abs(y[i] - t) < e)
+   end
+   assert(math.abs(fm.db_to_lin(-6) / 10 ^ (-6 / 20) - 1) < e)
+   assert(math.abs(fm.lin_to_db(0.5) - 20 * math.log10(0.5)) < 10 * e)
+   assert(math.abs(fm.pow(3, 2.5) / 3 ^ 2.5 - 1) < e)
+end
+assert(dsp.math.fast.log2(0) == -math.huge and dsp.math.fast.exp2(-2000) == 0)
+print("math ok")
+
+-- noise
+local n = 4096
+local a, b = ffi.new("double[?]", n), ffi.new("double[?]", n)
+local g1, g2 = dsp.noise.new(7), dsp.noise.new(7)
+for _, kind in ipairs{ "uniform", "gaussian", "pink", "brown" } do
+   g1:seed(7)
+   g2:seed(7)
+   g1[kind](g1, a, n)
+   local i = 0
+   while i < n do      -- the same sequence in odd block sizes
+      local m = math.min(n - i, 1 + i % 37)
+      g2:fill(kind, b + i, m)
+      i = i + m
+   end
+   local sum, sq = 0, 0
+   for i = 0, n - 1 do
+      assert(a[i] == b[i])
+      sum, sq = sum + a[i], sq + a[i] * a[i]
+   end
+   if kind == "uniform" then
+      assert(math.abs(sum / n) < 0.05 and math.abs(sq / n - 1 / 3) < 0.03)
+   elseif kind == "gaussian" then
+      assert(math.abs(sum / n) < 0.1 and math.abs(sq / n - 1) < 0.1)
+   end
+end
+g1:seed(7)
+g1:uniform(a, n)
+g2:seed(8)
+g2:uniform(b, n)
+local c = 0
+for i = 0, n - 1 do c = c + a[i] * b[i] end
+assert(math.abs(c / n) < 0.03)
+assert(g1:next() >= -1)
+-- unseeded generators (one per instance, each in its own lua state) differ
+local u1, u2 = dsp.noise.new(), dsp.noise.new()
+assert(u1:next() ~= u2:next())
+print("noise ok")
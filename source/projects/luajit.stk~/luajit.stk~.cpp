@@ -3,85 +3,38 @@
     luajit.stk~: luajit+stk for Max
 */
 
-#include "ADSR.h"
-#include "Asymp.h"
-#include "BandedWG.h"
-#include "BeeThree.h"
-#include "BiQuad.h"
-#include "Blit.h"
-#include "BlitSaw.h"
-#include "BlitSquare.h"
-#include "BlowBotl.h"
-#include "BlowHole.h"
-#include "BowTable.h"
-#include "Bowed.h"
-#include "Brass.h"
-#include "Chorus.h"
-#include "Clarinet.h"
-#include "Cubic.h"
-#include "Delay.h"
-#include "DelayA.h"
-#include "DelayL.h"
-#include "Drummer.h"
-#include "Echo.h"
-#include "Envelope.h"
-#include "FMVoices.h"
-#include "Flute.h"
-#include "FormSwep.h"
-#include "FreeVerb.h"
-#include "Granulate.h"
-#include "Guitar.h"
-#include "HevyMetl.h"
-#include "JCRev.h"
-#include "JetTable.h"
-#include "LentPitShift.h"
-#include "Mandolin.h"
-#include "Mesh2D.h"
-#include "Modulate.h"
-#include "Moog.h"
-#include "NRev.h"
-#include "Noise.h"
-#include "OnePole.h"
-#include "OneZero.h"
-#include "PRCRev.h"
-#include "PercFlut.h"
-#include "PitShift.h"
-#include "Plucked.h"
-#include "PoleZero.h"
-#include "Recorder.h"
-#include "ReedTable.h"
-#include "Resonate.h"
-#include "Rhodey.h"
-#include "Saxofony.h"
-#include "Shakers.h"
-#include "Simple.h"
-#include "SineWave.h"
-#include "SingWave.h"
-#include "Sitar.h"
-#include "Sphere.h"
-#include "StifKarp.h"
-#include "TapDelay.h"
-#include "TubeBell.h"
-#include "Twang.h"
-#include "TwoPole.h"
-#include "TwoZero.h"
-#include "VoicForm.h"
-#include "Voicer.h"
-#include "Whistle.h"
-#include "Wurley.h"
-
 #include <cstdlib>
+#include <cstring>
 
 #include "ext.h"
 #include "ext_obex.h"
 #include "z_dsp.h"
 
 #include "lua.hpp"
-#include <LuaBridge.h>
+
+#include "libdsp.h"
+#include "bccache.h"
+#include "embedded.h"
+#include "idle.h"
+#include "blockops.h"
+#include "params.h"
+#include "events.h"
+#include "sched.h"
+#include "midi.h"
+#include "buffers.h"
+#include "retire.h"
+
+#include "stk_bindings.h"
 
 #include <libgen.h>
 #include <unistd.h>
 
+#define LSTK_LAZY_BINDINGS 1    // register stk classes on first access
+
+// lua block functions (registered in BLOCKS, e.g. by dsp_graph.lua) are called
+// once per vector as fn(in, out, frames, param0, ..., param3) with in/out as
+// lightuserdata
+
 enum {
     PARAM0 = 0, 
     PARAM1,
@@ -101,6 +54,25 @@ typedef struct _lstk {
     double param2;      // parameter 2
     double param3;      // parameter 3 (rightmost)
     double v1;          // historical value;
+    int block_ref;      // registry ref of BLOCKS[funcname] (or LUA_NOREF)
+    t_idle idle;        // `sleep` on silent input
+    double samplerate;
+    double samplerate_applied; // rate last set in SAMPLE_RATE
+    long sanitize;      // replace non-finite output and reset the feedback state
+    long stat_vectors;  // vectors processed (for `stats`)
+    long stat_slept;    // vectors skipped by `sleep`
+    long stat_incidents; // vectors with non-finite output
+    long stat_nonfinite; // non-finite samples replaced
+    t_params params;    // named parameters declared by the script (P in lua)
+    t_events *events;   // timestamped `event` messages for perform
+    int64_t clock;      // sample time of the next vector
+    t_sched *sched;     // coroutines started with spawn() in lua
+    t_midi *midi;       // parsed `midi` messages for perform
+    t_midi_parser midi_parser[2]; // running status of the main and the scheduler thread
+    t_midi_event midi_batch[MIDI_BATCH_MAX]; // messages of the current vector, read by on_midi
+    t_buffers *buffers; // buffer~ objects bound by the script
+    void *latency_out;  // `latency` in samples
+    t_retire retire;    // replaced block refs perform may still use
     long m_in;          // space for the inlet number used by all of the proxies
     void *inlets[MAX_INLET_INDEX];
 } t_lstk;
@@ -109,11 +81,22 @@ typedef struct _lstk {
 // method prototypes
 void *lstk_new(t_symbol *s, long argc, t_atom *argv);
 void lstk_init_lua(t_lstk *x);
+void lstk_init_package(t_lstk *x);
 void lstk_free(t_lstk *x);
+t_max_err lstk_notify(t_lstk *x, t_symbol *s, t_symbol *msg, void *sender, void *data);
 void lstk_assist(t_lstk *x, void *b, long m, long a, char *s);
 void lstk_bang(t_lstk *x);
 void lstk_anything(t_lstk* x, t_symbol* s, long argc, t_atom* argv);
 void lstk_float(t_lstk *x, double f);
+void lstk_resolve(t_lstk *x);
+void lstk_block_release(void *ctx, void *ptr);
+void lstk_sleep(t_lstk *x, t_symbol *s, long argc, t_atom *argv);
+void lstk_sanitize(t_lstk *x, long n);
+void lstk_stats(t_lstk *x);
+void lstk_latency(t_lstk *x);
+void lstk_set(t_lstk *x, t_symbol *s, long argc, t_atom *argv);
+void lstk_event(t_lstk *x, t_symbol *s, long argc, t_atom *argv);
+void lstk_midi(t_lstk *x, t_symbol *s, long argc, t_atom *argv);
 void lstk_dsp64(t_lstk *x, t_object *dsp64, short *count, double samplerate, long maxvectorsize, long flags);
 void lstk_perform64(t_lstk *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
 
@@ -140,7 +123,7 @@ int run_lua_string(t_lstk *x, const char* code)
 int run_lua_file(t_lstk *x, const char* path)
 {
     int err;
-    err = luaL_dofile(x->L, path);
+    err = bccache_loadfile(x->L, path) || lua_pcall(x->L, 0, LUA_MULTRET, 0);
     if (err) {
         error("%s", lua_tostring(x->L, -1));
         lua_pop(x->L, 1);  /* pop error message from the stack */
@@ -148,6 +131,68 @@ int run_lua_file(t_lstk *x, const char* path)
     return 0; 
 }
 
+void lua_dsp_block(t_lstk *x, int ref, double *in, double *out, long frames)
+{
+    lua_rawgeti(x->L, LUA_REGISTRYINDEX, ref);
+    lua_pushlightuserdata(x->L, in);
+    lua_pushlightuserdata(x->L, out);
+    lua_pushnumber(x->L, frames);
+    lua_pushnumber(x->L, x->param0);
+    lua_pushnumber(x->L, x->param1);
+    lua_pushnumber(x->L, x->param2);
+    lua_pushnumber(x->L, x->param3);
+    if (lua_pcall(x->L, 7, 0, 0)) {
+        // keep the error visible but don't take the audio thread down
+        error("%s", lua_tostring(x->L, -1));
+        lua_pop(x->L, 1);
+        memset(out, 0, frames * sizeof(double));
+    }
+}
+
+// EVENTS[name](args...) at the event's sample
+void lua_dsp_event(t_lstk *x, const t_event *ev)
+{
+    lua_getglobal(x->L, "EVENTS");
+    if (lua_istable(x->L, -1)) {
+        lua_getfield(x->L, -1, ev->name);
+        if (lua_isfunction(x->L, -1)) {
+            for (int i = 0; i < ev->argc; i++) {
+                lua_pushnumber(x->L, ev->argv[i]);
+            }
+            if (lua_pcall(x->L, ev->argc, 0, 0)) {
+                error("%s", lua_tostring(x->L, -1));
+                lua_pop(x->L, 1);
+            }
+        } else {
+            lua_pop(x->L, 1);
+        }
+    }
+    lua_pop(x->L, 1);
+}
+
+// on_midi(events, count) once per vector: events is lightuserdata pointing at
+// count t_midi_event (see dsp_midi.lua)
+void lua_dsp_midi(t_lstk *x, t_midi_event *batch, long count)
+{
+    lua_getglobal(x->L, "on_midi");
+    if (lua_isfunction(x->L, -1)) {
+        lua_pushlightuserdata(x->L, batch);
+        lua_pushnumber(x->L, count);
+        if (lua_pcall(x->L, 2, 0, 0)) {
+            error("%s", lua_tostring(x->L, -1));
+            lua_pop(x->L, 1);
+        }
+    } else {
+        lua_pop(x->L, 1);
+    }
+}
+
+// error of a coroutine started with spawn()
+void lua_dsp_report(void *ctx, const char *msg)
+{
+    error("%s", msg);
+}
+
 float lua_dsp(t_lstk *x, float audio_in, float audio_prev, float n_samples, 
                          float param0, float param1, float param2, float param3)
 {
@@ -223,8 +268,16 @@ void ext_main(void *r)
     class_addmethod(c, (method)lstk_float,    "float",    A_FLOAT, 0);
     class_addmethod(c, (method)lstk_anything, "anything", A_GIMME, 0);
     class_addmethod(c, (method)lstk_bang,     "bang",              0);
+    class_addmethod(c, (method)lstk_sleep,    "sleep",    A_GIMME, 0);
+    class_addmethod(c, (method)lstk_sanitize, "sanitize", A_LONG,  0);
+    class_addmethod(c, (method)lstk_stats,    "stats",             0);
+    class_addmethod(c, (method)lstk_latency,  "latency",           0);
+    class_addmethod(c, (method)lstk_set,      "set",      A_GIMME, 0);
+    class_addmethod(c, (method)lstk_event,    "event",    A_GIMME, 0);
+    class_addmethod(c, (method)lstk_midi,     "midi",     A_GIMME, 0);
     class_addmethod(c, (method)lstk_dsp64,    "dsp64",    A_CANT,  0);
     class_addmethod(c, (method)lstk_assist,   "assist",   A_CANT,  0);
+    class_addmethod(c, (method)lstk_notify,   "notify",   A_CANT,  0);
 
     class_dspinit(c);
     class_register(CLASS_BOX, c);
@@ -234,6 +287,7 @@ void ext_main(void *r)
 
 void lstk_run_file(t_lstk *x)
 {
+    sched_clear(x->sched);          // the script starts its sequences again
     if (x->filename != gensym("")) {
         char norm_path[MAX_PATH_CHARS];
         path_nameconform(x->filename->s_name, norm_path, 
@@ -249,6 +303,43 @@ void lstk_run_file(t_lstk *x)
             run_lua_file(x, lua_file);
         }
     }    
+    if (params_declare(&x->params, x->L) != 0) {
+        error("%s", lua_tostring(x->L, -1));
+        lua_pop(x->L, 1);
+    }
+    lstk_resolve(x);
+}
+
+
+void lstk_resolve(t_lstk *x)
+{
+    int ref = LUA_NOREF;
+    int old = x->block_ref;
+
+    lua_getglobal(x->L, "BLOCKS");
+    if (lua_istable(x->L, -1)) {
+        lua_getfield(x->L, -1, x->funcname->s_name);
+        if (lua_isfunction(x->L, -1)) {
+            ref = luaL_ref(x->L, LUA_REGISTRYINDEX);
+        } else {
+            lua_pop(x->L, 1);
+        }
+    }
+    lua_pop(x->L, 1);
+
+    // perform reads block_ref once per segment, so a single store switches it
+    // over; the replaced closure stays referenced until no vector can be
+    // running it
+    x->block_ref = ref;
+    if (old != LUA_NOREF) {
+        retire_push(&x->retire, lstk_block_release, x->L, (void *)(intptr_t)old);
+    }
+}
+
+
+void lstk_block_release(void *ctx, void *ptr)
+{
+    luaL_unref((lua_State *)ctx, LUA_REGISTRYINDEX, (int)(intptr_t)ptr);
 }
 
 
@@ -260,12 +351,31 @@ void *lstk_new(t_symbol *s, long argc, t_atom *argv)
         dsp_setup((t_pxobject *)x, 1);  // MSP inlets: arg is # of inlets and is REQUIRED!
         // use 0 if you don't need inlets
 
+        x->latency_out = outlet_new(x, NULL);  // created first: outlets are added right to left
         outlet_new(x, "signal");        // signal outlet (note "signal" rather than NULL)
         x->param0 = 0.0;
         x->param1 = 0.0;
         x->param2 = 0.0;
         x->param3 = 0.0;
         x->v1 = 0.0;
+        x->block_ref = LUA_NOREF;
+        retire_init(&x->retire);
+        x->samplerate = sys_getsr();
+        x->samplerate_applied = x->samplerate;
+        idle_init(&x->idle);
+        x->sanitize = 1;
+        x->stat_vectors = 0;
+        x->stat_slept = 0;
+        x->stat_incidents = 0;
+        x->stat_nonfinite = 0;
+        params_init(&x->params);
+        x->events = events_new(256);
+        x->sched = sched_new();
+        x->midi = midi_new(1024);
+        midi_parser_init(&x->midi_parser[0]);
+        midi_parser_init(&x->midi_parser[1]);
+        x->buffers = buffers_new((t_object *)x);
+        x->clock = 0;
         x->filename = atom_getsymarg(0, argc, argv); // 1st arg of object
         x->funcname = gensym("base");
         post("load: %s", x->filename->s_name);
@@ -283,20 +393,36 @@ void *lstk_new(t_symbol *s, long argc, t_atom *argv)
 
 void lstk_free(t_lstk *x)
 {
-    lua_close(x->L);
     dsp_free((t_pxobject *)x);
+    retire_flush(&x->retire);
+    params_free(&x->params);
+    lua_close(x->L);
+    events_free(x->events);
+    sched_free(x->sched);
+    midi_free(x->midi);
+    buffers_free(x->buffers);
     for(int i = (MAX_INLET_INDEX - 1); i > 0; i--) {
         object_free(x->inlets[i]);
     }
 }
 
 
+// keeps the buffer~ references of the script up to date
+t_max_err lstk_notify(t_lstk *x, t_symbol *s, t_symbol *msg, void *sender, void *data)
+{
+    return buffers_notify(x->buffers, s, msg, sender, data);
+}
+
+
 void lstk_assist(t_lstk *x, void *b, long m, long a, char *s)
 {
     if (m == ASSIST_INLET) { //inlet
         sprintf(s, "I am inlet %ld", a);
     }
-    else {  // outlet
+    else if (a == 1) {  // outlet
+        sprintf(s, "latency in samples, on `latency`");
+    }
+    else {
         sprintf(s, "I am outlet %ld", a);
     }
 }
@@ -312,6 +438,7 @@ void lstk_anything(t_lstk* x, t_symbol* s, long argc, t_atom* argv)
     if (s != gensym("")) {
         post("funcname: %s", s->s_name);
         x->funcname = s;
+        lstk_resolve(x);
     }
 }
 
@@ -343,29 +470,262 @@ void lstk_float(t_lstk *x, double f)
 }
 
 
+// sleep <hold ms> [threshold dBFS]: stop running lua once the input has been
+// silent for the hold time and the output has decayed, `sleep 0` turns it off
+void lstk_sleep(t_lstk *x, t_symbol *s, long argc, t_atom *argv)
+{
+    double hold_ms = argc > 0 ? atom_getfloat(argv) : 0.0;
+    double threshold_db = argc > 1 ? atom_getfloat(argv + 1) : -90.0;
+
+    idle_configure(&x->idle, hold_ms, threshold_db, x->samplerate);
+    if (hold_ms > 0.0) {
+        post("sleep: after %.0f ms below %.1f dB", hold_ms, threshold_db);
+    } else {
+        post("sleep: off");
+    }
+}
+
+
+void lstk_sanitize(t_lstk *x, long n)
+{
+    x->sanitize = n != 0;
+    post("sanitize: %s", x->sanitize ? "on" : "off");
+}
+
+
+// set <name> <value>: a parameter declared in the script's PARAMS
+void lstk_set(t_lstk *x, t_symbol *s, long argc, t_atom *argv)
+{
+    if (argc < 2 || atom_gettype(argv) != A_SYM) {
+        error("set: expects a parameter name and a value");
+        return;
+    }
+    t_symbol *name = atom_getsym(argv);
+    if (params_set(&x->params, name->s_name, atom_getfloat(argv + 1)) != 0) {
+        error("set: no parameter '%s' in PARAMS", name->s_name);
+    }
+}
+
+
+// event <name> [numbers...]: calls EVENTS[name](numbers...) in perform at the
+// sample matching the scheduler time the message arrived at (one vector later)
+void lstk_event(t_lstk *x, t_symbol *s, long argc, t_atom *argv)
+{
+    t_event ev;
+
+    if (argc < 1 || atom_gettype(argv) != A_SYM) {
+        error("event: expects a handler name");
+        return;
+    }
+    ev.name = atom_getsym(argv)->s_name;
+    ev.argc = 0;
+    for (long i = 1; i < argc && ev.argc < EVENTS_MAX_ARGS; i++) {
+        ev.argv[ev.argc++] = atom_getfloat(argv + i);
+    }
+
+    if (!sys_getdspstate()) {   // no perform to deliver it: run it now
+        lua_dsp_event(x, &ev);
+        return;
+    }
+    ev.time = events_time(x->events, gettime_forobject((t_object *)x));
+    if (events_push(x->events, &ev) != 0) {
+        error("event: queue full, dropped '%s'", ev.name);
+    }
+}
+
+
+// midi <bytes...>: raw midi bytes, one at a time (midiin) or whole messages
+// (e.g. from midiformat). Complete messages reach on_midi in perform with
+// their sample offset, one call per vector.
+void lstk_midi(t_lstk *x, t_symbol *s, long argc, t_atom *argv)
+{
+    // midiin delivers on the scheduler thread, messages from the patch on the
+    // main thread: each keeps its own running status
+    t_midi_parser *parser = &x->midi_parser[systhread_ismainthread() ? 0 : 1];
+    t_midi_event msg;
+
+    for (long i = 0; i < argc; i++) {
+        if (!midi_parse(parser, (uint8_t)atom_getlong(argv + i), &msg)) {
+            continue;
+        }
+        if (!sys_getdspstate()) {   // no perform to deliver it: run it now
+            x->midi_batch[0] = msg;
+            lua_dsp_midi(x, x->midi_batch, 1);
+            continue;
+        }
+        if (midi_push(x->midi, events_time(x->events, gettime_forobject((t_object *)x)), &msg) != 0) {
+            error("midi: queue full, dropped %d %d %d", msg.status, msg.data1, msg.data2);
+        }
+    }
+}
+
+
+void lstk_stats(t_lstk *x)
+{
+    post("stats: %ld vectors, %ld asleep, %ld with non-finite output (%ld samples replaced)",
+         x->stat_vectors, x->stat_slept, x->stat_incidents, x->stat_nonfinite);
+}
+
+
+// LATENCY[funcname] of the script: output delay in samples of a block
+// function, sent out of the right outlet
+void lstk_latency(t_lstk *x)
+{
+    double samples = 0.0;
+
+    lua_getglobal(x->L, "LATENCY");
+    if (lua_istable(x->L, -1)) {
+        lua_getfield(x->L, -1, x->funcname->s_name);
+        samples = lua_tonumber(x->L, -1);
+        lua_pop(x->L, 1);
+    }
+    lua_pop(x->L, 1);
+    post("latency: %ld samples (%.2f ms)", (long)samples,
+         x->samplerate > 0 ? samples * 1000.0 / x->samplerate : 0.0);
+    outlet_float(x->latency_out, samples);
+}
+
+
 void lstk_dsp64(t_lstk *x, t_object *dsp64, short *count, double samplerate, long maxvectorsize, long flags)
 {
     post("sample rate: %f", samplerate);
     post("maxvectorsize: %d", maxvectorsize);
 
+    x->samplerate = samplerate;
+    idle_samplerate(&x->idle, samplerate);
+    params_prepare(&x->params, samplerate, maxvectorsize);
+    stk_bindings_samplerate(samplerate);   // SAMPLE_RATE follows in perform
+
     object_method(dsp64, gensym("dsp_add64"), x, lstk_perform64, 0, NULL);
 }
 
 
-void lstk_perform64(t_lstk *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+// run the selected function over (part of) a vector: lua block or per sample
+void lstk_process(t_lstk *x, double *in, double *out, long frames)
 {
-    t_double *inL = ins[0];     // we get audio for each inlet of the object from the **ins argument
-    t_double *outL = outs[0];   // we get audio for each outlet of the object from the **outs argument
-    int n = sampleframes;       // n = 64
+    int n = frames;
     double v1 = x->v1;
+    int ref = x->block_ref;
+
+    if (ref != LUA_NOREF) {   // one lua call per vector
+        lua_dsp_block(x, ref, in, out, frames);
+        return;
+    }
 
     while (n--) {
-        v1 = lua_dsp(x, *inL++, v1, n, x->param0, x->param1, x->param2, x->param3);
-        *outL++ = v1;
+        v1 = lua_dsp(x, *in++, v1, n, x->param0, x->param1, x->param2, x->param3);
+        *out++ = v1;
     }
 
     x->v1 = v1;
+}
+
+
+void lstk_perform64(t_lstk *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    t_double *inL = ins[0];     // we get audio for each inlet of the object from the **ins argument
+    t_double *outL = outs[0];   // we get audio for each outlet of the object from the **outs argument
+    t_blockops_fpstate fp = blockops_ftz_enter();   // no denormals in feedback paths
+
+    int64_t start = x->clock;
+    long pos = 0;
+    long nmidi;
+    t_event ev;
+
+    events_clock(x->events, start, gettime_forobject((t_object *)x), x->samplerate, sampleframes);
+    params_tick(&x->params);
+    buffers_lock(x->buffers);
+
+    // the rate of dsp64, set between vectors so lua never sees it change under a running function
+    if (x->samplerate != x->samplerate_applied) {
+        lua_pushnumber(x->L, x->samplerate);
+        lua_setglobal(x->L, "SAMPLE_RATE");
+        x->samplerate_applied = x->samplerate;
+    }
+
+    // asleep: no lua calls, unless an event or midi is due or a sequence wakes up
+    if (!events_due(x->events, start + sampleframes) && !midi_due(x->midi, start + sampleframes)
+        && sched_next(x->sched) >= start + sampleframes && idle_before(&x->idle, inL, sampleframes)) {
+        memset(outL, 0, sampleframes * sizeof(double));
+        x->stat_slept++;
+    } else {
+        // all midi of the vector in one call, before it is processed
+        nmidi = midi_collect(x->midi, start, sampleframes, x->midi_batch);
+        if (nmidi) {
+            lua_dsp_midi(x, x->midi_batch, nmidi);
+        }
+
+        // split the vector where events are due and sequences wake up
+        for (;;) {
+            int64_t now = start + pos;
+            int64_t next;
+            long end = sampleframes;
+
+            while (events_next(x->events, now + 1, &ev)) {
+                lua_dsp_event(x, &ev);
+            }
+            sched_run(x->sched, x->L, now, lua_dsp_report, x);
+
+            next = sched_next(x->sched);
+            if (next < start + end) {
+                end = (long)(next - start);
+            }
+            if (events_peek(x->events, &next) && next < start + end) {
+                end = (long)(next - start);
+            }
+            lstk_process(x, inL + pos, outL + pos, end - pos);
+            pos = end;
+            if (pos >= sampleframes) {
+                break;
+            }
+        }
+        idle_after(&x->idle, outL, sampleframes);
+    }
+    buffers_unlock(x->buffers);
+    x->clock += sampleframes;
+    retire_vector(&x->retire);
+
+    // NaN/Inf must not stick in the feedback state
+    if (x->sanitize) {
+        long bad = blockops_sanitize(outL, sampleframes);
+        if (bad) {
+            x->v1 = 0.0;
+            x->stat_incidents++;
+            x->stat_nonfinite += bad;
+        }
+    }
+    x->stat_vectors++;
+    blockops_ftz_exit(fp);
+}
+
 
+void lstk_init_package(t_lstk *x)
+{
+    // make the package's lua modules and libdsp available to `require`
+    t_string* examples = get_path_from_package(lstk_class, "/examples/?.lua");
+    t_string* libdsp = get_path_from_package(lstk_class, "/support/" LIBDSP_FILENAME);
+    t_string* cache = get_path_from_package(lstk_class, "/cache");
+
+    lua_getglobal(x->L, "package");
+    lua_getfield(x->L, -1, "path");
+    lua_pushfstring(x->L, "%s;%s", lua_tostring(x->L, -1), string_getptr(examples));
+    lua_setfield(x->L, -3, "path");
+    lua_pop(x->L, 2);
+
+    lua_pushstring(x->L, string_getptr(libdsp));
+    lua_setglobal(x->L, "LIBDSP_PATH");
+
+    // stock modules are preloaded from bytecode linked into the external
+    embedded_install(x->L);
+
+    // scripts and other required modules are loaded through the bytecode cache
+    bccache_install(x->L, string_getptr(cache));
+    lua_pushstring(x->L, string_getptr(cache));
+    lua_setglobal(x->L, "CACHE_DIR");
+
+    object_free(examples);
+    object_free(libdsp);
+    object_free(cache);
 }
 
 
@@ -373,869 +733,18 @@ void lstk_init_lua(t_lstk *x)
 {
     x->L = luaL_newstate();
     luaL_openlibs(x->L);  /* opens the standard libraries */
+    lstk_init_package(x);
+    lua_pushnumber(x->L, x->samplerate_applied);
+    lua_setglobal(x->L, "SAMPLE_RATE");
+    stk_bindings_samplerate(x->samplerate);
 
-    luabridge::getGlobalNamespace(x->L)
-        .beginNamespace("stk")
-            .beginClass <stk::ADSR> ("ADSR")
-                .addConstructor<void ()> ()
-                .addFunction("keyOn", &stk::ADSR::keyOn)
-                .addFunction("keyOff", &stk::ADSR::keyOff)
-                .addFunction("setAttackRate", &stk::ADSR::setAttackRate)
-                .addFunction("setAttackTarget", &stk::ADSR::setAttackTarget)
-                .addFunction("setDecayRate", &stk::ADSR::setDecayRate)
-                .addFunction("setSustainLevel", &stk::ADSR::setSustainLevel)
-                .addFunction("setReleaseRate", &stk::ADSR::setReleaseRate)
-                .addFunction("setAttackTime", &stk::ADSR::setAttackTime)
-                .addFunction("setDecayTime", &stk::ADSR::setDecayTime)
-                .addFunction("setReleaseTime", &stk::ADSR::setReleaseTime)
-                .addFunction("setAllTimes", &stk::ADSR::setAllTimes)
-                .addFunction("setTarget", &stk::ADSR::setTarget)
-                .addFunction("getState", &stk::ADSR::getState)
-                .addFunction("setValue", &stk::ADSR::setValue)
-                .addFunction("lastOut", &stk::ADSR::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::ADSR::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::ADSR::tick))
-            .endClass()
-            .beginClass <stk::Asymp> ("Asymp")
-                .addConstructor<void ()> ()
-                .addFunction("keyOn", &stk::Asymp::keyOn)
-                .addFunction("keyOff", &stk::Asymp::keyOff)
-                .addFunction("setTau", &stk::Asymp::setTau)
-                .addFunction("setTime", &stk::Asymp::setTime)
-                .addFunction("setT60", &stk::Asymp::setT60)
-                .addFunction("setTarget", &stk::Asymp::setTarget)
-                .addFunction("setValue", &stk::Asymp::setValue)
-                .addFunction("getState", &stk::Asymp::getState)
-                .addFunction("lastOut", &stk::Asymp::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::Asymp::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Asymp::tick))
-            .endClass()
-            .beginClass <stk::BandedWG> ("BandedWG")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::BandedWG::clear)
-                .addFunction("setStrikePosition", &stk::BandedWG::setStrikePosition)
-                .addFunction("setPreset", &stk::BandedWG::setPreset)
-                .addFunction("setFrequency", &stk::BandedWG::setFrequency)
-                .addFunction("startBowing", &stk::BandedWG::startBowing)
-                .addFunction("stopBowing", &stk::BandedWG::stopBowing)
-                .addFunction("pluck", &stk::BandedWG::pluck)
-                .addFunction("noteOn", &stk::BandedWG::noteOn)
-                .addFunction("noteOff", &stk::BandedWG::noteOff)
-                .addFunction("controlChange", &stk::BandedWG::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::BandedWG::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BandedWG::tick))
-            .endClass()
-            .beginClass <stk::BeeThree> ("BeeThree")
-                .addConstructor<void ()> ()
-                .addFunction("noteOn", &stk::BeeThree::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::BeeThree::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BeeThree::tick))
-            .endClass()
-            .beginClass <stk::BiQuad> ("BiQuad")
-                .addConstructor<void ()> ()
-                .addFunction("ignoreSampleRateChange", &stk::BiQuad::ignoreSampleRateChange)
-                .addFunction("setCoefficients", &stk::BiQuad::setCoefficients)
-                .addFunction("setB0", &stk::BiQuad::setB0)
-                .addFunction("setB1", &stk::BiQuad::setB1)
-                .addFunction("setB2", &stk::BiQuad::setB2)
-                .addFunction("setA1", &stk::BiQuad::setA1)
-                .addFunction("setA2", &stk::BiQuad::setA2)
-                .addFunction("setResonance", &stk::BiQuad::setResonance)
-                .addFunction("setNotch", &stk::BiQuad::setNotch)
-                .addFunction("setLowPass", &stk::BiQuad::setLowPass)
-                .addFunction("setHighPass", &stk::BiQuad::setHighPass)
-                .addFunction("setBandPass", &stk::BiQuad::setBandPass)
-                .addFunction("setBandReject", &stk::BiQuad::setBandReject)
-                .addFunction("setAllPass", &stk::BiQuad::setAllPass)
-                .addFunction("setEqualGainZeroes", &stk::BiQuad::setEqualGainZeroes)
-                .addFunction("lastOut", &stk::BiQuad::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::BiQuad::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BiQuad::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::BiQuad::tick))
-            .endClass()
-            .beginClass <stk::Blit> ("Blit")
-                .addConstructor<void (*) (stk::StkFloat frequency)>()
-                .addFunction("reset", &stk::Blit::reset)
-                .addFunction("setPhase", &stk::Blit::setPhase)
-                .addFunction("getPhase", &stk::Blit::getPhase)
-                .addFunction("setFrequency", &stk::Blit::setFrequency)
-                .addFunction("setHarmonics", &stk::Blit::setHarmonics)
-                .addFunction("lastOut", &stk::Blit::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::Blit::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Blit::tick))
-            .endClass()
-            .beginClass <stk::BlitSaw> ("BlitSaw")
-                .addConstructor<void (*) (stk::StkFloat frequency)>()
-                .addFunction("reset", &stk::BlitSaw::reset)
-                .addFunction("setFrequency", &stk::BlitSaw::setFrequency)
-                .addFunction("setHarmonics", &stk::BlitSaw::setHarmonics)
-                .addFunction("lastOut", &stk::BlitSaw::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::BlitSaw::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlitSaw::tick))
-            .endClass()
-            .beginClass <stk::BlitSquare> ("BlitSquare")
-                .addConstructor<void (*) (stk::StkFloat frequency)>()
-                .addFunction("reset", &stk::BlitSquare::reset)
-                .addFunction("setPhase", &stk::BlitSquare::setPhase)
-                .addFunction("getPhase", &stk::BlitSquare::getPhase)
-                .addFunction("setFrequency", &stk::BlitSquare::setFrequency)
-                .addFunction("setHarmonics", &stk::BlitSquare::setHarmonics)
-                .addFunction("lastOut", &stk::BlitSquare::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::BlitSquare::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlitSquare::tick))
-            .endClass()
-            .beginClass <stk::BlowBotl> ("BlowBotl")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::BlowBotl::clear)
-                .addFunction("setFrequency", &stk::BlowBotl::setFrequency)
-                .addFunction("startBlowing", &stk::BlowBotl::startBlowing)
-                .addFunction("stopBlowing", &stk::BlowBotl::stopBlowing)
-                .addFunction("noteOn", &stk::BlowBotl::noteOn)
-                .addFunction("noteOff", &stk::BlowBotl::noteOff)
-                .addFunction("controlChange", &stk::BlowBotl::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::BlowBotl::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlowBotl::tick))
-            .endClass()
-            .beginClass <stk::BlowHole> ("BlowHole")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::BlowHole::clear)
-                .addFunction("setFrequency", &stk::BlowHole::setFrequency)
-                .addFunction("setTonehole", &stk::BlowHole::setTonehole)
-                .addFunction("setVent", &stk::BlowHole::setVent)
-                .addFunction("startBlowing", &stk::BlowHole::startBlowing)
-                .addFunction("stopBlowing", &stk::BlowHole::stopBlowing)
-                .addFunction("noteOn", &stk::BlowHole::noteOn)
-                .addFunction("noteOff", &stk::BlowHole::noteOff)
-                .addFunction("controlChange", &stk::BlowHole::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::BlowHole::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlowHole::tick))
-            .endClass()
-            .beginClass <stk::BowTable> ("BowTable")
-                .addConstructor<void ()> ()
-                .addFunction("setOffset", &stk::BowTable::setOffset)
-                .addFunction("setSlope", &stk::BowTable::setSlope)
-                .addFunction("setMinOutput", &stk::BowTable::setMinOutput)
-                .addFunction("setMaxOutput", &stk::BowTable::setMaxOutput)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::BowTable::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BowTable::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::BowTable::tick))
-            .endClass()
-            .beginClass <stk::Bowed> ("Bowed")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Bowed::clear)
-                .addFunction("setFrequency", &stk::Bowed::setFrequency)
-                .addFunction("setVibrato", &stk::Bowed::setVibrato)
-                .addFunction("startBowing", &stk::Bowed::startBowing)
-                .addFunction("stopBowing", &stk::Bowed::stopBowing)
-                .addFunction("noteOn", &stk::Bowed::noteOn)
-                .addFunction("noteOff", &stk::Bowed::noteOff)
-                .addFunction("controlChange", &stk::Bowed::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Bowed::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Bowed::tick))
-            .endClass()
-            .beginClass <stk::Brass> ("Brass")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Brass::clear)
-                .addFunction("setFrequency", &stk::Brass::setFrequency)
-                .addFunction("setLip", &stk::Brass::setLip)
-                .addFunction("startBlowing", &stk::Brass::startBlowing)
-                .addFunction("stopBlowing", &stk::Brass::stopBlowing)
-                .addFunction("noteOn", &stk::Brass::noteOn)
-                .addFunction("noteOff", &stk::Brass::noteOff)
-                .addFunction("controlChange", &stk::Brass::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Brass::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Brass::tick))
-            .endClass()
-            .beginClass <stk::Chorus> ("Chorus")
-                .addConstructor<void (*) (stk::StkFloat baseDelay)>()
-                .addFunction("clear", &stk::Chorus::clear)
-                .addFunction("setModDepth", &stk::Chorus::setModDepth)
-                .addFunction("setModFrequency", &stk::Chorus::setModFrequency)
-                .addFunction("lastOut", &stk::Chorus::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::Chorus::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Chorus::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Chorus::tick))
-            .endClass()
-            .beginClass <stk::Clarinet> ("Clarinet")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Clarinet::clear)
-                .addFunction("setFrequency", &stk::Clarinet::setFrequency)
-                .addFunction("startBlowing", &stk::Clarinet::startBlowing)
-                .addFunction("stopBlowing", &stk::Clarinet::stopBlowing)
-                .addFunction("noteOn", &stk::Clarinet::noteOn)
-                .addFunction("noteOff", &stk::Clarinet::noteOff)
-                .addFunction("controlChange", &stk::Clarinet::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Clarinet::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Clarinet::tick))
-            .endClass()
-            .beginClass <stk::Cubic> ("Cubic")
-                .addConstructor<void ()> ()
-                .addFunction("setA1", &stk::Cubic::setA1)
-                .addFunction("setA2", &stk::Cubic::setA2)
-                .addFunction("setA3", &stk::Cubic::setA3)
-                .addFunction("setGain", &stk::Cubic::setGain)
-                .addFunction("setThreshold", &stk::Cubic::setThreshold)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Cubic::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Cubic::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Cubic::tick))
-            .endClass()
-            .beginClass <stk::Delay> ("Delay")
-                .addConstructor<void (*) (unsigned long delay, unsigned long maxDelay)>()
-                .addFunction("getMaximumDelay", &stk::Delay::getMaximumDelay)
-                .addFunction("setMaximumDelay", &stk::Delay::setMaximumDelay)
-                .addFunction("setDelay", &stk::Delay::setDelay)
-                .addFunction("getDelay", &stk::Delay::getDelay)
-                .addFunction("tapOut", &stk::Delay::tapOut)
-                .addFunction("tapIn", &stk::Delay::tapIn)
-                .addFunction("addTo", &stk::Delay::addTo)
-                .addFunction("lastOut", &stk::Delay::lastOut)
-                .addFunction("nextOut", &stk::Delay::nextOut)
-                .addFunction("energy", &stk::Delay::energy)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Delay::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Delay::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Delay::tick))
-            .endClass()
-            .beginClass <stk::DelayA> ("DelayA")
-                .addConstructor<void (*) (stk::StkFloat delay, unsigned long maxDelay)>()
-                .addFunction("clear", &stk::DelayA::clear)
-                .addFunction("getMaximumDelay", &stk::DelayA::getMaximumDelay)
-                .addFunction("setMaximumDelay", &stk::DelayA::setMaximumDelay)
-                .addFunction("setDelay", &stk::DelayA::setDelay)
-                .addFunction("getDelay", &stk::DelayA::getDelay)
-                .addFunction("tapOut", &stk::DelayA::tapOut)
-                .addFunction("tapIn", &stk::DelayA::tapIn)
-                .addFunction("lastOut", &stk::DelayA::lastOut)
-                .addFunction("nextOut", &stk::DelayA::nextOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::DelayA::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::DelayA::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::DelayA::tick))
-            .endClass()
-            .beginClass <stk::DelayL> ("DelayL")
-                .addConstructor<void (*) (stk::StkFloat delay, unsigned long maxDelay)>()
-                .addFunction("getMaximumDelay", &stk::DelayL::getMaximumDelay)
-                .addFunction("setMaximumDelay", &stk::DelayL::setMaximumDelay)
-                .addFunction("setDelay", &stk::DelayL::setDelay)
-                .addFunction("getDelay", &stk::DelayL::getDelay)
-                .addFunction("tapOut", &stk::DelayL::tapOut)
-                .addFunction("tapIn", &stk::DelayL::tapIn)
-                .addFunction("lastOut", &stk::DelayL::lastOut)
-                .addFunction("nextOut", &stk::DelayL::nextOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::DelayL::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::DelayL::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::DelayL::tick))
-            .endClass()
-            .beginClass <stk::Drummer> ("Drummer")
-                .addConstructor<void ()> ()
-                .addFunction("noteOn", &stk::Drummer::noteOn)
-                .addFunction("noteOff", &stk::Drummer::noteOff)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Drummer::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Drummer::tick))
-            .endClass()
-            .beginClass <stk::Echo> ("Echo")
-                .addConstructor<void (*) (unsigned long maximumDelay)>()
-                .addFunction("clear", &stk::Echo::clear)
-                .addFunction("setMaximumDelay", &stk::Echo::setMaximumDelay)
-                .addFunction("setDelay", &stk::Echo::setDelay)
-                .addFunction("lastOut", &stk::Echo::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Echo::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Echo::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Echo::tick))
-            .endClass()
-            .beginClass <stk::Envelope> ("Envelope")
-                .addConstructor<void ()> ()
-                .addFunction("operator=", &stk::Envelope::operator=)
-                .addFunction("keyOn", &stk::Envelope::keyOn)
-                .addFunction("keyOff", &stk::Envelope::keyOff)
-                .addFunction("setRate", &stk::Envelope::setRate)
-                .addFunction("setTime", &stk::Envelope::setTime)
-                .addFunction("setTarget", &stk::Envelope::setTarget)
-                .addFunction("setValue", &stk::Envelope::setValue)
-                .addFunction("getState", &stk::Envelope::getState)
-                .addFunction("lastOut", &stk::Envelope::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::Envelope::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Envelope::tick))
-            .endClass()
-            .beginClass <stk::FMVoices> ("FMVoices")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::FMVoices::setFrequency)
-                .addFunction("noteOn", &stk::FMVoices::noteOn)
-                .addFunction("controlChange", &stk::FMVoices::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::FMVoices::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FMVoices::tick))
-            .endClass()
-            .beginClass <stk::Flute> ("Flute")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Flute::clear)
-                .addFunction("setFrequency", &stk::Flute::setFrequency)
-                .addFunction("setJetReflection", &stk::Flute::setJetReflection)
-                .addFunction("setEndReflection", &stk::Flute::setEndReflection)
-                .addFunction("setJetDelay", &stk::Flute::setJetDelay)
-                .addFunction("startBlowing", &stk::Flute::startBlowing)
-                .addFunction("stopBlowing", &stk::Flute::stopBlowing)
-                .addFunction("noteOn", &stk::Flute::noteOn)
-                .addFunction("noteOff", &stk::Flute::noteOff)
-                .addFunction("controlChange", &stk::Flute::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Flute::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Flute::tick))
-            .endClass()
-            .beginClass <stk::FormSwep> ("FormSwep")
-                .addConstructor<void ()> ()
-                .addFunction("ignoreSampleRateChange", &stk::FormSwep::ignoreSampleRateChange)
-                .addFunction("setResonance", &stk::FormSwep::setResonance)
-                .addFunction("setStates", &stk::FormSwep::setStates)
-                .addFunction("setTargets", &stk::FormSwep::setTargets)
-                .addFunction("setSweepRate", &stk::FormSwep::setSweepRate)
-                .addFunction("setSweepTime", &stk::FormSwep::setSweepTime)
-                .addFunction("lastOut", &stk::FormSwep::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::FormSwep::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FormSwep::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::FormSwep::tick))
-            .endClass()
-            .beginClass <stk::FreeVerb> ("FreeVerb")
-                .addConstructor<void ()> ()
-                .addFunction("setEffectMix", &stk::FreeVerb::setEffectMix)
-                .addFunction("setRoomSize", &stk::FreeVerb::setRoomSize)
-                .addFunction("getRoomSize", &stk::FreeVerb::getRoomSize)
-                .addFunction("setDamping", &stk::FreeVerb::setDamping)
-                .addFunction("getDamping", &stk::FreeVerb::getDamping)
-                .addFunction("setWidth", &stk::FreeVerb::setWidth)
-                .addFunction("getWidth", &stk::FreeVerb::getWidth)
-                .addFunction("setMode", &stk::FreeVerb::setMode)
-                .addFunction("getMode", &stk::FreeVerb::getMode)
-                .addFunction("clear", &stk::FreeVerb::clear)
-                .addFunction("lastOut", &stk::FreeVerb::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, stk::StkFloat, unsigned int>(&stk::FreeVerb::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FreeVerb::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::FreeVerb::tick))
-            .endClass()
-            .beginClass <stk::Granulate> ("Granulate")
-                .addConstructor<void ()> ()
-                .addConstructor<void (*) (unsigned int nVoices, std::string fileName, bool typeRaw)>()
-                .addFunction("openFile", &stk::Granulate::openFile)
-                .addFunction("reset", &stk::Granulate::reset)
-                .addFunction("setVoices", &stk::Granulate::setVoices)
-                .addFunction("setStretch", &stk::Granulate::setStretch)
-                .addFunction("setGrainParameters", &stk::Granulate::setGrainParameters)
-                .addFunction("setRandomFactor", &stk::Granulate::setRandomFactor)
-                .addFunction("lastOut", &stk::Granulate::lastOut)
-                .addFunction("tick",
-                    luabridge::overload<unsigned int>(&stk::Granulate::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Granulate::tick))
-            .endClass()
-            .beginClass <stk::Guitar> ("Guitar")
-                .addConstructor<void (*) (unsigned int nStrings, std::string bodyfile)>()
-                .addFunction("clear", &stk::Guitar::clear)
-                .addFunction("setBodyFile", &stk::Guitar::setBodyFile)
-                .addFunction("setPluckPosition", &stk::Guitar::setPluckPosition)
-                .addFunction("setLoopGain", &stk::Guitar::setLoopGain)
-                .addFunction("setFrequency", &stk::Guitar::setFrequency)
-                .addFunction("noteOn", &stk::Guitar::noteOn)
-                .addFunction("noteOff", &stk::Guitar::noteOff)
-                .addFunction("controlChange", &stk::Guitar::controlChange)
-                .addFunction("lastOut", &stk::Guitar::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Guitar::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Guitar::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Guitar::tick))
-            .endClass()
-            .beginClass <stk::HevyMetl> ("HevyMetl")
-                .addConstructor<void ()> ()
-                .addFunction("noteOn", &stk::HevyMetl::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::HevyMetl::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::HevyMetl::tick))
-            .endClass()
-            .beginClass <stk::JCRev> ("JCRev")
-                .addConstructor<void (*) (stk::StkFloat T60)>()
-                .addFunction("clear", &stk::JCRev::clear)
-                .addFunction("setT60", &stk::JCRev::setT60)
-                .addFunction("lastOut", &stk::JCRev::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::JCRev::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::JCRev::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::JCRev::tick))
-            .endClass()
-            .beginClass <stk::JetTable> ("JetTable")
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::JetTable::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::JetTable::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::JetTable::tick))
-            .endClass()
-            .beginClass <stk::LentPitShift> ("LentPitShift")
-                .addConstructor<void (*) (stk::StkFloat periodRatio, int tMax)>()
-                .addFunction("clear", &stk::LentPitShift::clear)
-                .addFunction("setShift", &stk::LentPitShift::setShift)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::LentPitShift::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::LentPitShift::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::LentPitShift::tick))
-            .endClass()
-            .beginClass <stk::Mandolin> ("Mandolin")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Mandolin::clear)
-                .addFunction("setDetune", &stk::Mandolin::setDetune)
-                .addFunction("setBodySize", &stk::Mandolin::setBodySize)
-                .addFunction("setPluckPosition", &stk::Mandolin::setPluckPosition)
-                .addFunction("setFrequency", &stk::Mandolin::setFrequency)
-                .addFunction("pluck", 
-                    luabridge::overload<stk::StkFloat>(&stk::Mandolin::pluck),
-                    luabridge::overload<stk::StkFloat, stk::StkFloat>(&stk::Mandolin::pluck))
-                .addFunction("noteOn", &stk::Mandolin::noteOn)
-                .addFunction("noteOff", &stk::Mandolin::noteOff)
-                .addFunction("controlChange", &stk::Mandolin::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Mandolin::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Mandolin::tick))
-            .endClass()
-            .beginClass <stk::Mesh2D> ("Mesh2D")
-                .addConstructor<void (*) (unsigned short nX, unsigned short nY)>()
-                .addFunction("clear", &stk::Mesh2D::clear)
-                .addFunction("setNX", &stk::Mesh2D::setNX)
-                .addFunction("setNY", &stk::Mesh2D::setNY)
-                .addFunction("setInputPosition", &stk::Mesh2D::setInputPosition)
-                .addFunction("setDecay", &stk::Mesh2D::setDecay)
-                .addFunction("noteOn", &stk::Mesh2D::noteOn)
-                .addFunction("noteOff", &stk::Mesh2D::noteOff)
-                .addFunction("energy", &stk::Mesh2D::energy)
-                .addFunction("inputTick", &stk::Mesh2D::inputTick)
-                .addFunction("controlChange", &stk::Mesh2D::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Mesh2D::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Mesh2D::tick))
-            .endClass()
-            .beginClass <stk::Modulate> ("Modulate")
-                .addConstructor<void ()> ()
-                .addFunction("reset", &stk::Modulate::reset)
-                .addFunction("setVibratoRate", &stk::Modulate::setVibratoRate)
-                .addFunction("setVibratoGain", &stk::Modulate::setVibratoGain)
-                .addFunction("setRandomRate", &stk::Modulate::setRandomRate)
-                .addFunction("setRandomGain", &stk::Modulate::setRandomGain)
-                .addFunction("lastOut", &stk::Modulate::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::Modulate::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Modulate::tick))
-            .endClass()
-            .beginClass <stk::Moog> ("Moog")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::Moog::setFrequency)
-                .addFunction("noteOn", &stk::Moog::noteOn)
-                .addFunction("setModulationSpeed", &stk::Moog::setModulationSpeed)
-                .addFunction("setModulationDepth", &stk::Moog::setModulationDepth)
-                .addFunction("controlChange", &stk::Moog::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Moog::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Moog::tick))
-            .endClass()
-            .beginClass <stk::NRev> ("NRev")
-                .addConstructor<void (*) (stk::StkFloat T60)>()
-                .addFunction("clear", &stk::NRev::clear)
-                .addFunction("setT60", &stk::NRev::setT60)
-                .addFunction("lastOut", &stk::NRev::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::NRev::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::NRev::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::NRev::tick))
-            .endClass()
-            .beginClass <stk::Noise> ("Noise")
-                .addConstructor<void (*) (unsigned int seed)>()
-                .addFunction("setSeed", &stk::Noise::setSeed)
-                .addFunction("lastOut", &stk::Noise::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::Noise::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Noise::tick))
-            .endClass()
-            .beginClass <stk::OnePole> ("OnePole")
-                .addConstructor<void (*) (stk::StkFloat thePole)>()
-                .addFunction("setB0", &stk::OnePole::setB0)
-                .addFunction("setA1", &stk::OnePole::setA1)
-                .addFunction("setCoefficients", &stk::OnePole::setCoefficients)
-                .addFunction("setPole", &stk::OnePole::setPole)
-                .addFunction("lastOut", &stk::OnePole::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::OnePole::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::OnePole::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::OnePole::tick))
-            .endClass()
-            .beginClass <stk::OneZero> ("OneZero")
-                .addConstructor<void (*) (stk::StkFloat theZero)>()
-                .addFunction("setB0", &stk::OneZero::setB0)
-                .addFunction("setB1", &stk::OneZero::setB1)
-                .addFunction("setCoefficients", &stk::OneZero::setCoefficients)
-                .addFunction("setZero", &stk::OneZero::setZero)
-                .addFunction("lastOut", &stk::OneZero::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::OneZero::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::OneZero::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::OneZero::tick))
-            .endClass()
-            .beginClass <stk::PRCRev> ("PRCRev")
-                .addConstructor<void (*) (stk::StkFloat T60)>()
-                .addFunction("clear", &stk::PRCRev::clear)
-                .addFunction("setT60", &stk::PRCRev::setT60)
-                .addFunction("lastOut", &stk::PRCRev::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::PRCRev::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PRCRev::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::PRCRev::tick))
-            .endClass()
-            .beginClass <stk::PercFlut> ("PercFlut")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::PercFlut::setFrequency)
-                .addFunction("noteOn", &stk::PercFlut::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::PercFlut::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PercFlut::tick))
-            .endClass()
-            .beginClass <stk::PitShift> ("PitShift")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::PitShift::clear)
-                .addFunction("setShift", &stk::PitShift::setShift)
-                .addFunction("lastOut", &stk::PitShift::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::PitShift::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PitShift::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::PitShift::tick))
-            .endClass()
-            .beginClass <stk::Plucked> ("Plucked")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Plucked::clear)
-                .addFunction("setFrequency", &stk::Plucked::setFrequency)
-                .addFunction("pluck", &stk::Plucked::pluck)
-                .addFunction("noteOn", &stk::Plucked::noteOn)
-                .addFunction("noteOff", &stk::Plucked::noteOff)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Plucked::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Plucked::tick))
-            .endClass()
-            .beginClass <stk::PoleZero> ("PoleZero")
-                .addConstructor<void ()> ()
-                .addFunction("setB0", &stk::PoleZero::setB0)
-                .addFunction("setB1", &stk::PoleZero::setB1)
-                .addFunction("setA1", &stk::PoleZero::setA1)
-                .addFunction("setCoefficients", &stk::PoleZero::setCoefficients)
-                .addFunction("setAllpass", &stk::PoleZero::setAllpass)
-                .addFunction("setBlockZero", &stk::PoleZero::setBlockZero)
-                .addFunction("lastOut", &stk::PoleZero::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::PoleZero::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PoleZero::tick))
-            .endClass()
-            .beginClass <stk::Recorder> ("Recorder")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::Recorder::clear)
-                .addFunction("setFrequency", &stk::Recorder::setFrequency)
-                .addFunction("startBlowing", &stk::Recorder::startBlowing)
-                .addFunction("stopBlowing", &stk::Recorder::stopBlowing)
-                .addFunction("noteOn", &stk::Recorder::noteOn)
-                .addFunction("noteOff", &stk::Recorder::noteOff)
-                .addFunction("controlChange", &stk::Recorder::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Recorder::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Recorder::tick))
-                .addFunction("setBlowPressure", &stk::Recorder::setBlowPressure)
-                .addFunction("setVibratoGain", &stk::Recorder::setVibratoGain)
-                .addFunction("setVibratoFrequency", &stk::Recorder::setVibratoFrequency)
-                .addFunction("setNoiseGain", &stk::Recorder::setNoiseGain)
-                .addFunction("setBreathCutoff", &stk::Recorder::setBreathCutoff)
-                .addFunction("setSoftness", &stk::Recorder::setSoftness)
-            .endClass()
-            .beginClass <stk::ReedTable> ("ReedTable")
-                .addConstructor<void ()> ()
-                .addFunction("setOffset", &stk::ReedTable::setOffset)
-                .addFunction("setSlope", &stk::ReedTable::setSlope)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::ReedTable::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::ReedTable::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::ReedTable::tick))
-            .endClass()
-            .beginClass <stk::Resonate> ("Resonate")
-                .addConstructor<void ()> ()
-                .addFunction("setResonance", &stk::Resonate::setResonance)
-                .addFunction("setNotch", &stk::Resonate::setNotch)
-                .addFunction("setEqualGainZeroes", &stk::Resonate::setEqualGainZeroes)
-                .addFunction("keyOn", &stk::Resonate::keyOn)
-                .addFunction("keyOff", &stk::Resonate::keyOff)
-                .addFunction("noteOn", &stk::Resonate::noteOn)
-                .addFunction("noteOff", &stk::Resonate::noteOff)
-                .addFunction("controlChange", &stk::Resonate::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Resonate::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Resonate::tick))
-            .endClass()
-            .beginClass <stk::Rhodey> ("Rhodey")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::Rhodey::setFrequency)
-                .addFunction("noteOn", &stk::Rhodey::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Rhodey::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Rhodey::tick))
-            .endClass()
-            .beginClass <stk::Saxofony> ("Saxofony")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Saxofony::clear)
-                .addFunction("setFrequency", &stk::Saxofony::setFrequency)
-                .addFunction("setBlowPosition", &stk::Saxofony::setBlowPosition)
-                .addFunction("startBlowing", &stk::Saxofony::startBlowing)
-                .addFunction("stopBlowing", &stk::Saxofony::stopBlowing)
-                .addFunction("noteOn", &stk::Saxofony::noteOn)
-                .addFunction("noteOff", &stk::Saxofony::noteOff)
-                .addFunction("controlChange", &stk::Saxofony::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Saxofony::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Saxofony::tick))
-            .endClass()
-            .beginClass <stk::Shakers> ("Shakers")
-                .addConstructor<void (*) (int type)>()
-                .addFunction("noteOn", &stk::Shakers::noteOn)
-                .addFunction("noteOff", &stk::Shakers::noteOff)
-                .addFunction("controlChange", &stk::Shakers::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Shakers::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Shakers::tick))
-            .endClass()
-            .beginClass <stk::Simple> ("Simple")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::Simple::setFrequency)
-                .addFunction("keyOn", &stk::Simple::keyOn)
-                .addFunction("keyOff", &stk::Simple::keyOff)
-                .addFunction("noteOn", &stk::Simple::noteOn)
-                .addFunction("noteOff", &stk::Simple::noteOff)
-                .addFunction("controlChange", &stk::Simple::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Simple::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Simple::tick))
-            .endClass()
-            .beginClass <stk::SineWave> ("SineWave")
-                .addConstructor<void ()> ()
-                .addFunction("reset", &stk::SineWave::reset)
-                .addFunction("setRate", &stk::SineWave::setRate)
-                .addFunction("setFrequency", &stk::SineWave::setFrequency)
-                .addFunction("addTime", &stk::SineWave::addTime)
-                .addFunction("addPhase", &stk::SineWave::addPhase)
-                .addFunction("addPhaseOffset", &stk::SineWave::addPhaseOffset)
-                .addFunction("lastOut", &stk::SineWave::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::SineWave::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::SineWave::tick))
-            .endClass()
-            .beginClass <stk::SingWave> ("SingWave")
-                .addConstructor<void (*) (std::string fileName, bool raw)>()
-                .addFunction("reset", &stk::SingWave::reset)
-                .addFunction("normalize",
-                    luabridge::overload<>(&stk::SingWave::normalize),
-                    luabridge::overload<stk::StkFloat>(&stk::SingWave::normalize))
-                .addFunction("setFrequency", &stk::SingWave::setFrequency)
-                .addFunction("setVibratoRate", &stk::SingWave::setVibratoRate)
-                .addFunction("setVibratoGain", &stk::SingWave::setVibratoGain)
-                .addFunction("setRandomGain", &stk::SingWave::setRandomGain)
-                .addFunction("setSweepRate", &stk::SingWave::setSweepRate)
-                .addFunction("setGainRate", &stk::SingWave::setGainRate)
-                .addFunction("setGainTarget", &stk::SingWave::setGainTarget)
-                .addFunction("noteOn", &stk::SingWave::noteOn)
-                .addFunction("noteOff", &stk::SingWave::noteOff)
-                .addFunction("lastOut", &stk::SingWave::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<>(&stk::SingWave::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::SingWave::tick))
-            .endClass()
-            .beginClass <stk::Sitar> ("Sitar")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Sitar::clear)
-                .addFunction("setFrequency", &stk::Sitar::setFrequency)
-                .addFunction("pluck", &stk::Sitar::pluck)
-                .addFunction("noteOn", &stk::Sitar::noteOn)
-                .addFunction("noteOff", &stk::Sitar::noteOff)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Sitar::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Sitar::tick))
-            .endClass()
-            .beginClass <stk::Sphere> ("Sphere")
-                .addConstructor<void (*) (stk::StkFloat radius)>()
-                .addFunction("setPosition", &stk::Sphere::setPosition)
-                .addFunction("setVelocity", &stk::Sphere::setVelocity)
-                .addFunction("setRadius", &stk::Sphere::setRadius)
-                .addFunction("setMass", &stk::Sphere::setMass)
-                .addFunction("getPosition", &stk::Sphere::getPosition)
-                .addFunction("getRelativePosition", &stk::Sphere::getRelativePosition)
-                .addFunction("getVelocity", &stk::Sphere::getVelocity)
-                .addFunction("isInside", &stk::Sphere::isInside)
-                .addFunction("getRadius", &stk::Sphere::getRadius)
-                .addFunction("getMass", &stk::Sphere::getMass)
-                .addFunction("addVelocity", &stk::Sphere::addVelocity)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Sphere::tick))
-            .endClass()
-            .beginClass <stk::StifKarp> ("StifKarp")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::StifKarp::clear)
-                .addFunction("setFrequency", &stk::StifKarp::setFrequency)
-                .addFunction("setStretch", &stk::StifKarp::setStretch)
-                .addFunction("setPickupPosition", &stk::StifKarp::setPickupPosition)
-                .addFunction("setBaseLoopGain", &stk::StifKarp::setBaseLoopGain)
-                .addFunction("pluck", &stk::StifKarp::pluck)
-                .addFunction("noteOn", &stk::StifKarp::noteOn)
-                .addFunction("noteOff", &stk::StifKarp::noteOff)
-                .addFunction("controlChange", &stk::StifKarp::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::StifKarp::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::StifKarp::tick))
-            .endClass()
-
-            .beginClass <stk::TapDelay> ("TapDelay")
-                .addConstructor<void (*) (std::vector<unsigned long> taps, unsigned long maxDelay)>()
-                .addFunction("setMaximumDelay", &stk::TapDelay::setMaximumDelay)
-                .addFunction("setTapDelays", &stk::TapDelay::setTapDelays)
-                .addFunction("getTapDelays", &stk::TapDelay::getTapDelays)
-                .addFunction("lastOut", &stk::TapDelay::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat, stk::StkFrames&>(&stk::TapDelay::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TapDelay::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int>(&stk::TapDelay::tick))
-            .endClass()
-
-            .beginClass <stk::TubeBell> ("TubeBell")
-                .addConstructor<void ()> ()
-                .addFunction("noteOn", &stk::TubeBell::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::TubeBell::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TubeBell::tick))
-            .endClass()
-            .beginClass <stk::Twang> ("Twang")
-                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
-                .addFunction("clear", &stk::Twang::clear)
-                .addFunction("setLowestFrequency", &stk::Twang::setLowestFrequency)
-                .addFunction("setFrequency", &stk::Twang::setFrequency)
-                .addFunction("setPluckPosition", &stk::Twang::setPluckPosition)
-                .addFunction("setLoopGain", &stk::Twang::setLoopGain)
-                .addFunction("setLoopFilter", &stk::Twang::setLoopFilter)
-                .addFunction("lastOut", &stk::Twang::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::Twang::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Twang::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Twang::tick))
-            .endClass()
-            .beginClass <stk::TwoPole> ("TwoPole")
-                .addConstructor<void ()> ()
-                .addFunction("ignoreSampleRateChange", &stk::TwoPole::ignoreSampleRateChange)
-                .addFunction("setB0", &stk::TwoPole::setB0)
-                .addFunction("setA1", &stk::TwoPole::setA1)
-                .addFunction("setA2", &stk::TwoPole::setA2)
-                .addFunction("setCoefficients", &stk::TwoPole::setCoefficients)
-                .addFunction("setResonance", &stk::TwoPole::setResonance)
-                .addFunction("lastOut", &stk::TwoPole::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::TwoPole::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TwoPole::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::TwoPole::tick))
-            .endClass()
-            .beginClass <stk::TwoZero> ("TwoZero")
-                .addConstructor<void ()> ()
-                .addFunction("ignoreSampleRateChange", &stk::TwoZero::ignoreSampleRateChange)
-                .addFunction("setB0", &stk::TwoZero::setB0)
-                .addFunction("setB1", &stk::TwoZero::setB1)
-                .addFunction("setB2", &stk::TwoZero::setB2)
-                .addFunction("setCoefficients", &stk::TwoZero::setCoefficients)
-                .addFunction("setNotch", &stk::TwoZero::setNotch)
-                .addFunction("lastOut", &stk::TwoZero::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<stk::StkFloat>(&stk::TwoZero::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TwoZero::tick),
-                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::TwoZero::tick))
-            .endClass()
-            .beginClass <stk::VoicForm> ("VoicForm")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::VoicForm::clear)
-                .addFunction("setFrequency", &stk::VoicForm::setFrequency)
-                .addFunction("setPhoneme", &stk::VoicForm::setPhoneme)
-                .addFunction("setVoiced", &stk::VoicForm::setVoiced)
-                .addFunction("setUnVoiced", &stk::VoicForm::setUnVoiced)
-                .addFunction("setFilterSweepRate", &stk::VoicForm::setFilterSweepRate)
-                .addFunction("setPitchSweepRate", &stk::VoicForm::setPitchSweepRate)
-                .addFunction("speak", &stk::VoicForm::speak)
-                .addFunction("quiet", &stk::VoicForm::quiet)
-                .addFunction("noteOn", &stk::VoicForm::noteOn)
-                .addFunction("noteOff", &stk::VoicForm::noteOff)
-                .addFunction("controlChange", &stk::VoicForm::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::VoicForm::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::VoicForm::tick))
-            .endClass()
-            .beginClass <stk::Voicer> ("Voicer")
-                .addConstructor<void (*) (stk::StkFloat decayTime)>()
-                .addFunction("addInstrument", &stk::Voicer::addInstrument)
-                .addFunction("removeInstrument", &stk::Voicer::removeInstrument)
-                .addFunction("noteOn", &stk::Voicer::noteOn)
-                .addFunction("noteOff",
-                    luabridge::overload<stk::StkFloat, stk::StkFloat, int>(&stk::Voicer::noteOff),
-                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::noteOff))
-                .addFunction("setFrequency",
-                    luabridge::overload<stk::StkFloat, int>(&stk::Voicer::setFrequency),
-                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::setFrequency))
-
-                .addFunction("pitchBend", 
-                    luabridge::overload<stk::StkFloat, int>(&stk::Voicer::pitchBend),
-                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::pitchBend))
-
-                .addFunction("controlChange", 
-                    luabridge::overload<int, stk::StkFloat, int>(&stk::Voicer::controlChange),
-                    luabridge::overload<long, int, stk::StkFloat>(&stk::Voicer::controlChange))
-
-                .addFunction("silence", &stk::Voicer::silence)
-                .addFunction("channelsOut", &stk::Voicer::channelsOut)
-                .addFunction("lastFrame", &stk::Voicer::lastFrame)
-                .addFunction("lastOut", &stk::Voicer::lastOut)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Voicer::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Voicer::tick))
-            .endClass()
-            .beginClass <stk::Whistle> ("Whistle")
-                .addConstructor<void ()> ()
-                .addFunction("clear", &stk::Whistle::clear)
-                .addFunction("setFrequency", &stk::Whistle::setFrequency)
-                .addFunction("startBlowing", &stk::Whistle::startBlowing)
-                .addFunction("stopBlowing", &stk::Whistle::stopBlowing)
-                .addFunction("noteOn", &stk::Whistle::noteOn)
-                .addFunction("noteOff", &stk::Whistle::noteOff)
-                .addFunction("controlChange", &stk::Whistle::controlChange)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Whistle::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Whistle::tick))
-            .endClass()
-            .beginClass <stk::Wurley> ("Wurley")
-                .addConstructor<void ()> ()
-                .addFunction("setFrequency", &stk::Wurley::setFrequency)
-                .addFunction("noteOn", &stk::Wurley::noteOn)
-                .addFunction("tick", 
-                    luabridge::overload<unsigned int>(&stk::Wurley::tick),
-                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Wurley::tick))
-            .endClass()
-        .endNamespace();
+#if defined LSTK_LAZY_BINDINGS
+    stk_bindings_register_lazy(x->L);
+#else
+    stk_bindings_register(x->L);
+#endif
+    sched_install(x->sched, x->L);
+    buffers_install(x->buffers, x->L);
 
     lstk_run_file(x);
 }
@@ -0,0 +1,1622 @@
+/**
+    @file
+    stk_bindings: luabridge bindings of the stk classes for luajit.stk~
+
+    Every class is registered by its own function so the `stk` namespace can
+    be populated lazily: with stk_bindings_register_lazy() a class is only
+    registered the first time a script accesses `stk.<Name>`.
+*/
+
+#include "ADSR.h"
+#include "Asymp.h"
+#include "BandedWG.h"
+#include "BeeThree.h"
+#include "BiQuad.h"
+#include "Blit.h"
+#include "BlitSaw.h"
+#include "BlitSquare.h"
+#include "BlowBotl.h"
+#include "BlowHole.h"
+#include "BowTable.h"
+#include "Bowed.h"
+#include "Brass.h"
+#include "Chorus.h"
+#include "Clarinet.h"
+#include "Cubic.h"
+#include "Delay.h"
+#include "DelayA.h"
+#include "DelayL.h"
+#include "Drummer.h"
+#include "Echo.h"
+#include "Envelope.h"
+#include "FMVoices.h"
+#include "Flute.h"
+#include "FormSwep.h"
+#include "FreeVerb.h"
+#include "Granulate.h"
+#include "Guitar.h"
+#include "HevyMetl.h"
+#include "JCRev.h"
+#include "JetTable.h"
+#include "LentPitShift.h"
+#include "Mandolin.h"
+#include "Mesh2D.h"
+#include "Modulate.h"
+#include "Moog.h"
+#include "NRev.h"
+#include "Noise.h"
+#include "OnePole.h"
+#include "OneZero.h"
+#include "PRCRev.h"
+#include "PercFlut.h"
+#include "PitShift.h"
+#include "Plucked.h"
+#include "PoleZero.h"
+#include "Recorder.h"
+#include "ReedTable.h"
+#include "Resonate.h"
+#include "Rhodey.h"
+#include "Saxofony.h"
+#include "Shakers.h"
+#include "Simple.h"
+#include "SineWave.h"
+#include "SingWave.h"
+#include "Sitar.h"
+#include "Sphere.h"
+#include "StifKarp.h"
+#include "TapDelay.h"
+#include "TubeBell.h"
+#include "Twang.h"
+#include "TwoPole.h"
+#include "TwoZero.h"
+#include "VoicForm.h"
+#include "Voicer.h"
+#include "Whistle.h"
+#include "Wurley.h"
+
+#include "lua.hpp"
+#include <LuaBridge.h>
+
+#include <cstring>
+
+#include "stk_bindings.h"
+
+
+//-----------------------------------------------------------------------------------------------
+
+static void register_ADSR(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::ADSR> ("ADSR")
+                .addConstructor<void ()> ()
+                .addFunction("keyOn", &stk::ADSR::keyOn)
+                .addFunction("keyOff", &stk::ADSR::keyOff)
+                .addFunction("setAttackRate", &stk::ADSR::setAttackRate)
+                .addFunction("setAttackTarget", &stk::ADSR::setAttackTarget)
+                .addFunction("setDecayRate", &stk::ADSR::setDecayRate)
+                .addFunction("setSustainLevel", &stk::ADSR::setSustainLevel)
+                .addFunction("setReleaseRate", &stk::ADSR::setReleaseRate)
+                .addFunction("setAttackTime", &stk::ADSR::setAttackTime)
+                .addFunction("setDecayTime", &stk::ADSR::setDecayTime)
+                .addFunction("setReleaseTime", &stk::ADSR::setReleaseTime)
+                .addFunction("setAllTimes", &stk::ADSR::setAllTimes)
+                .addFunction("setTarget", &stk::ADSR::setTarget)
+                .addFunction("getState", &stk::ADSR::getState)
+                .addFunction("setValue", &stk::ADSR::setValue)
+                .addFunction("lastOut", &stk::ADSR::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::ADSR::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::ADSR::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Asymp(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Asymp> ("Asymp")
+                .addConstructor<void ()> ()
+                .addFunction("keyOn", &stk::Asymp::keyOn)
+                .addFunction("keyOff", &stk::Asymp::keyOff)
+                .addFunction("setTau", &stk::Asymp::setTau)
+                .addFunction("setTime", &stk::Asymp::setTime)
+                .addFunction("setT60", &stk::Asymp::setT60)
+                .addFunction("setTarget", &stk::Asymp::setTarget)
+                .addFunction("setValue", &stk::Asymp::setValue)
+                .addFunction("getState", &stk::Asymp::getState)
+                .addFunction("lastOut", &stk::Asymp::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::Asymp::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Asymp::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BandedWG(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BandedWG> ("BandedWG")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::BandedWG::clear)
+                .addFunction("setStrikePosition", &stk::BandedWG::setStrikePosition)
+                .addFunction("setPreset", &stk::BandedWG::setPreset)
+                .addFunction("setFrequency", &stk::BandedWG::setFrequency)
+                .addFunction("startBowing", &stk::BandedWG::startBowing)
+                .addFunction("stopBowing", &stk::BandedWG::stopBowing)
+                .addFunction("pluck", &stk::BandedWG::pluck)
+                .addFunction("noteOn", &stk::BandedWG::noteOn)
+                .addFunction("noteOff", &stk::BandedWG::noteOff)
+                .addFunction("controlChange", &stk::BandedWG::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::BandedWG::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BandedWG::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BeeThree(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BeeThree> ("BeeThree")
+                .addConstructor<void ()> ()
+                .addFunction("noteOn", &stk::BeeThree::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::BeeThree::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BeeThree::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BiQuad(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BiQuad> ("BiQuad")
+                .addConstructor<void ()> ()
+                .addFunction("ignoreSampleRateChange", &stk::BiQuad::ignoreSampleRateChange)
+                .addFunction("setCoefficients", &stk::BiQuad::setCoefficients)
+                .addFunction("setB0", &stk::BiQuad::setB0)
+                .addFunction("setB1", &stk::BiQuad::setB1)
+                .addFunction("setB2", &stk::BiQuad::setB2)
+                .addFunction("setA1", &stk::BiQuad::setA1)
+                .addFunction("setA2", &stk::BiQuad::setA2)
+                .addFunction("setResonance", &stk::BiQuad::setResonance)
+                .addFunction("setNotch", &stk::BiQuad::setNotch)
+                .addFunction("setLowPass", &stk::BiQuad::setLowPass)
+                .addFunction("setHighPass", &stk::BiQuad::setHighPass)
+                .addFunction("setBandPass", &stk::BiQuad::setBandPass)
+                .addFunction("setBandReject", &stk::BiQuad::setBandReject)
+                .addFunction("setAllPass", &stk::BiQuad::setAllPass)
+                .addFunction("setEqualGainZeroes", &stk::BiQuad::setEqualGainZeroes)
+                .addFunction("lastOut", &stk::BiQuad::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::BiQuad::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BiQuad::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::BiQuad::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Blit(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Blit> ("Blit")
+                .addConstructor<void (*) (stk::StkFloat frequency)>()
+                .addFunction("reset", &stk::Blit::reset)
+                .addFunction("setPhase", &stk::Blit::setPhase)
+                .addFunction("getPhase", &stk::Blit::getPhase)
+                .addFunction("setFrequency", &stk::Blit::setFrequency)
+                .addFunction("setHarmonics", &stk::Blit::setHarmonics)
+                .addFunction("lastOut", &stk::Blit::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::Blit::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Blit::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BlitSaw(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BlitSaw> ("BlitSaw")
+                .addConstructor<void (*) (stk::StkFloat frequency)>()
+                .addFunction("reset", &stk::BlitSaw::reset)
+                .addFunction("setFrequency", &stk::BlitSaw::setFrequency)
+                .addFunction("setHarmonics", &stk::BlitSaw::setHarmonics)
+                .addFunction("lastOut", &stk::BlitSaw::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::BlitSaw::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlitSaw::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BlitSquare(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BlitSquare> ("BlitSquare")
+                .addConstructor<void (*) (stk::StkFloat frequency)>()
+                .addFunction("reset", &stk::BlitSquare::reset)
+                .addFunction("setPhase", &stk::BlitSquare::setPhase)
+                .addFunction("getPhase", &stk::BlitSquare::getPhase)
+                .addFunction("setFrequency", &stk::BlitSquare::setFrequency)
+                .addFunction("setHarmonics", &stk::BlitSquare::setHarmonics)
+                .addFunction("lastOut", &stk::BlitSquare::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::BlitSquare::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlitSquare::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BlowBotl(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BlowBotl> ("BlowBotl")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::BlowBotl::clear)
+                .addFunction("setFrequency", &stk::BlowBotl::setFrequency)
+                .addFunction("startBlowing", &stk::BlowBotl::startBlowing)
+                .addFunction("stopBlowing", &stk::BlowBotl::stopBlowing)
+                .addFunction("noteOn", &stk::BlowBotl::noteOn)
+                .addFunction("noteOff", &stk::BlowBotl::noteOff)
+                .addFunction("controlChange", &stk::BlowBotl::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::BlowBotl::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlowBotl::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BlowHole(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BlowHole> ("BlowHole")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::BlowHole::clear)
+                .addFunction("setFrequency", &stk::BlowHole::setFrequency)
+                .addFunction("setTonehole", &stk::BlowHole::setTonehole)
+                .addFunction("setVent", &stk::BlowHole::setVent)
+                .addFunction("startBlowing", &stk::BlowHole::startBlowing)
+                .addFunction("stopBlowing", &stk::BlowHole::stopBlowing)
+                .addFunction("noteOn", &stk::BlowHole::noteOn)
+                .addFunction("noteOff", &stk::BlowHole::noteOff)
+                .addFunction("controlChange", &stk::BlowHole::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::BlowHole::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BlowHole::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_BowTable(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::BowTable> ("BowTable")
+                .addConstructor<void ()> ()
+                .addFunction("setOffset", &stk::BowTable::setOffset)
+                .addFunction("setSlope", &stk::BowTable::setSlope)
+                .addFunction("setMinOutput", &stk::BowTable::setMinOutput)
+                .addFunction("setMaxOutput", &stk::BowTable::setMaxOutput)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::BowTable::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::BowTable::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::BowTable::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Bowed(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Bowed> ("Bowed")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Bowed::clear)
+                .addFunction("setFrequency", &stk::Bowed::setFrequency)
+                .addFunction("setVibrato", &stk::Bowed::setVibrato)
+                .addFunction("startBowing", &stk::Bowed::startBowing)
+                .addFunction("stopBowing", &stk::Bowed::stopBowing)
+                .addFunction("noteOn", &stk::Bowed::noteOn)
+                .addFunction("noteOff", &stk::Bowed::noteOff)
+                .addFunction("controlChange", &stk::Bowed::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Bowed::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Bowed::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Brass(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Brass> ("Brass")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Brass::clear)
+                .addFunction("setFrequency", &stk::Brass::setFrequency)
+                .addFunction("setLip", &stk::Brass::setLip)
+                .addFunction("startBlowing", &stk::Brass::startBlowing)
+                .addFunction("stopBlowing", &stk::Brass::stopBlowing)
+                .addFunction("noteOn", &stk::Brass::noteOn)
+                .addFunction("noteOff", &stk::Brass::noteOff)
+                .addFunction("controlChange", &stk::Brass::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Brass::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Brass::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Chorus(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Chorus> ("Chorus")
+                .addConstructor<void (*) (stk::StkFloat baseDelay)>()
+                .addFunction("clear", &stk::Chorus::clear)
+                .addFunction("setModDepth", &stk::Chorus::setModDepth)
+                .addFunction("setModFrequency", &stk::Chorus::setModFrequency)
+                .addFunction("lastOut", &stk::Chorus::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::Chorus::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Chorus::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Chorus::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Clarinet(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Clarinet> ("Clarinet")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Clarinet::clear)
+                .addFunction("setFrequency", &stk::Clarinet::setFrequency)
+                .addFunction("startBlowing", &stk::Clarinet::startBlowing)
+                .addFunction("stopBlowing", &stk::Clarinet::stopBlowing)
+                .addFunction("noteOn", &stk::Clarinet::noteOn)
+                .addFunction("noteOff", &stk::Clarinet::noteOff)
+                .addFunction("controlChange", &stk::Clarinet::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Clarinet::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Clarinet::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Cubic(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Cubic> ("Cubic")
+                .addConstructor<void ()> ()
+                .addFunction("setA1", &stk::Cubic::setA1)
+                .addFunction("setA2", &stk::Cubic::setA2)
+                .addFunction("setA3", &stk::Cubic::setA3)
+                .addFunction("setGain", &stk::Cubic::setGain)
+                .addFunction("setThreshold", &stk::Cubic::setThreshold)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Cubic::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Cubic::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Cubic::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Delay(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Delay> ("Delay")
+                .addConstructor<void (*) (unsigned long delay, unsigned long maxDelay)>()
+                .addFunction("getMaximumDelay", &stk::Delay::getMaximumDelay)
+                .addFunction("setMaximumDelay", &stk::Delay::setMaximumDelay)
+                .addFunction("setDelay", &stk::Delay::setDelay)
+                .addFunction("getDelay", &stk::Delay::getDelay)
+                .addFunction("tapOut", &stk::Delay::tapOut)
+                .addFunction("tapIn", &stk::Delay::tapIn)
+                .addFunction("addTo", &stk::Delay::addTo)
+                .addFunction("lastOut", &stk::Delay::lastOut)
+                .addFunction("nextOut", &stk::Delay::nextOut)
+                .addFunction("energy", &stk::Delay::energy)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Delay::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Delay::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Delay::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_DelayA(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::DelayA> ("DelayA")
+                .addConstructor<void (*) (stk::StkFloat delay, unsigned long maxDelay)>()
+                .addFunction("clear", &stk::DelayA::clear)
+                .addFunction("getMaximumDelay", &stk::DelayA::getMaximumDelay)
+                .addFunction("setMaximumDelay", &stk::DelayA::setMaximumDelay)
+                .addFunction("setDelay", &stk::DelayA::setDelay)
+                .addFunction("getDelay", &stk::DelayA::getDelay)
+                .addFunction("tapOut", &stk::DelayA::tapOut)
+                .addFunction("tapIn", &stk::DelayA::tapIn)
+                .addFunction("lastOut", &stk::DelayA::lastOut)
+                .addFunction("nextOut", &stk::DelayA::nextOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::DelayA::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::DelayA::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::DelayA::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_DelayL(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::DelayL> ("DelayL")
+                .addConstructor<void (*) (stk::StkFloat delay, unsigned long maxDelay)>()
+                .addFunction("getMaximumDelay", &stk::DelayL::getMaximumDelay)
+                .addFunction("setMaximumDelay", &stk::DelayL::setMaximumDelay)
+                .addFunction("setDelay", &stk::DelayL::setDelay)
+                .addFunction("getDelay", &stk::DelayL::getDelay)
+                .addFunction("tapOut", &stk::DelayL::tapOut)
+                .addFunction("tapIn", &stk::DelayL::tapIn)
+                .addFunction("lastOut", &stk::DelayL::lastOut)
+                .addFunction("nextOut", &stk::DelayL::nextOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::DelayL::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::DelayL::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::DelayL::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Drummer(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Drummer> ("Drummer")
+                .addConstructor<void ()> ()
+                .addFunction("noteOn", &stk::Drummer::noteOn)
+                .addFunction("noteOff", &stk::Drummer::noteOff)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Drummer::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Drummer::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Echo(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Echo> ("Echo")
+                .addConstructor<void (*) (unsigned long maximumDelay)>()
+                .addFunction("clear", &stk::Echo::clear)
+                .addFunction("setMaximumDelay", &stk::Echo::setMaximumDelay)
+                .addFunction("setDelay", &stk::Echo::setDelay)
+                .addFunction("lastOut", &stk::Echo::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Echo::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Echo::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Echo::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Envelope(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Envelope> ("Envelope")
+                .addConstructor<void ()> ()
+                .addFunction("operator=", &stk::Envelope::operator=)
+                .addFunction("keyOn", &stk::Envelope::keyOn)
+                .addFunction("keyOff", &stk::Envelope::keyOff)
+                .addFunction("setRate", &stk::Envelope::setRate)
+                .addFunction("setTime", &stk::Envelope::setTime)
+                .addFunction("setTarget", &stk::Envelope::setTarget)
+                .addFunction("setValue", &stk::Envelope::setValue)
+                .addFunction("getState", &stk::Envelope::getState)
+                .addFunction("lastOut", &stk::Envelope::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::Envelope::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Envelope::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_FMVoices(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::FMVoices> ("FMVoices")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::FMVoices::setFrequency)
+                .addFunction("noteOn", &stk::FMVoices::noteOn)
+                .addFunction("controlChange", &stk::FMVoices::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::FMVoices::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FMVoices::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Flute(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Flute> ("Flute")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Flute::clear)
+                .addFunction("setFrequency", &stk::Flute::setFrequency)
+                .addFunction("setJetReflection", &stk::Flute::setJetReflection)
+                .addFunction("setEndReflection", &stk::Flute::setEndReflection)
+                .addFunction("setJetDelay", &stk::Flute::setJetDelay)
+                .addFunction("startBlowing", &stk::Flute::startBlowing)
+                .addFunction("stopBlowing", &stk::Flute::stopBlowing)
+                .addFunction("noteOn", &stk::Flute::noteOn)
+                .addFunction("noteOff", &stk::Flute::noteOff)
+                .addFunction("controlChange", &stk::Flute::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Flute::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Flute::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_FormSwep(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::FormSwep> ("FormSwep")
+                .addConstructor<void ()> ()
+                .addFunction("ignoreSampleRateChange", &stk::FormSwep::ignoreSampleRateChange)
+                .addFunction("setResonance", &stk::FormSwep::setResonance)
+                .addFunction("setStates", &stk::FormSwep::setStates)
+                .addFunction("setTargets", &stk::FormSwep::setTargets)
+                .addFunction("setSweepRate", &stk::FormSwep::setSweepRate)
+                .addFunction("setSweepTime", &stk::FormSwep::setSweepTime)
+                .addFunction("lastOut", &stk::FormSwep::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::FormSwep::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FormSwep::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::FormSwep::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_FreeVerb(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::FreeVerb> ("FreeVerb")
+                .addConstructor<void ()> ()
+                .addFunction("setEffectMix", &stk::FreeVerb::setEffectMix)
+                .addFunction("setRoomSize", &stk::FreeVerb::setRoomSize)
+                .addFunction("getRoomSize", &stk::FreeVerb::getRoomSize)
+                .addFunction("setDamping", &stk::FreeVerb::setDamping)
+                .addFunction("getDamping", &stk::FreeVerb::getDamping)
+                .addFunction("setWidth", &stk::FreeVerb::setWidth)
+                .addFunction("getWidth", &stk::FreeVerb::getWidth)
+                .addFunction("setMode", &stk::FreeVerb::setMode)
+                .addFunction("getMode", &stk::FreeVerb::getMode)
+                .addFunction("clear", &stk::FreeVerb::clear)
+                .addFunction("lastOut", &stk::FreeVerb::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, stk::StkFloat, unsigned int>(&stk::FreeVerb::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::FreeVerb::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::FreeVerb::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Granulate(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Granulate> ("Granulate")
+                .addConstructor<void ()> ()
+                .addConstructor<void (*) (unsigned int nVoices, std::string fileName, bool typeRaw)>()
+                .addFunction("openFile", &stk::Granulate::openFile)
+                .addFunction("reset", &stk::Granulate::reset)
+                .addFunction("setVoices", &stk::Granulate::setVoices)
+                .addFunction("setStretch", &stk::Granulate::setStretch)
+                .addFunction("setGrainParameters", &stk::Granulate::setGrainParameters)
+                .addFunction("setRandomFactor", &stk::Granulate::setRandomFactor)
+                .addFunction("lastOut", &stk::Granulate::lastOut)
+                .addFunction("tick",
+                    luabridge::overload<unsigned int>(&stk::Granulate::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Granulate::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Guitar(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Guitar> ("Guitar")
+                .addConstructor<void (*) (unsigned int nStrings, std::string bodyfile)>()
+                .addFunction("clear", &stk::Guitar::clear)
+                .addFunction("setBodyFile", &stk::Guitar::setBodyFile)
+                .addFunction("setPluckPosition", &stk::Guitar::setPluckPosition)
+                .addFunction("setLoopGain", &stk::Guitar::setLoopGain)
+                .addFunction("setFrequency", &stk::Guitar::setFrequency)
+                .addFunction("noteOn", &stk::Guitar::noteOn)
+                .addFunction("noteOff", &stk::Guitar::noteOff)
+                .addFunction("controlChange", &stk::Guitar::controlChange)
+                .addFunction("lastOut", &stk::Guitar::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Guitar::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Guitar::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Guitar::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_HevyMetl(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::HevyMetl> ("HevyMetl")
+                .addConstructor<void ()> ()
+                .addFunction("noteOn", &stk::HevyMetl::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::HevyMetl::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::HevyMetl::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_JCRev(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::JCRev> ("JCRev")
+                .addConstructor<void (*) (stk::StkFloat T60)>()
+                .addFunction("clear", &stk::JCRev::clear)
+                .addFunction("setT60", &stk::JCRev::setT60)
+                .addFunction("lastOut", &stk::JCRev::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::JCRev::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::JCRev::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::JCRev::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_JetTable(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::JetTable> ("JetTable")
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::JetTable::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::JetTable::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::JetTable::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_LentPitShift(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::LentPitShift> ("LentPitShift")
+                .addConstructor<void (*) (stk::StkFloat periodRatio, int tMax)>()
+                .addFunction("clear", &stk::LentPitShift::clear)
+                .addFunction("setShift", &stk::LentPitShift::setShift)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::LentPitShift::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::LentPitShift::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::LentPitShift::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Mandolin(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Mandolin> ("Mandolin")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Mandolin::clear)
+                .addFunction("setDetune", &stk::Mandolin::setDetune)
+                .addFunction("setBodySize", &stk::Mandolin::setBodySize)
+                .addFunction("setPluckPosition", &stk::Mandolin::setPluckPosition)
+                .addFunction("setFrequency", &stk::Mandolin::setFrequency)
+                .addFunction("pluck", 
+                    luabridge::overload<stk::StkFloat>(&stk::Mandolin::pluck),
+                    luabridge::overload<stk::StkFloat, stk::StkFloat>(&stk::Mandolin::pluck))
+                .addFunction("noteOn", &stk::Mandolin::noteOn)
+                .addFunction("noteOff", &stk::Mandolin::noteOff)
+                .addFunction("controlChange", &stk::Mandolin::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Mandolin::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Mandolin::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Mesh2D(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Mesh2D> ("Mesh2D")
+                .addConstructor<void (*) (unsigned short nX, unsigned short nY)>()
+                .addFunction("clear", &stk::Mesh2D::clear)
+                .addFunction("setNX", &stk::Mesh2D::setNX)
+                .addFunction("setNY", &stk::Mesh2D::setNY)
+                .addFunction("setInputPosition", &stk::Mesh2D::setInputPosition)
+                .addFunction("setDecay", &stk::Mesh2D::setDecay)
+                .addFunction("noteOn", &stk::Mesh2D::noteOn)
+                .addFunction("noteOff", &stk::Mesh2D::noteOff)
+                .addFunction("energy", &stk::Mesh2D::energy)
+                .addFunction("inputTick", &stk::Mesh2D::inputTick)
+                .addFunction("controlChange", &stk::Mesh2D::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Mesh2D::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Mesh2D::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Modulate(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Modulate> ("Modulate")
+                .addConstructor<void ()> ()
+                .addFunction("reset", &stk::Modulate::reset)
+                .addFunction("setVibratoRate", &stk::Modulate::setVibratoRate)
+                .addFunction("setVibratoGain", &stk::Modulate::setVibratoGain)
+                .addFunction("setRandomRate", &stk::Modulate::setRandomRate)
+                .addFunction("setRandomGain", &stk::Modulate::setRandomGain)
+                .addFunction("lastOut", &stk::Modulate::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::Modulate::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Modulate::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Moog(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Moog> ("Moog")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::Moog::setFrequency)
+                .addFunction("noteOn", &stk::Moog::noteOn)
+                .addFunction("setModulationSpeed", &stk::Moog::setModulationSpeed)
+                .addFunction("setModulationDepth", &stk::Moog::setModulationDepth)
+                .addFunction("controlChange", &stk::Moog::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Moog::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Moog::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_NRev(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::NRev> ("NRev")
+                .addConstructor<void (*) (stk::StkFloat T60)>()
+                .addFunction("clear", &stk::NRev::clear)
+                .addFunction("setT60", &stk::NRev::setT60)
+                .addFunction("lastOut", &stk::NRev::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::NRev::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::NRev::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::NRev::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Noise(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Noise> ("Noise")
+                .addConstructor<void (*) (unsigned int seed)>()
+                .addFunction("setSeed", &stk::Noise::setSeed)
+                .addFunction("lastOut", &stk::Noise::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::Noise::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Noise::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_OnePole(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::OnePole> ("OnePole")
+                .addConstructor<void (*) (stk::StkFloat thePole)>()
+                .addFunction("setB0", &stk::OnePole::setB0)
+                .addFunction("setA1", &stk::OnePole::setA1)
+                .addFunction("setCoefficients", &stk::OnePole::setCoefficients)
+                .addFunction("setPole", &stk::OnePole::setPole)
+                .addFunction("lastOut", &stk::OnePole::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::OnePole::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::OnePole::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::OnePole::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_OneZero(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::OneZero> ("OneZero")
+                .addConstructor<void (*) (stk::StkFloat theZero)>()
+                .addFunction("setB0", &stk::OneZero::setB0)
+                .addFunction("setB1", &stk::OneZero::setB1)
+                .addFunction("setCoefficients", &stk::OneZero::setCoefficients)
+                .addFunction("setZero", &stk::OneZero::setZero)
+                .addFunction("lastOut", &stk::OneZero::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::OneZero::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::OneZero::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::OneZero::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_PRCRev(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::PRCRev> ("PRCRev")
+                .addConstructor<void (*) (stk::StkFloat T60)>()
+                .addFunction("clear", &stk::PRCRev::clear)
+                .addFunction("setT60", &stk::PRCRev::setT60)
+                .addFunction("lastOut", &stk::PRCRev::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, unsigned int>(&stk::PRCRev::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PRCRev::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::PRCRev::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_PercFlut(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::PercFlut> ("PercFlut")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::PercFlut::setFrequency)
+                .addFunction("noteOn", &stk::PercFlut::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::PercFlut::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PercFlut::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_PitShift(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::PitShift> ("PitShift")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::PitShift::clear)
+                .addFunction("setShift", &stk::PitShift::setShift)
+                .addFunction("lastOut", &stk::PitShift::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::PitShift::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PitShift::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::PitShift::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Plucked(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Plucked> ("Plucked")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Plucked::clear)
+                .addFunction("setFrequency", &stk::Plucked::setFrequency)
+                .addFunction("pluck", &stk::Plucked::pluck)
+                .addFunction("noteOn", &stk::Plucked::noteOn)
+                .addFunction("noteOff", &stk::Plucked::noteOff)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Plucked::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Plucked::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_PoleZero(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::PoleZero> ("PoleZero")
+                .addConstructor<void ()> ()
+                .addFunction("setB0", &stk::PoleZero::setB0)
+                .addFunction("setB1", &stk::PoleZero::setB1)
+                .addFunction("setA1", &stk::PoleZero::setA1)
+                .addFunction("setCoefficients", &stk::PoleZero::setCoefficients)
+                .addFunction("setAllpass", &stk::PoleZero::setAllpass)
+                .addFunction("setBlockZero", &stk::PoleZero::setBlockZero)
+                .addFunction("lastOut", &stk::PoleZero::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::PoleZero::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::PoleZero::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Recorder(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Recorder> ("Recorder")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::Recorder::clear)
+                .addFunction("setFrequency", &stk::Recorder::setFrequency)
+                .addFunction("startBlowing", &stk::Recorder::startBlowing)
+                .addFunction("stopBlowing", &stk::Recorder::stopBlowing)
+                .addFunction("noteOn", &stk::Recorder::noteOn)
+                .addFunction("noteOff", &stk::Recorder::noteOff)
+                .addFunction("controlChange", &stk::Recorder::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Recorder::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Recorder::tick))
+                .addFunction("setBlowPressure", &stk::Recorder::setBlowPressure)
+                .addFunction("setVibratoGain", &stk::Recorder::setVibratoGain)
+                .addFunction("setVibratoFrequency", &stk::Recorder::setVibratoFrequency)
+                .addFunction("setNoiseGain", &stk::Recorder::setNoiseGain)
+                .addFunction("setBreathCutoff", &stk::Recorder::setBreathCutoff)
+                .addFunction("setSoftness", &stk::Recorder::setSoftness)
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_ReedTable(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::ReedTable> ("ReedTable")
+                .addConstructor<void ()> ()
+                .addFunction("setOffset", &stk::ReedTable::setOffset)
+                .addFunction("setSlope", &stk::ReedTable::setSlope)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::ReedTable::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::ReedTable::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::ReedTable::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Resonate(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Resonate> ("Resonate")
+                .addConstructor<void ()> ()
+                .addFunction("setResonance", &stk::Resonate::setResonance)
+                .addFunction("setNotch", &stk::Resonate::setNotch)
+                .addFunction("setEqualGainZeroes", &stk::Resonate::setEqualGainZeroes)
+                .addFunction("keyOn", &stk::Resonate::keyOn)
+                .addFunction("keyOff", &stk::Resonate::keyOff)
+                .addFunction("noteOn", &stk::Resonate::noteOn)
+                .addFunction("noteOff", &stk::Resonate::noteOff)
+                .addFunction("controlChange", &stk::Resonate::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Resonate::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Resonate::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Rhodey(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Rhodey> ("Rhodey")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::Rhodey::setFrequency)
+                .addFunction("noteOn", &stk::Rhodey::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Rhodey::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Rhodey::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Saxofony(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Saxofony> ("Saxofony")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Saxofony::clear)
+                .addFunction("setFrequency", &stk::Saxofony::setFrequency)
+                .addFunction("setBlowPosition", &stk::Saxofony::setBlowPosition)
+                .addFunction("startBlowing", &stk::Saxofony::startBlowing)
+                .addFunction("stopBlowing", &stk::Saxofony::stopBlowing)
+                .addFunction("noteOn", &stk::Saxofony::noteOn)
+                .addFunction("noteOff", &stk::Saxofony::noteOff)
+                .addFunction("controlChange", &stk::Saxofony::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Saxofony::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Saxofony::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Shakers(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Shakers> ("Shakers")
+                .addConstructor<void (*) (int type)>()
+                .addFunction("noteOn", &stk::Shakers::noteOn)
+                .addFunction("noteOff", &stk::Shakers::noteOff)
+                .addFunction("controlChange", &stk::Shakers::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Shakers::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Shakers::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Simple(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Simple> ("Simple")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::Simple::setFrequency)
+                .addFunction("keyOn", &stk::Simple::keyOn)
+                .addFunction("keyOff", &stk::Simple::keyOff)
+                .addFunction("noteOn", &stk::Simple::noteOn)
+                .addFunction("noteOff", &stk::Simple::noteOff)
+                .addFunction("controlChange", &stk::Simple::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Simple::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Simple::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_SineWave(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::SineWave> ("SineWave")
+                .addConstructor<void ()> ()
+                .addFunction("reset", &stk::SineWave::reset)
+                .addFunction("setRate", &stk::SineWave::setRate)
+                .addFunction("setFrequency", &stk::SineWave::setFrequency)
+                .addFunction("addTime", &stk::SineWave::addTime)
+                .addFunction("addPhase", &stk::SineWave::addPhase)
+                .addFunction("addPhaseOffset", &stk::SineWave::addPhaseOffset)
+                .addFunction("lastOut", &stk::SineWave::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::SineWave::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::SineWave::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_SingWave(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::SingWave> ("SingWave")
+                .addConstructor<void (*) (std::string fileName, bool raw)>()
+                .addFunction("reset", &stk::SingWave::reset)
+                .addFunction("normalize",
+                    luabridge::overload<>(&stk::SingWave::normalize),
+                    luabridge::overload<stk::StkFloat>(&stk::SingWave::normalize))
+                .addFunction("setFrequency", &stk::SingWave::setFrequency)
+                .addFunction("setVibratoRate", &stk::SingWave::setVibratoRate)
+                .addFunction("setVibratoGain", &stk::SingWave::setVibratoGain)
+                .addFunction("setRandomGain", &stk::SingWave::setRandomGain)
+                .addFunction("setSweepRate", &stk::SingWave::setSweepRate)
+                .addFunction("setGainRate", &stk::SingWave::setGainRate)
+                .addFunction("setGainTarget", &stk::SingWave::setGainTarget)
+                .addFunction("noteOn", &stk::SingWave::noteOn)
+                .addFunction("noteOff", &stk::SingWave::noteOff)
+                .addFunction("lastOut", &stk::SingWave::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<>(&stk::SingWave::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::SingWave::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Sitar(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Sitar> ("Sitar")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Sitar::clear)
+                .addFunction("setFrequency", &stk::Sitar::setFrequency)
+                .addFunction("pluck", &stk::Sitar::pluck)
+                .addFunction("noteOn", &stk::Sitar::noteOn)
+                .addFunction("noteOff", &stk::Sitar::noteOff)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Sitar::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Sitar::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Sphere(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Sphere> ("Sphere")
+                .addConstructor<void (*) (stk::StkFloat radius)>()
+                .addFunction("setPosition", &stk::Sphere::setPosition)
+                .addFunction("setVelocity", &stk::Sphere::setVelocity)
+                .addFunction("setRadius", &stk::Sphere::setRadius)
+                .addFunction("setMass", &stk::Sphere::setMass)
+                .addFunction("getPosition", &stk::Sphere::getPosition)
+                .addFunction("getRelativePosition", &stk::Sphere::getRelativePosition)
+                .addFunction("getVelocity", &stk::Sphere::getVelocity)
+                .addFunction("isInside", &stk::Sphere::isInside)
+                .addFunction("getRadius", &stk::Sphere::getRadius)
+                .addFunction("getMass", &stk::Sphere::getMass)
+                .addFunction("addVelocity", &stk::Sphere::addVelocity)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Sphere::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_StifKarp(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::StifKarp> ("StifKarp")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::StifKarp::clear)
+                .addFunction("setFrequency", &stk::StifKarp::setFrequency)
+                .addFunction("setStretch", &stk::StifKarp::setStretch)
+                .addFunction("setPickupPosition", &stk::StifKarp::setPickupPosition)
+                .addFunction("setBaseLoopGain", &stk::StifKarp::setBaseLoopGain)
+                .addFunction("pluck", &stk::StifKarp::pluck)
+                .addFunction("noteOn", &stk::StifKarp::noteOn)
+                .addFunction("noteOff", &stk::StifKarp::noteOff)
+                .addFunction("controlChange", &stk::StifKarp::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::StifKarp::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::StifKarp::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_TapDelay(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::TapDelay> ("TapDelay")
+                .addConstructor<void (*) (std::vector<unsigned long> taps, unsigned long maxDelay)>()
+                .addFunction("setMaximumDelay", &stk::TapDelay::setMaximumDelay)
+                .addFunction("setTapDelays", &stk::TapDelay::setTapDelays)
+                .addFunction("getTapDelays", &stk::TapDelay::getTapDelays)
+                .addFunction("lastOut", &stk::TapDelay::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat, stk::StkFrames&>(&stk::TapDelay::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TapDelay::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int>(&stk::TapDelay::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_TubeBell(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::TubeBell> ("TubeBell")
+                .addConstructor<void ()> ()
+                .addFunction("noteOn", &stk::TubeBell::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::TubeBell::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TubeBell::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Twang(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Twang> ("Twang")
+                .addConstructor<void (*) (stk::StkFloat lowestFrequency)>()
+                .addFunction("clear", &stk::Twang::clear)
+                .addFunction("setLowestFrequency", &stk::Twang::setLowestFrequency)
+                .addFunction("setFrequency", &stk::Twang::setFrequency)
+                .addFunction("setPluckPosition", &stk::Twang::setPluckPosition)
+                .addFunction("setLoopGain", &stk::Twang::setLoopGain)
+                .addFunction("setLoopFilter", &stk::Twang::setLoopFilter)
+                .addFunction("lastOut", &stk::Twang::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::Twang::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Twang::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::Twang::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_TwoPole(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::TwoPole> ("TwoPole")
+                .addConstructor<void ()> ()
+                .addFunction("ignoreSampleRateChange", &stk::TwoPole::ignoreSampleRateChange)
+                .addFunction("setB0", &stk::TwoPole::setB0)
+                .addFunction("setA1", &stk::TwoPole::setA1)
+                .addFunction("setA2", &stk::TwoPole::setA2)
+                .addFunction("setCoefficients", &stk::TwoPole::setCoefficients)
+                .addFunction("setResonance", &stk::TwoPole::setResonance)
+                .addFunction("lastOut", &stk::TwoPole::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::TwoPole::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TwoPole::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::TwoPole::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_TwoZero(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::TwoZero> ("TwoZero")
+                .addConstructor<void ()> ()
+                .addFunction("ignoreSampleRateChange", &stk::TwoZero::ignoreSampleRateChange)
+                .addFunction("setB0", &stk::TwoZero::setB0)
+                .addFunction("setB1", &stk::TwoZero::setB1)
+                .addFunction("setB2", &stk::TwoZero::setB2)
+                .addFunction("setCoefficients", &stk::TwoZero::setCoefficients)
+                .addFunction("setNotch", &stk::TwoZero::setNotch)
+                .addFunction("lastOut", &stk::TwoZero::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<stk::StkFloat>(&stk::TwoZero::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::TwoZero::tick),
+                    luabridge::overload<stk::StkFrames&, stk::StkFrames&, unsigned int, unsigned int>(&stk::TwoZero::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_VoicForm(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::VoicForm> ("VoicForm")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::VoicForm::clear)
+                .addFunction("setFrequency", &stk::VoicForm::setFrequency)
+                .addFunction("setPhoneme", &stk::VoicForm::setPhoneme)
+                .addFunction("setVoiced", &stk::VoicForm::setVoiced)
+                .addFunction("setUnVoiced", &stk::VoicForm::setUnVoiced)
+                .addFunction("setFilterSweepRate", &stk::VoicForm::setFilterSweepRate)
+                .addFunction("setPitchSweepRate", &stk::VoicForm::setPitchSweepRate)
+                .addFunction("speak", &stk::VoicForm::speak)
+                .addFunction("quiet", &stk::VoicForm::quiet)
+                .addFunction("noteOn", &stk::VoicForm::noteOn)
+                .addFunction("noteOff", &stk::VoicForm::noteOff)
+                .addFunction("controlChange", &stk::VoicForm::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::VoicForm::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::VoicForm::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Voicer(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Voicer> ("Voicer")
+                .addConstructor<void (*) (stk::StkFloat decayTime)>()
+                .addFunction("addInstrument", &stk::Voicer::addInstrument)
+                .addFunction("removeInstrument", &stk::Voicer::removeInstrument)
+                .addFunction("noteOn", &stk::Voicer::noteOn)
+                .addFunction("noteOff",
+                    luabridge::overload<stk::StkFloat, stk::StkFloat, int>(&stk::Voicer::noteOff),
+                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::noteOff))
+                .addFunction("setFrequency",
+                    luabridge::overload<stk::StkFloat, int>(&stk::Voicer::setFrequency),
+                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::setFrequency))
+
+                .addFunction("pitchBend", 
+                    luabridge::overload<stk::StkFloat, int>(&stk::Voicer::pitchBend),
+                    luabridge::overload<long, stk::StkFloat>(&stk::Voicer::pitchBend))
+
+                .addFunction("controlChange", 
+                    luabridge::overload<int, stk::StkFloat, int>(&stk::Voicer::controlChange),
+                    luabridge::overload<long, int, stk::StkFloat>(&stk::Voicer::controlChange))
+
+                .addFunction("silence", &stk::Voicer::silence)
+                .addFunction("channelsOut", &stk::Voicer::channelsOut)
+                .addFunction("lastFrame", &stk::Voicer::lastFrame)
+                .addFunction("lastOut", &stk::Voicer::lastOut)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Voicer::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Voicer::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Whistle(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Whistle> ("Whistle")
+                .addConstructor<void ()> ()
+                .addFunction("clear", &stk::Whistle::clear)
+                .addFunction("setFrequency", &stk::Whistle::setFrequency)
+                .addFunction("startBlowing", &stk::Whistle::startBlowing)
+                .addFunction("stopBlowing", &stk::Whistle::stopBlowing)
+                .addFunction("noteOn", &stk::Whistle::noteOn)
+                .addFunction("noteOff", &stk::Whistle::noteOff)
+                .addFunction("controlChange", &stk::Whistle::controlChange)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Whistle::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Whistle::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+static void register_Wurley(lua_State* L)
+{
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+            .beginClass <stk::Wurley> ("Wurley")
+                .addConstructor<void ()> ()
+                .addFunction("setFrequency", &stk::Wurley::setFrequency)
+                .addFunction("noteOn", &stk::Wurley::noteOn)
+                .addFunction("tick", 
+                    luabridge::overload<unsigned int>(&stk::Wurley::tick),
+                    luabridge::overload<stk::StkFrames&, unsigned int>(&stk::Wurley::tick))
+            .endClass()
+        .endNamespace();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+typedef struct _stk_binding {
+    const char* name;
+    void (*reg)(lua_State* L);
+} t_stk_binding;
+
+// sorted by name for the binary search in stk_lazy_index
+static const t_stk_binding stk_bindings[] = {
+    { "ADSR", register_ADSR },
+    { "Asymp", register_Asymp },
+    { "BandedWG", register_BandedWG },
+    { "BeeThree", register_BeeThree },
+    { "BiQuad", register_BiQuad },
+    { "Blit", register_Blit },
+    { "BlitSaw", register_BlitSaw },
+    { "BlitSquare", register_BlitSquare },
+    { "BlowBotl", register_BlowBotl },
+    { "BlowHole", register_BlowHole },
+    { "BowTable", register_BowTable },
+    { "Bowed", register_Bowed },
+    { "Brass", register_Brass },
+    { "Chorus", register_Chorus },
+    { "Clarinet", register_Clarinet },
+    { "Cubic", register_Cubic },
+    { "Delay", register_Delay },
+    { "DelayA", register_DelayA },
+    { "DelayL", register_DelayL },
+    { "Drummer", register_Drummer },
+    { "Echo", register_Echo },
+    { "Envelope", register_Envelope },
+    { "FMVoices", register_FMVoices },
+    { "Flute", register_Flute },
+    { "FormSwep", register_FormSwep },
+    { "FreeVerb", register_FreeVerb },
+    { "Granulate", register_Granulate },
+    { "Guitar", register_Guitar },
+    { "HevyMetl", register_HevyMetl },
+    { "JCRev", register_JCRev },
+    { "JetTable", register_JetTable },
+    { "LentPitShift", register_LentPitShift },
+    { "Mandolin", register_Mandolin },
+    { "Mesh2D", register_Mesh2D },
+    { "Modulate", register_Modulate },
+    { "Moog", register_Moog },
+    { "NRev", register_NRev },
+    { "Noise", register_Noise },
+    { "OnePole", register_OnePole },
+    { "OneZero", register_OneZero },
+    { "PRCRev", register_PRCRev },
+    { "PercFlut", register_PercFlut },
+    { "PitShift", register_PitShift },
+    { "Plucked", register_Plucked },
+    { "PoleZero", register_PoleZero },
+    { "Recorder", register_Recorder },
+    { "ReedTable", register_ReedTable },
+    { "Resonate", register_Resonate },
+    { "Rhodey", register_Rhodey },
+    { "Saxofony", register_Saxofony },
+    { "Shakers", register_Shakers },
+    { "Simple", register_Simple },
+    { "SineWave", register_SineWave },
+    { "SingWave", register_SingWave },
+    { "Sitar", register_Sitar },
+    { "Sphere", register_Sphere },
+    { "StifKarp", register_StifKarp },
+    { "TapDelay", register_TapDelay },
+    { "TubeBell", register_TubeBell },
+    { "Twang", register_Twang },
+    { "TwoPole", register_TwoPole },
+    { "TwoZero", register_TwoZero },
+    { "VoicForm", register_VoicForm },
+    { "Voicer", register_Voicer },
+    { "Whistle", register_Whistle },
+    { "Wurley", register_Wurley },
+};
+
+static const int stk_bindings_count = sizeof(stk_bindings) / sizeof(stk_bindings[0]);
+
+
+static const t_stk_binding* stk_find_binding(const char* name)
+{
+    int lo = 0;
+    int hi = stk_bindings_count - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(name, stk_bindings[mid].name);
+        if (cmp == 0) {
+            return &stk_bindings[mid];
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+
+// __index of the `stk` namespace: registers a class on first access
+static int stk_lazy_index(lua_State* L)
+{
+    const char* name = lua_tostring(L, 2);
+    const t_stk_binding* binding = name ? stk_find_binding(name) : NULL;
+
+    if (binding == NULL) {
+        lua_pushnil(L);
+        return 1;
+    }
+    binding->reg(L);    // rawsets the class table into `stk`
+    lua_pushvalue(L, 2);
+    lua_rawget(L, 1);
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+
+void stk_bindings_register(lua_State* L)
+{
+    for (int i = 0; i < stk_bindings_count; i++) {
+        stk_bindings[i].reg(L);
+    }
+}
+
+
+void stk_bindings_register_lazy(lua_State* L)
+{
+    // create the (empty) namespace, then take over its __index metamethod:
+    // the namespace table is its own metatable
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("stk")
+        .endNamespace();
+
+    lua_getglobal(L, "stk");
+    lua_pushliteral(L, "__index");
+    lua_pushcfunction(L, stk_lazy_index);
+    lua_rawset(L, -3);
+    lua_pop(L, 1);
+}
+
+
+void stk_bindings_samplerate(double samplerate)
+{
+    // objects which depend on the rate are told about changes, so only change it
+    if (samplerate > 0.0 && samplerate != stk::Stk::sampleRate()) {
+        stk::Stk::setSampleRate(samplerate);
+    }
+}
@@ -0,0 +1,20 @@
+/**
+    @file
+    stk_bindings: luabridge bindings of the stk classes for luajit.stk~
+*/
+
+#ifndef STK_BINDINGS_H
+#define STK_BINDINGS_H
+
+#include "lua.hpp"
+
+// register every stk class in the `stk` namespace
+void stk_bindings_register(lua_State* L);
+
+// register each stk class the first time `stk.<Name>` is accessed
+void stk_bindings_register_lazy(lua_State* L);
+
+// stk's sample rate, shared by every instance in the process
+void stk_bindings_samplerate(double samplerate);
+
+#endif // STK_BINDINGS_H
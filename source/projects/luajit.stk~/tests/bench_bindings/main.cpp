@@ -0,0 +1,64 @@
+// main.cpp
+//
+// Per-instance construction time and lua heap size of luajit.stk~'s stk
+// bindings, registering every class eagerly versus lazily on first access.
+//
+//     ./main [instances=100]
+
+#include "lua.hpp"
+
+#include "stk_bindings.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// what a typical script touches: two classes out of ~70
+static const char* script =
+    "local sine = stk.SineWave()\n"
+    "local delay = stk.Delay(9, 4096)\n"
+    "sine:setFrequency(220)\n"
+    "delay:tick(sine:tick())\n";
+
+
+static void bench(const char* label, int instances, void (*reg)(lua_State*))
+{
+    std::vector<lua_State*> states;
+    double kbytes = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < instances; i++) {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        reg(L);
+        if (luaL_dostring(L, script)) {
+            std::cerr << lua_tostring(L, -1) << std::endl;
+            std::exit(1);
+        }
+        states.push_back(L);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (lua_State* L : states) {
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        kbytes += lua_gc(L, LUA_GCCOUNT, 0) + lua_gc(L, LUA_GCCOUNTB, 0) / 1024.0;
+        lua_close(L);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    std::cout << label << ": "
+              << ms / instances << " ms/instance, "
+              << kbytes / instances << " KB/instance" << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    int instances = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    std::cout << "instances: " << instances << std::endl;
+    bench("eager", instances, stk_bindings_register);
+    bench("lazy ", instances, stk_bindings_register_lazy);
+    return 0;
+}
@@ -11,11 +11,30 @@
 #include <lualib.h>
 #include <lauxlib.h>
 
+#include "libdsp.h"
+#include "bccache.h"
+#include "embedded.h"
+#include "idle.h"
+#include "blockops.h"
+#include "params.h"
+#include "events.h"
+#include "buffers.h"
+#include "oversample.h"
+#include "retire.h"
+
 #include <libgen.h>
+#include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 #define USE_LUA 1
 
+// block function compiled from lua by dsp_native.lua (registered in NATIVE)
+typedef void (*t_native_block)(const double *in, double *out, long frames, double *v1, double p1);
+
+// lua block functions (registered in BLOCKS, e.g. by dsp_graph.lua) are called
+// once per vector as fn(in, out, frames, param1) with in/out as lightuserdata
+
 
 // struct to represent the object's state
 typedef struct _mlj {
@@ -23,21 +42,74 @@ typedef struct _mlj {
     lua_State *L;       // lua state
     t_symbol* filename; // filename of lua file in Max search path
     t_symbol* funcname; // name of lua dsp function to use
+    t_symbol* chain;    // space separated function names of a `chain` (or NULL)
     double param1;      // the value of a property of our object
     double v1;          // historical value;
+    t_native_block native; // compiled version of funcname (or NULL)
+    long use_native;    // use compiled functions when available
+    int block_ref;      // registry ref of the block function in use (or LUA_NOREF)
+    long generator;     // the function ignores its input (listed in GENERATORS)
+    long bypass;        // pass the input through without running lua
+    t_idle idle;        // `sleep` on silent input
+    double samplerate;
+    long sanitize;      // replace non-finite output and reset the feedback state
+    long stat_vectors;  // vectors processed (for `stats`)
+    long stat_slept;    // vectors skipped by `sleep`
+    long stat_incidents; // vectors with non-finite output
+    long stat_nonfinite; // non-finite samples replaced
+    t_params params;    // named parameters declared by the script (P in lua)
+    t_events *events;   // timestamped `event` messages for perform
+    int64_t clock;      // sample time of the next vector
+    t_buffers *buffers; // buffer~ objects bound by the script
+    long maxframes;     // largest vector size, for the oversampling buffers
+    long oversample_factor;     // `oversample` attribute
+    t_oversample *oversample;   // resampler in use (or NULL)
+    long oversample_applied;    // factor last set in OVERSAMPLE
+    double samplerate_applied;  // rate last set in SAMPLE_RATE, oversampled
+    t_retire retire;            // replaced block refs and resamplers perform may still use
+    void *latency_out;          // `latency` in samples
 } t_mlj;
 
 
 // method prototypes
 void *mlj_new(t_symbol *s, long argc, t_atom *argv);
 void mlj_init_lua(t_mlj *x);
+void mlj_init_package(t_mlj *x);
 void mlj_free(t_mlj *x);
+t_max_err mlj_notify(t_mlj *x, t_symbol *s, t_symbol *msg, void *sender, void *data);
 void mlj_assist(t_mlj *x, void *b, long m, long a, char *s);
 void mlj_bang(t_mlj *x);
 void mlj_anything(t_mlj* x, t_symbol* s, long argc, t_atom* argv);
 void mlj_float(t_mlj *x, double f);
+void mlj_native(t_mlj *x, long n);
+void mlj_bypass(t_mlj *x, long n);
+void mlj_sleep(t_mlj *x, t_symbol *s, long argc, t_atom *argv);
+void mlj_sanitize(t_mlj *x, long n);
+void mlj_stats(t_mlj *x);
+void mlj_latency(t_mlj *x);
+t_max_err mlj_oversample_set(t_mlj *x, void *attr, long argc, t_atom *argv);
+void mlj_oversample_build(t_mlj *x);
+void mlj_oversample_apply(t_mlj *x, t_oversample *os);
+void mlj_set(t_mlj *x, t_symbol *s, long argc, t_atom *argv);
+void mlj_event(t_mlj *x, t_symbol *s, long argc, t_atom *argv);
+void mlj_chain(t_mlj *x, t_symbol *s, long argc, t_atom *argv);
+void mlj_resolve(t_mlj *x);
+void mlj_swap_block(t_mlj *x, int ref);
 void mlj_dsp64(t_mlj *x, t_object *dsp64, short *count, double samplerate, long maxvectorsize, long flags);
+#if defined USE_LUA
+// processes part of a vector, see mlj_run
+typedef void (*t_mlj_segment)(t_mlj *x, double *in, double *sc, double *out, long frames);
+void mlj_process_sidechain(t_mlj *x, double *in, double *sc, double *out, long frames);
+
+void mlj_perform64_guarded(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+void mlj_perform64_bypass(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+void mlj_perform64_unheard(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+void mlj_perform64_sidechain(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+void mlj_perform64_generator(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+void mlj_perform64_effect(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+#else
 void mlj_perform64(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam);
+#endif
 
 t_string* get_path_from_package(t_class* c, char* subpath);
 
@@ -62,7 +134,7 @@ int run_lua_string(t_mlj *x, const char* code)
 int run_lua_file(t_mlj *x, const char* path)
 {
     int err;
-    err = luaL_dofile(x->L, path);
+    err = bccache_loadfile(x->L, path) || lua_pcall(x->L, 0, LUA_MULTRET, 0);
     if (err) {
         error("%s", lua_tostring(x->L, -1));
         lua_pop(x->L, 1);  /* pop error message from the stack */
@@ -70,6 +142,21 @@ int run_lua_file(t_mlj *x, const char* path)
     return 0; 
 }
 
+void lua_dsp_block(t_mlj *x, int ref, double *in, double *out, long frames)
+{
+    lua_rawgeti(x->L, LUA_REGISTRYINDEX, ref);
+    lua_pushlightuserdata(x->L, in);
+    lua_pushlightuserdata(x->L, out);
+    lua_pushnumber(x->L, frames);
+    lua_pushnumber(x->L, x->param1);
+    if (lua_pcall(x->L, 4, 0, 0)) {
+        // keep the error visible but don't take the audio thread down
+        error("%s", lua_tostring(x->L, -1));
+        lua_pop(x->L, 1);
+        memset(out, 0, frames * sizeof(double));
+    }
+}
+
 float lua_dsp(t_mlj *x, float audio_in, float audio_prev, float n_samples, float param1) {
    lua_getglobal(x->L, x->funcname->s_name);
    lua_pushnumber(x->L, audio_in);
@@ -84,6 +171,41 @@ float lua_dsp(t_mlj *x, float audio_in, float audio_prev, float n_samples, float
    return result;
 }
 
+float lua_dsp_sidechain(t_mlj *x, float audio_in, float audio_prev, float n_samples, float param1, float sidechain) {
+   lua_getglobal(x->L, x->funcname->s_name);
+   lua_pushnumber(x->L, audio_in);
+   lua_pushnumber(x->L, audio_prev);
+   lua_pushnumber(x->L, n_samples);
+   lua_pushnumber(x->L, param1);
+   lua_pushnumber(x->L, sidechain);
+   lua_call(x->L, 5, 1);
+   float result = (float)lua_tonumber(x->L, -1);
+   lua_pop(x->L, 1);
+   return result;
+}
+
+
+// EVENTS[name](args...) at the event's sample
+void mlj_dispatch(t_mlj *x, const t_event *ev)
+{
+    lua_getglobal(x->L, "EVENTS");
+    if (lua_istable(x->L, -1)) {
+        lua_getfield(x->L, -1, ev->name);
+        if (lua_isfunction(x->L, -1)) {
+            for (int i = 0; i < ev->argc; i++) {
+                lua_pushnumber(x->L, ev->argv[i]);
+            }
+            if (lua_pcall(x->L, ev->argc, 0, 0)) {
+                error("%s", lua_tostring(x->L, -1));
+                lua_pop(x->L, 1);
+            }
+        } else {
+            lua_pop(x->L, 1);
+        }
+    }
+    lua_pop(x->L, 1);
+}
+
 
 t_string* get_path_from_external(t_class* c, char* subpath)
 {
@@ -138,8 +260,24 @@ void ext_main(void *r)
     class_addmethod(c, (method)mlj_float,    "float",    A_FLOAT, 0);
     class_addmethod(c, (method)mlj_anything, "anything", A_GIMME, 0);
     class_addmethod(c, (method)mlj_bang,     "bang",              0);
+    class_addmethod(c, (method)mlj_native,   "native",   A_LONG,  0);
+    class_addmethod(c, (method)mlj_chain,    "chain",    A_GIMME, 0);
+    class_addmethod(c, (method)mlj_bypass,   "bypass",   A_LONG,  0);
+    class_addmethod(c, (method)mlj_sleep,    "sleep",    A_GIMME, 0);
+    class_addmethod(c, (method)mlj_sanitize, "sanitize", A_LONG,  0);
+    class_addmethod(c, (method)mlj_stats,    "stats",             0);
+    class_addmethod(c, (method)mlj_latency,  "latency",           0);
+    class_addmethod(c, (method)mlj_set,      "set",      A_GIMME, 0);
+    class_addmethod(c, (method)mlj_event,    "event",    A_GIMME, 0);
     class_addmethod(c, (method)mlj_dsp64,    "dsp64",    A_CANT,  0);
     class_addmethod(c, (method)mlj_assist,   "assist",   A_CANT,  0);
+    class_addmethod(c, (method)mlj_notify,   "notify",   A_CANT,  0);
+
+    // `oversample 2|4|8` runs the function at that multiple of the sample rate
+    CLASS_ATTR_LONG(c, "oversample", 0, t_mlj, oversample_factor);
+    CLASS_ATTR_ACCESSORS(c, "oversample", NULL, mlj_oversample_set);
+    CLASS_ATTR_ENUM(c, "oversample", 0, "1 2 4 8");
+    CLASS_ATTR_LABEL(c, "oversample", 0, "Oversampling Factor");
 
     class_dspinit(c);
     class_register(CLASS_BOX, c);
@@ -164,6 +302,138 @@ void mlj_run_file(t_mlj *x)
             run_lua_file(x, lua_file);
         }
     }    
+    if (params_declare(&x->params, x->L) != 0) {
+        error("%s", lua_tostring(x->L, -1));
+        lua_pop(x->L, 1);
+    }
+    mlj_resolve(x);
+}
+
+
+// build the fused closure of x->chain with dsp_graph.chain, returns its registry ref
+int mlj_build_chain(t_mlj *x)
+{
+    lua_getglobal(x->L, "require");
+    lua_pushliteral(x->L, "dsp_graph");
+    if (lua_pcall(x->L, 1, 1, 0) == 0) {
+        lua_getfield(x->L, -1, "chain");
+        lua_remove(x->L, -2);
+        lua_pushstring(x->L, x->chain->s_name);
+        if (lua_pcall(x->L, 1, 1, 0) == 0) {
+            return luaL_ref(x->L, LUA_REGISTRYINDEX);
+        }
+    }
+    error("%s", lua_tostring(x->L, -1));
+    lua_pop(x->L, 1);
+    return LUA_NOREF;
+}
+
+
+// GENERATORS[name] of the script: functions which don't use their input
+long mlj_is_generator(t_mlj *x, const char *name, size_t len)
+{
+    long result = 0;
+
+    lua_getglobal(x->L, "GENERATORS");
+    if (lua_istable(x->L, -1)) {
+        lua_pushlstring(x->L, name, len);
+        lua_gettable(x->L, -2);
+        result = lua_toboolean(x->L, -1);
+        lua_pop(x->L, 1);
+    }
+    lua_pop(x->L, 1);
+    return result;
+}
+
+
+void mlj_resolve(t_mlj *x)
+{
+    t_native_block fn = NULL;
+    int ref = LUA_NOREF;
+
+    if (x->chain) {     // a chain generates if its first stage does
+        const char *names = x->chain->s_name;
+        x->generator = mlj_is_generator(x, names, strcspn(names, " "));
+        mlj_swap_block(x, mlj_build_chain(x));
+        x->native = NULL;
+        return;
+    }
+
+    if (x->use_native) {
+        lua_getglobal(x->L, "NATIVE");
+        if (lua_istable(x->L, -1)) {
+            lua_getfield(x->L, -1, x->funcname->s_name);
+            if (lua_isnumber(x->L, -1)) {
+                fn = (t_native_block)(uintptr_t)lua_tonumber(x->L, -1);
+            }
+            lua_pop(x->L, 1);
+        }
+        lua_pop(x->L, 1);
+    }
+    if (fn == NULL) {
+        lua_getglobal(x->L, "BLOCKS");
+        if (lua_istable(x->L, -1)) {
+            lua_getfield(x->L, -1, x->funcname->s_name);
+            if (lua_isfunction(x->L, -1)) {
+                ref = luaL_ref(x->L, LUA_REGISTRYINDEX);
+            } else {
+                lua_pop(x->L, 1);
+            }
+        }
+        lua_pop(x->L, 1);
+    }
+    mlj_swap_block(x, ref);
+    x->native = fn;
+    x->generator = mlj_is_generator(x, x->funcname->s_name, strlen(x->funcname->s_name));
+}
+
+
+void mlj_block_release(void *ctx, void *ptr)
+{
+    luaL_unref((lua_State *)ctx, LUA_REGISTRYINDEX, (int)(intptr_t)ptr);
+}
+
+
+void mlj_swap_block(t_mlj *x, int ref)
+{
+    // perform reads block_ref once per segment, so a single store switches it
+    // over; the replaced closure stays referenced until no vector can be
+    // running it
+    int old = x->block_ref;
+    x->block_ref = ref;
+    if (old != LUA_NOREF) {
+        retire_push(&x->retire, mlj_block_release, x->L, (void *)(intptr_t)old);
+    }
+}
+
+
+void mlj_init_package(t_mlj *x)
+{
+    // make the package's lua modules and libdsp available to `require`
+    t_string* examples = get_path_from_package(mlj_class, "/examples/?.lua");
+    t_string* libdsp = get_path_from_package(mlj_class, "/support/" LIBDSP_FILENAME);
+    t_string* cache = get_path_from_package(mlj_class, "/cache");
+
+    lua_getglobal(x->L, "package");
+    lua_getfield(x->L, -1, "path");
+    lua_pushfstring(x->L, "%s;%s", lua_tostring(x->L, -1), string_getptr(examples));
+    lua_setfield(x->L, -3, "path");
+    lua_pop(x->L, 2);
+
+    lua_pushstring(x->L, string_getptr(libdsp));
+    lua_setglobal(x->L, "LIBDSP_PATH");
+
+    // stock modules are preloaded from bytecode linked into the external
+    embedded_install(x->L);
+
+    // scripts and other required modules are loaded through the bytecode cache
+    bccache_install(x->L, string_getptr(cache));
+    lua_pushstring(x->L, string_getptr(cache));
+    lua_setglobal(x->L, "CACHE_DIR");
+
+    object_free(examples);
+    object_free(libdsp);
+    object_free(cache);
 }
 
 
@@ -171,6 +441,12 @@ void mlj_init_lua(t_mlj *x)
 {
     x->L = luaL_newstate();
     luaL_openlibs(x->L);  /* opens the standard libraries */
+    lua_pushinteger(x->L, x->oversample_applied);
+    lua_setglobal(x->L, "OVERSAMPLE");
+    lua_pushnumber(x->L, x->samplerate_applied);
+    lua_setglobal(x->L, "SAMPLE_RATE");
+    mlj_init_package(x);
+    buffers_install(x->buffers, x->L);
     mlj_run_file(x);
 }
 
@@ -180,18 +456,43 @@ void *mlj_new(t_symbol *s, long argc, t_atom *argv)
     t_mlj *x = (t_mlj *)object_alloc(mlj_class);
 
     if (x) {
-        dsp_setup((t_pxobject *)x, 1);  // MSP inlets: arg is # of inlets and is REQUIRED!
-        // use 0 if you don't need inlets
+        dsp_setup((t_pxobject *)x, 2);  // MSP inlets: arg is # of inlets and is REQUIRED!
+        // use 0 if you don't need inlets (the 2nd is an optional sidechain)
 
+        x->latency_out = outlet_new(x, NULL);  // created first: outlets are added right to left
         outlet_new(x, "signal");        // signal outlet (note "signal" rather than NULL)
         x->param1 = 0.0;
         x->v1 = 0.0;
+        x->native = NULL;
+        x->use_native = 1;
+        x->block_ref = LUA_NOREF;
+        x->chain = NULL;
+        x->generator = 0;
+        x->bypass = 0;
+        x->samplerate = sys_getsr();
+        idle_init(&x->idle);
+        x->sanitize = 1;
+        x->stat_vectors = 0;
+        x->stat_slept = 0;
+        x->stat_incidents = 0;
+        x->stat_nonfinite = 0;
+        params_init(&x->params);
+        x->events = events_new(256);
+        x->clock = 0;
+        x->buffers = buffers_new((t_object *)x);
+        x->maxframes = sys_getblksize();
+        x->oversample_factor = 1;
+        x->oversample = NULL;
+        x->oversample_applied = 1;
+        x->samplerate_applied = x->samplerate;
+        retire_init(&x->retire);
         x->filename = atom_getsymarg(0, argc, argv); // 1st arg of object
         x->funcname = gensym("base");
         post("filename: %s", x->filename->s_name);
 
         // init lua
         mlj_init_lua(x);
+        attr_args_process(x, (short)argc, argv);
     }
     return (x);
 }
@@ -199,8 +500,21 @@ void *mlj_new(t_symbol *s, long argc, t_atom *argv)
 
 void mlj_free(t_mlj *x)
 {
-    lua_close(x->L);
+    x->native = NULL;
     dsp_free((t_pxobject *)x);
+    retire_flush(&x->retire);
+    params_free(&x->params);
+    lua_close(x->L);
+    events_free(x->events);
+    buffers_free(x->buffers);
+    oversample_free(x->oversample);
+}
+
+
+// keeps the buffer~ references of the script up to date
+t_max_err mlj_notify(t_mlj *x, t_symbol *s, t_symbol *msg, void *sender, void *data)
+{
+    return buffers_notify(x->buffers, s, msg, sender, data);
 }
 
 
@@ -209,7 +523,10 @@ void mlj_assist(t_mlj *x, void *b, long m, long a, char *s)
     if (m == ASSIST_INLET) { //inlet
         sprintf(s, "I am inlet %ld", a);
     }
-    else {  // outlet
+    else if (a == 1) {  // outlet
+        sprintf(s, "latency in samples, on `latency`");
+    }
+    else {
         sprintf(s, "I am outlet %ld", a);
     }
 }
@@ -225,6 +542,225 @@ void mlj_anything(t_mlj* x, t_symbol* s, long argc, t_atom* argv)
     if (s != gensym("")) {
         post("funcname: %s", s->s_name);
         x->funcname = s;
+        x->chain = NULL;
+        mlj_resolve(x);
+    }
+}
+
+
+void mlj_native(t_mlj *x, long n)
+{
+    x->use_native = n != 0;
+    mlj_resolve(x);
+    post("native: %s", x->native ? "on" : "off");
+}
+
+
+void mlj_chain(t_mlj *x, t_symbol *s, long argc, t_atom *argv)
+{
+    t_string* names;
+
+    for (long i = 0; i < argc; i++) {
+        if (atom_gettype(argv + i) != A_SYM) {
+            error("chain: expects function names, argument %ld is not one", i + 1);
+            return;
+        }
+    }
+    names = string_new("");
+    for (long i = 0; i < argc; i++) {
+        if (i > 0) {
+            string_append(names, " ");
+        }
+        string_append(names, atom_getsym(argv + i)->s_name);
+    }
+    // `chain` without names goes back to funcname
+    x->chain = argc ? gensym(string_getptr(names)) : NULL;
+    object_free(names);
+
+    post("chain: %s", x->chain ? x->chain->s_name : "off");
+    mlj_resolve(x);
+}
+
+
+void mlj_bypass(t_mlj *x, long n)
+{
+    x->bypass = n != 0;
+    post("bypass: %s", x->bypass ? "on" : "off");
+}
+
+
+// sleep <hold ms> [threshold dBFS]: stop running lua once the input has been
+// silent for the hold time and the output has decayed, `sleep 0` turns it off
+void mlj_sleep(t_mlj *x, t_symbol *s, long argc, t_atom *argv)
+{
+    double hold_ms = argc > 0 ? atom_getfloat(argv) : 0.0;
+    double threshold_db = argc > 1 ? atom_getfloat(argv + 1) : -90.0;
+
+    idle_configure(&x->idle, hold_ms, threshold_db, x->samplerate);
+    if (hold_ms > 0.0) {
+        post("sleep: after %.0f ms below %.1f dB", hold_ms, threshold_db);
+    } else {
+        post("sleep: off");
+    }
+}
+
+
+void mlj_sanitize(t_mlj *x, long n)
+{
+    x->sanitize = n != 0;
+    post("sanitize: %s", x->sanitize ? "on" : "off");
+}
+
+
+// set <name> <value>: a parameter declared in the script's PARAMS
+void mlj_set(t_mlj *x, t_symbol *s, long argc, t_atom *argv)
+{
+    if (argc < 2 || atom_gettype(argv) != A_SYM) {
+        error("set: expects a parameter name and a value");
+        return;
+    }
+    t_symbol *name = atom_getsym(argv);
+    if (params_set(&x->params, name->s_name, atom_getfloat(argv + 1)) != 0) {
+        error("set: no parameter '%s' in PARAMS", name->s_name);
+    }
+}
+
+
+// event <name> [numbers...]: calls EVENTS[name](numbers...) in perform at the
+// sample matching the scheduler time the message arrived at (one vector later)
+void mlj_event(t_mlj *x, t_symbol *s, long argc, t_atom *argv)
+{
+    t_event ev;
+
+    if (argc < 1 || atom_gettype(argv) != A_SYM) {
+        error("event: expects a handler name");
+        return;
+    }
+    ev.name = atom_getsym(argv)->s_name;
+    ev.argc = 0;
+    for (long i = 1; i < argc && ev.argc < EVENTS_MAX_ARGS; i++) {
+        ev.argv[ev.argc++] = atom_getfloat(argv + i);
+    }
+
+    if (!sys_getdspstate()) {   // no perform to deliver it: run it now
+        mlj_dispatch(x, &ev);
+        return;
+    }
+    ev.time = events_time(x->events, gettime_forobject((t_object *)x));
+    if (events_push(x->events, &ev) != 0) {
+        error("event: queue full, dropped '%s'", ev.name);
+    }
+}
+
+
+void mlj_stats(t_mlj *x)
+{
+    post("stats: %ld vectors, %ld asleep, %ld with non-finite output (%ld samples replaced)",
+         x->stat_vectors, x->stat_slept, x->stat_incidents, x->stat_nonfinite);
+}
+
+
+// LATENCY[name] of the script: output delay in samples of block functions,
+// summed over the stages of a chain, plus that of oversampling, sent out of
+// the right outlet (e.g. to set a plugin's reported delay or a compensating
+// delay line)
+void mlj_latency(t_mlj *x)
+{
+    const char *names = x->chain ? x->chain->s_name : x->funcname->s_name;
+    t_oversample *os = x->oversample;
+    double samples = 0.0;
+
+    lua_getglobal(x->L, "LATENCY");
+    if (lua_istable(x->L, -1)) {
+        while (*names) {
+            size_t len = strcspn(names, " ");
+            lua_pushlstring(x->L, names, len);
+            lua_gettable(x->L, -2);
+            samples += lua_tonumber(x->L, -1);
+            lua_pop(x->L, 1);
+            names += len + (names[len] == ' ');
+        }
+    }
+    lua_pop(x->L, 1);
+    if (os) {   // functions count samples at the oversampled rate
+        samples = samples / oversample_factor(os) + oversample_latency(os);
+    }
+    post("latency: %.2f samples (%.2f ms)", samples,
+         x->samplerate > 0 ? samples * 1000.0 / x->samplerate : 0.0);
+    outlet_float(x->latency_out, samples);
+}
+
+
+// `oversample 2|4|8` runs the function at that multiple of the sample rate,
+// `oversample 1` turns it off
+t_max_err mlj_oversample_set(t_mlj *x, void *attr, long argc, t_atom *argv)
+{
+    long n = argc ? (long)atom_getlong(argv) : 1;
+
+    if (n != 1 && n != 2 && n != 4 && n != 8) {
+        error("oversample: 1, 2, 4 or 8");
+        return MAX_ERR_GENERIC;
+    }
+    x->oversample_factor = n;
+    mlj_oversample_build(x);
+
+    if (!sys_getdspstate()) {   // no perform to pick it up: tell the script now
+        mlj_oversample_apply(x, x->oversample);
+    }
+    if (x->oversample) {
+        post("oversample: %ldx, latency %.2f samples", n, oversample_latency(x->oversample));
+    } else {
+        post("oversample: off");
+    }
+    return MAX_ERR_NONE;
+}
+
+
+void mlj_oversample_release(void *ctx, void *ptr)
+{
+    oversample_free((t_oversample *)ptr);
+}
+
+
+void mlj_oversample_build(t_mlj *x)
+{
+    t_oversample *os = NULL;
+
+    if (x->oversample_factor > 1) {
+        // signal and sidechain
+        os = oversample_new(x->oversample_factor, x->maxframes, 2);
+        if (os == NULL) {
+            error("oversample: out of memory");
+        }
+    }
+    // perform reads the pointer once per vector, the replaced resampler is
+    // freed once no vector can be running it
+    t_oversample *old = x->oversample;
+    x->oversample = os;
+    if (old) {
+        retire_push(&x->retire, mlj_oversample_release, NULL, old);
+    }
+}
+
+
+// scripts with rate dependent functions read the factor of the resampler in
+// use from OVERSAMPLE, and the rate they run at (the one of dsp64 times the
+// factor) from SAMPLE_RATE; perform sets them with the vector's snapshot of
+// the resampler, so lua never sees them change under a running function
+void mlj_oversample_apply(t_mlj *x, t_oversample *os)
+{
+    long factor = os ? oversample_factor(os) : 1;
+    double samplerate = x->samplerate * factor;
+
+    if (factor != x->oversample_applied) {
+        lua_pushinteger(x->L, factor);
+        lua_setglobal(x->L, "OVERSAMPLE");
+        x->oversample_applied = factor;
+    }
+    if (samplerate != x->samplerate_applied) {
+        lua_pushnumber(x->L, samplerate);
+        lua_setglobal(x->L, "SAMPLE_RATE");
+        x->samplerate_applied = samplerate;
     }
 }
 
@@ -241,26 +777,256 @@ void mlj_dsp64(t_mlj *x, t_object *dsp64, short *count, double samplerate, long
     post("sample rate: %f", samplerate);
     post("maxvectorsize: %d", maxvectorsize);
 
+    x->samplerate = samplerate;
+    idle_samplerate(&x->idle, samplerate);
+    params_prepare(&x->params, samplerate, maxvectorsize);
+    if (maxvectorsize != x->maxframes) {
+        x->maxframes = maxvectorsize;
+        mlj_oversample_build(x);
+    }
+
+#if defined USE_LUA
+    // count[] is 0 for unconnected signal inlets/outlets: 0 input, 1 sidechain, 2 output
+    t_perfroutine64 perform;
+
+    if (!count[2]) {
+        perform = (t_perfroutine64)mlj_perform64_unheard;
+    } else if (x->bypass) {
+        perform = (t_perfroutine64)mlj_perform64_bypass;
+    } else if (!count[0]) {
+        perform = (t_perfroutine64)mlj_perform64_generator;
+    } else if (count[1]) {
+        perform = (t_perfroutine64)mlj_perform64_sidechain;
+    } else {
+        perform = (t_perfroutine64)mlj_perform64_effect;
+    }
+    // the selected routine runs inside the guard, passed as userparam
+    object_method(dsp64, gensym("dsp_add64"), x, mlj_perform64_guarded, 0, perform);
+#else
     object_method(dsp64, gensym("dsp_add64"), x, mlj_perform64, 0, NULL);
+#endif
 }
 
 
 #if defined USE_LUA
 
-void mlj_perform64(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+// runs the perform routine in userparam with denormals flushed to zero, then
+// replaces NaN/Inf in its output so they can't stick in the feedback state
+void mlj_perform64_guarded(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
 {
-    t_double *inL = ins[0];     // we get audio for each inlet of the object from the **ins argument
-    t_double *outL = outs[0];   // we get audio for each outlet of the object from the **outs argument
-    int n = sampleframes;       // n = 64
+    t_perfroutine64 perform = (t_perfroutine64)userparam;
+    t_blockops_fpstate fp = blockops_ftz_enter();
+
+    events_clock(x->events, x->clock, gettime_forobject((t_object *)x), x->samplerate, sampleframes);
+    params_tick(&x->params);
+    buffers_lock(x->buffers);
+    perform((t_object *)x, dsp64, ins, numins, outs, numouts, sampleframes, flags, NULL);
+    buffers_unlock(x->buffers);
+    x->clock += sampleframes;
+    retire_vector(&x->retire);
+
+    if (x->sanitize) {
+        long bad = blockops_sanitize(outs[0], sampleframes);
+        if (bad) {
+            x->v1 = 0.0;
+            x->stat_incidents++;
+            x->stat_nonfinite += bad;
+        }
+    }
+    x->stat_vectors++;
+    blockops_ftz_exit(fp);
+}
+
+
+// events due in a vector which doesn't run lua are dropped
+void mlj_drop_events(t_mlj *x, long frames)
+{
+    t_event ev;
+
+    while (events_next(x->events, x->clock + frames, &ev)) {
+    }
+}
+
+
+// run segment once, on the upsampled signal when oversampling: its output
+// is filtered back down into out
+void mlj_run_segment(t_mlj *x, t_oversample *os, t_mlj_segment segment, double *in, double *sc, double *out, long frames)
+{
+    double *high;
+
+    if (os == NULL) {
+        segment(x, in, sc, out, frames);
+        return;
+    }
+    high = oversample_up(os, 0, in, frames);
+    if (segment == mlj_process_sidechain) {
+        sc = oversample_up(os, 1, sc, frames);
+    }
+    segment(x, high, sc, high, frames * oversample_factor(os));
+    oversample_down(os, 0, high, out, frames);
+}
+
+
+// run segment over a vector, split at the sample offsets of the events due in it
+void mlj_run(t_mlj *x, t_mlj_segment segment, double *in, double *sc, double *out, long frames)
+{
+    t_oversample *os = x->oversample;
+    int64_t start = x->clock;
+    long pos = 0;
+    t_event ev;
+
+    mlj_oversample_apply(x, os);
+    while (events_next(x->events, start + frames, &ev)) {
+        long offset = ev.time > start ? (long)(ev.time - start) : 0;
+        if (offset > pos) {
+            mlj_run_segment(x, os, segment, in + pos, sc + pos, out + pos, offset - pos);
+            pos = offset;
+        }
+        mlj_dispatch(x, &ev);
+    }
+    if (pos < frames) {
+        mlj_run_segment(x, os, segment, in + pos, sc + pos, out + pos, frames - pos);
+    }
+}
+
+
+// `bypass 1`: the input passes through unchanged, no lua calls
+void mlj_perform64_bypass(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    mlj_drop_events(x, sampleframes);
+    if (outs[0] != ins[0]) {    // msp may process in place
+        memcpy(outs[0], ins[0], sampleframes * sizeof(double));
+    }
+}
+
+
+// nothing listens: no lua calls, but the guard still keeps time, so events,
+// parameter smoothing and retired blocks don't wait for a connection
+void mlj_perform64_unheard(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    mlj_drop_events(x, sampleframes);
+    memset(outs[0], 0, sampleframes * sizeof(double));
+}
+
+
+// run the selected function over (part of) a vector: compiled, lua block or per sample
+void mlj_process(t_mlj *x, double *in, double *sc, double *out, long frames)
+{
+    int block = x->block_ref;
+    int n = frames;
     double v1 = x->v1;
 
+    if (x->native) {            // compiled by dsp_native.lua: no lua calls
+        x->native(in, out, frames, &x->v1, x->param1);
+        return;
+    }
+    if (block != LUA_NOREF) {   // one lua call per vector
+        lua_dsp_block(x, block, in, out, frames);
+        return;
+    }
+
     while (n--) {
-        v1 = lua_dsp(x, *inL++, v1, n, x->param1);
-        *outL++ = v1;
+        v1 = lua_dsp(x, *in++, v1, n, x->param1);
+        *out++ = v1;
+    }
+
+    x->v1 = v1;
+}
+
+
+// per-sample functions also get the sidechain sample as 5th argument,
+// fn(x, prev, n, p1, sc), block functions have no sidechain
+void mlj_process_sidechain(t_mlj *x, double *in, double *sc, double *out, long frames)
+{
+    int n = frames;
+    double v1 = x->v1;
+
+    if (x->native || x->block_ref != LUA_NOREF) {
+        mlj_process(x, in, sc, out, frames);
+        return;
+    }
+
+    while (n--) {
+        v1 = lua_dsp_sidechain(x, *in++, v1, n, x->param1, *sc++);
+        *out++ = v1;
     }
 
     x->v1 = v1;
+}
+
+
+// per-sample functions get 0 as input without reading it, block functions
+// read msp's zero vector of the unconnected inlet
+void mlj_process_generator(t_mlj *x, double *in, double *sc, double *out, long frames)
+{
+    int n = frames;
+    double v1 = x->v1;
+
+    if (x->native || x->block_ref != LUA_NOREF) {
+        mlj_process(x, in, sc, out, frames);
+        return;
+    }
+
+    while (n--) {
+        v1 = lua_dsp(x, 0.0, v1, n, x->param1);
+        *out++ = v1;
+    }
+
+    x->v1 = v1;
+}
+
+
+// input and sidechain connected
+void mlj_perform64_sidechain(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    if (x->bypass) {
+        mlj_perform64_bypass(x, dsp64, ins, numins, outs, numouts, sampleframes, flags, userparam);
+        return;
+    }
+    // a sidechain keying the function (a gate, a ducker) wakes it up too
+    if (!events_due(x->events, x->clock + sampleframes)
+        && idle_before_sidechain(&x->idle, ins[0], ins[1], sampleframes)) {
+        memset(outs[0], 0, sampleframes * sizeof(double));
+        x->stat_slept++;
+        return;
+    }
+
+    mlj_run(x, mlj_process_sidechain, ins[0], ins[1], outs[0], sampleframes);
+    idle_after(&x->idle, outs[0], sampleframes);
+}
+
+
+// input not connected: only functions listed in GENERATORS run
+void mlj_perform64_generator(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    if (x->bypass || !x->generator) {   // an effect without input: silence
+        mlj_drop_events(x, sampleframes);
+        memset(outs[0], 0, sampleframes * sizeof(double));
+        return;
+    }
+
+    mlj_run(x, mlj_process_generator, ins[0], ins[1], outs[0], sampleframes);
+}
+
+
+void mlj_perform64_effect(t_mlj *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+    t_double *inL = ins[0];     // we get audio for each inlet of the object from the **ins argument
+    t_double *outL = outs[0];   // we get audio for each outlet of the object from the **outs argument
+
+    if (x->bypass) {
+        mlj_perform64_bypass(x, dsp64, ins, numins, outs, numouts, sampleframes, flags, userparam);
+        return;
+    }
+    // asleep: no lua calls, unless an event is due
+    if (!events_due(x->events, x->clock + sampleframes) && idle_before(&x->idle, inL, sampleframes)) {
+        memset(outL, 0, sampleframes * sizeof(double));
+        x->stat_slept++;
+        return;
+    }
 
+    mlj_run(x, mlj_process, inL, ins[1], outL, sampleframes);
+    idle_after(&x->idle, outL, sampleframes);
 }
 
 #else